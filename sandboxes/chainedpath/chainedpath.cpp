@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Geometry.hpp>
+#include <libslic3r/ExtrusionEntityCollection.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: chainedpath [-n entities]"
+};
+
+using namespace Slic3r;
+
+// The greedy chaining as it was implemented before NearestPointLookup, scanning all the remaining endpoints for each entity.
+static std::vector<size_t> chained_order_linear(const ExtrusionEntityCollection &collection, Point start_near)
+{
+    std::vector<size_t> paths;
+    Points              endpoints;
+    for (size_t idx = 0; idx < collection.entities.size(); ++ idx) {
+        const ExtrusionEntity *entity = collection.entities[idx];
+        paths.push_back(idx);
+        endpoints.push_back(entity->first_point());
+        endpoints.push_back(entity->can_reverse() ? entity->last_point() : entity->first_point());
+    }
+    std::vector<size_t> out;
+    while (! paths.empty()) {
+        int start_index = start_near.nearest_point_index(endpoints);
+        int path_index  = start_index / 2;
+        const ExtrusionEntity *entity = collection.entities[paths[path_index]];
+        out.push_back(paths[path_index]);
+        start_near = (start_index % 2 && entity->can_reverse()) ? entity->first_point() : entity->last_point();
+        paths.erase(paths.begin() + path_index);
+        endpoints.erase(endpoints.begin() + 2 * path_index, endpoints.begin() + 2 * path_index + 2);
+    }
+    return out;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Measures the chaining of a large number of short extrusions, like the gap fill or the infill of a large layer,
+// by the grid accelerated ExtrusionEntityCollection::chained_order_from() against the linear scan of the endpoints.
+int main(const int argc, const char *argv[]) {
+    size_t num_entities = 20000;
+    for (int i = 1; i < argc; ++ i) {
+        if (std::string(argv[i]) == "-n" && i + 1 < argc)
+            num_entities = size_t(std::max(1, atoi(argv[++ i])));
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    // Short lines scattered over a 250x210mm bed, with some loops, which are never reversed.
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<coord_t> x_dist(0, scale_(250.)), y_dist(0, scale_(210.)), len_dist(scale_(0.5), scale_(5.));
+    ExtrusionEntityCollection collection;
+    for (size_t i = 0; i < num_entities; ++ i) {
+        ExtrusionPath path(erGapFill, 0.05, 0.45f, 0.2f);
+        Point pt(x_dist(rng), y_dist(rng));
+        coord_t len = len_dist(rng);
+        if (i % 10 == 0) {
+            path.polyline.points = { pt, Point(pt(0) + len, pt(1)), Point(pt(0) + len, pt(1) + len), pt };
+            collection.entities.push_back(new ExtrusionLoop(std::move(path)));
+        } else {
+            path.polyline.points = { pt, Point(pt(0) + len, pt(1) + len / 2) };
+            collection.append(path);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<size_t> linear = chained_order_linear(collection, Point(0, 0));
+    double linear_time = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<ExtrusionEntityCollection::ChainedEntity> chained = collection.chained_order_from(Point(0, 0), false);
+    double grid_time = seconds_since(start);
+
+    bool identical = linear.size() == chained.size();
+    for (size_t i = 0; identical && i < linear.size(); ++ i)
+        identical = linear[i] == chained[i].idx;
+
+    std::cout << num_entities << " entities" << std::endl <<
+        std::setprecision(4) << "linear scan " << linear_time << " s" << std::endl <<
+        "grid        " << grid_time << " s" << std::endl <<
+        "results " << (identical ? "identical" : "DIFFER") << std::endl;
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
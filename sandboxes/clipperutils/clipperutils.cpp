@@ -0,0 +1,95 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ClipperUtils.hpp>
+
+// Count the memory allocations to measure the allocations done by the Clipper operations.
+static std::atomic<size_t> s_num_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++ s_num_allocations;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+const std::string USAGE_STR = {
+    "Usage: clipperutils [-n repetitions]"
+};
+
+static Slic3r::Polygon circle(const Slic3r::Point &center, double radius, size_t num_points)
+{
+    Slic3r::Polygon out;
+    out.points.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        double a = 2. * PI * double(i) / double(num_points);
+        out.points.emplace_back(center(0) + coord_t(radius * cos(a)), center(1) + coord_t(radius * sin(a)));
+    }
+    return out;
+}
+
+// Measures the time and the number of memory allocations of small Clipper operations
+// as they are executed by the slicing, infill and support generation.
+int main(const int argc, const char *argv[]) {
+    using namespace Slic3r;
+    using std::cout; using std::endl;
+
+    int repetitions = 2000;
+    if (argc > 2 && std::string(argv[1]) == "-n")
+        repetitions = std::max(1, atoi(argv[2]));
+    else if (argc > 1) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    // A couple of overlapping rings with holes, a set of polylines crossing them.
+    Polygons  subject, clip;
+    ExPolygons expolygons;
+    for (int i = 0; i < 4; ++ i) {
+        Point center(scale_(3. * i), scale_(i % 2));
+        subject.emplace_back(circle(center, scale_(2.), 64));
+        clip.emplace_back(circle(center + Point(scale_(1.), scale_(0.)), scale_(1.5), 48));
+        ExPolygon expoly;
+        expoly.contour = circle(center, scale_(2.), 64);
+        expoly.holes.emplace_back(circle(center, scale_(1.), 32));
+        expoly.holes.back().reverse();
+        expolygons.emplace_back(std::move(expoly));
+    }
+    Polylines polylines;
+    for (int i = 0; i < 16; ++ i)
+        polylines.emplace_back(Polyline(Point(scale_(-3.), scale_(0.5 * i - 4.)), Point(scale_(12.), scale_(0.5 * i - 3.))));
+
+    double checksum = 0.;
+    s_num_allocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++ i) {
+        for (const ExPolygon &expoly : union_ex(subject))
+            checksum += expoly.area();
+        for (const Polygon &poly : diff(subject, clip))
+            checksum += poly.area();
+        for (const ExPolygon &expoly : intersection_ex(subject, clip, true))
+            checksum += expoly.area();
+        for (const ExPolygon &expoly : offset_ex(expolygons, scale_(0.2)))
+            checksum += expoly.area();
+        for (const Polygon &poly : offset2(subject, - scale_(0.5), scale_(0.3)))
+            checksum += poly.area();
+        for (const Polyline &polyline : intersection_pl(polylines, subject))
+            checksum += polyline.length();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t num_allocations = s_num_allocations;
+    cout << repetitions << " repetitions of 6 operations: " << std::setprecision(4) << seconds << " s, " <<
+        double(num_allocations) / double(repetitions) << " allocations per repetition, checksum " << std::setprecision(17) << checksum << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExtrusionEntityCollection.hpp>
+#include <libslic3r/Utils.hpp>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Count the memory allocations to measure the allocations done by the regrouping and chaining of the extrusions.
+static std::atomic<size_t> s_num_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    ++ s_num_allocations;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+const std::string USAGE_STR = {
+    "Usage: extrusionentities [-n layers] [--cloned] [--dense] [--compact]"
+};
+
+using namespace Slic3r;
+
+// A layer like the ones produced by the perimeter and infill generators: islands with a no_sort collection of perimeter loops
+// and a collection of sortable infill lines. Dense infill lines are wavy with many points, like the gyroid infill.
+static ExtrusionEntityCollection make_layer(int layer_id, bool dense)
+{
+    ExtrusionEntityCollection layer;
+    for (int island = 0; island < 10; ++ island) {
+        coord_t x0 = scale_(25. * (island % 5));
+        coord_t y0 = scale_(25. * (island / 5));
+        ExtrusionEntityCollection perimeters;
+        perimeters.no_sort = true;
+        for (int i = 0; i < 3; ++ i) {
+            ExtrusionPath path(erPerimeter, 0.05, 0.45f, 0.2f);
+            coord_t d = scale_(0.4 * i);
+            path.polyline.points = { Point(x0 + d, y0 + d), Point(x0 + scale_(20.) - d, y0 + d), Point(x0 + scale_(20.) - d, y0 + scale_(20.) - d),
+                                     Point(x0 + d, y0 + scale_(20.) - d), Point(x0 + d, y0 + d) };
+            perimeters.entities.push_back(new ExtrusionLoop(std::move(path)));
+        }
+        ExtrusionEntityCollection infill;
+        for (int i = 0; i < 100; ++ i) {
+            ExtrusionPath path(erInternalInfill, 0.05, 0.45f, 0.2f);
+            coord_t y = y0 + scale_(1.5 + 0.17 * i);
+            coord_t dx = scale_(0.01 * ((i * 7 + layer_id) % 13));
+            path.polyline.points = { Point(x0 + scale_(1.5) + dx, y), Point(x0 + scale_(18.5) - dx, y) };
+            if (dense) {
+                Point a = path.polyline.points.front();
+                Point b = path.polyline.points.back();
+                path.polyline.points.clear();
+                for (int j = 0; j <= 100; ++ j)
+                    path.polyline.points.emplace_back(a.x() + (b.x() - a.x()) * j / 100, y + coord_t(scale_(0.05) * std::sin(0.3 * j)));
+            }
+            infill.entities.push_back(path.clone());
+        }
+        layer.append(std::move(perimeters));
+        layer.append(std::move(infill));
+    }
+    return layer;
+}
+
+// Visit the collection the way GCode::use() did before chained_order_from() was introduced.
+static void walk_cloned(const ExtrusionEntityCollection &collection, Point &last_pos, double &checksum)
+{
+    ExtrusionEntityCollection chained;
+    if (collection.no_sort) chained = collection;
+    else chained = collection.chained_path_from(last_pos, false);
+    for (const ExtrusionEntity *entity : chained.entities)
+        if (entity->is_collection())
+            walk_cloned(*static_cast<const ExtrusionEntityCollection*>(entity), last_pos, checksum);
+        else {
+            checksum = checksum * 0.999 + double(entity->first_point()(0)) + 0.5 * double(entity->last_point()(1));
+            last_pos = entity->last_point();
+        }
+}
+
+// Visit the collection the way GCode::use() does now.
+static void walk_referenced(const ExtrusionEntityCollection &collection, Point &last_pos, double &checksum)
+{
+    auto visit = [&last_pos, &checksum](const ExtrusionEntity *entity) {
+        if (entity->is_collection())
+            walk_referenced(*static_cast<const ExtrusionEntityCollection*>(entity), last_pos, checksum);
+        else {
+            checksum = checksum * 0.999 + double(entity->first_point()(0)) + 0.5 * double(entity->last_point()(1));
+            last_pos = entity->last_point();
+        }
+    };
+    if (collection.no_sort) {
+        for (const ExtrusionEntity *entity : collection.entities)
+            visit(entity);
+    } else {
+        for (const ExtrusionEntityCollection::ChainedEntity &chained : collection.chained_order_from(last_pos, false))
+            visit(chained.reversed ? chained.reversed.get() : collection.entities[chained.idx]);
+    }
+}
+
+static void print_measurement(const char *name, int num_layers, size_t num_allocations, std::chrono::steady_clock::time_point start, double checksum)
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setw(10) << std::left << name << std::setprecision(4) << seconds << " s, " <<
+        double(s_num_allocations - num_allocations) / double(num_layers) << " allocations per layer, checksum " << std::setprecision(17) << checksum << std::endl;
+}
+
+// Measures the allocations done while regrouping the extrusions of a layer for the G-code export (GCode::ObjectByExtruder)
+// and while chaining the extrusions during the G-code export (GCode::use()).
+// With --cloned, the extrusions are processed the way it was done before the entities were moved and referenced,
+// run the sandbox with and without --cloned to compare the peak memory.
+// With --compact, the points of each layer are compacted once the layer is made, the way PrintObject::infill() does
+// with Print::set_compact_toolpaths(). Run the sandbox with and without --compact to compare the memory logged.
+int main(const int argc, const char *argv[]) {
+    int  num_layers = 500;
+    bool cloned     = false;
+    bool dense      = false;
+    bool compact    = false;
+    for (int i = 1; i < argc; ++ i) {
+        if (std::string(argv[i]) == "-n" && i + 1 < argc)
+            num_layers = std::max(1, atoi(argv[++ i]));
+        else if (std::string(argv[i]) == "--cloned")
+            cloned = true;
+        else if (std::string(argv[i]) == "--dense")
+            dense = true;
+        else if (std::string(argv[i]) == "--compact")
+            compact = true;
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    // log_memory_info() only reports at the info level.
+    set_logging_level(3);
+    std::vector<ExtrusionEntityCollection> layers;
+    size_t released = 0;
+    for (int i = 0; i < num_layers; ++ i) {
+        layers.emplace_back(make_layer(i, dense));
+        released += ShrinkToFitEntities(compact).shrink(layers.back());
+    }
+    std::cout << "layers made, " << format_memsize_MB(released) << " released," << log_memory_info() << std::endl;
+
+    // Regroup all the layers first, as the G-code export keeps the regrouped extrusions of a layer while chaining them.
+    std::vector<ExtrusionEntityCollection> regrouped(layers.size());
+    size_t num_allocations = s_num_allocations;
+    auto   start           = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < layers.size(); ++ i) {
+        if (cloned) {
+            // Clone the flattened entities into the region, the way Region::append() did before.
+            ExtrusionEntityCollection flattened = layers[i].flatten(true);
+            regrouped[i].append(flattened.entities);
+        } else {
+            ExtrusionEntityCollection flattened = layers[i].flatten(true);
+            regrouped[i].append(std::move(flattened.entities));
+        }
+    }
+    print_measurement("regroup", num_layers, num_allocations, start, double(regrouped.front().entities.size()));
+
+    num_allocations = s_num_allocations;
+    start           = std::chrono::steady_clock::now();
+    double checksum = 0.;
+    Point  last_pos(0, 0);
+    for (const ExtrusionEntityCollection &layer : layers)
+        if (cloned)
+            walk_cloned(layer, last_pos, checksum);
+        else
+            walk_referenced(layer, last_pos, checksum);
+    print_measurement("chain", num_layers, num_allocations, start, checksum);
+
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        // Kilobytes on Linux, bytes on OSX.
+        std::cout << "peak RSS " << usage.ru_maxrss << std::endl;
+#endif
+
+    return EXIT_SUCCESS;
+}
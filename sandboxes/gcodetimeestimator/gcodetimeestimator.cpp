@@ -0,0 +1,202 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/GCodeTimeEstimator.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: gcodetimeestimator [-n repetitions] file1.gcode [file2.gcode ...]"
+};
+
+namespace Slic3r {
+
+// The planner as it was before the blocks were stored as a structure of arrays: blocks stored as structures holding
+// their trapezoids, the move length recalculated at each visit and the trapezoids calculated block by block.
+// Used as the baseline of the planning benchmark and to verify the results of the batched kernels.
+struct ReferenceBlock
+{
+    struct Trapezoid
+    {
+        float distance;
+        float accelerate_until;
+        float decelerate_after;
+        float entry;
+        float cruise;
+        float exit;
+    };
+
+    float delta_pos[GCodeTimeEstimator::Num_Axis];
+    float acceleration;
+    float max_entry_speed;
+    float safe_feedrate;
+    float entry;
+    float cruise;
+    float exit;
+    Trapezoid trapezoid;
+    float elapsed_time;
+    bool nominal_length;
+    GCodeTimeEstimator::Block::EMoveType move_type;
+
+    float move_length() const
+    {
+        float length = ::sqrt(sqr(delta_pos[X]) + sqr(delta_pos[Y]) + sqr(delta_pos[Z]));
+        return (length > 0.0f) ? length : std::abs(delta_pos[E]);
+    }
+
+    void calculate_trapezoid()
+    {
+        typedef GCodeTimeEstimator::Block Block;
+        float distance = move_length();
+        trapezoid.distance = distance;
+        trapezoid.entry = entry;
+        trapezoid.cruise = cruise;
+        trapezoid.exit = exit;
+
+        float accelerate_distance = std::max(0.0f, Block::estimate_acceleration_distance(entry, cruise, acceleration));
+        float decelerate_distance = std::max(0.0f, Block::estimate_acceleration_distance(cruise, exit, -acceleration));
+        float cruise_distance = distance - accelerate_distance - decelerate_distance;
+        if (cruise_distance < 0.0f)
+        {
+            accelerate_distance = clamp(0.0f, distance, Block::intersection_distance(entry, exit, acceleration, distance));
+            cruise_distance = 0.0f;
+            trapezoid.cruise = Block::speed_from_distance(entry, accelerate_distance, acceleration);
+        }
+        trapezoid.accelerate_until = accelerate_distance;
+        trapezoid.decelerate_after = accelerate_distance + cruise_distance;
+    }
+
+    float time() const
+    {
+        typedef GCodeTimeEstimator::Block Block;
+        float time = 0.0f;
+        time += Block::acceleration_time_from_distance(trapezoid.entry, trapezoid.accelerate_until, acceleration);
+        time += (trapezoid.cruise != 0.0f) ? (trapezoid.decelerate_after - trapezoid.accelerate_until) / trapezoid.cruise : 0.0f;
+        time += Block::acceleration_time_from_distance(trapezoid.cruise, trapezoid.distance - trapezoid.decelerate_after, -acceleration);
+        return time;
+    }
+};
+
+static std::vector<ReferenceBlock> reference_blocks(const GCodeTimeEstimator::BlocksList &blocks)
+{
+    std::vector<ReferenceBlock> out(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++ i) {
+        ReferenceBlock &block = out[i];
+        // The length of a (d, 0, 0) vector evaluates exactly to d.
+        block.delta_pos[X] = blocks.distance[i];
+        block.delta_pos[Y] = block.delta_pos[Z] = block.delta_pos[E] = 0.0f;
+        block.acceleration    = blocks.acceleration[i];
+        block.max_entry_speed = blocks.max_entry_speed[i];
+        block.safe_feedrate   = blocks.safe_feedrate[i];
+        block.entry           = blocks.entry_feedrate[i];
+        block.cruise          = blocks.cruise_feedrate[i];
+        block.exit            = 0.0f;
+        block.elapsed_time    = -1.0f;
+        block.nominal_length  = blocks.nominal_length[i] != 0;
+        block.move_type       = blocks.move_type[i];
+    }
+    return out;
+}
+
+// Forward and reverse passes, trapezoids and elapsed times of all the blocks, returns the total time.
+static float reference_calculate_time(std::vector<ReferenceBlock> &blocks)
+{
+    typedef GCodeTimeEstimator::Block Block;
+    for (int i = int(blocks.size()) - 1; i >= 1; -- i) {
+        ReferenceBlock &curr = blocks[i - 1];
+        const ReferenceBlock &next = blocks[i];
+        if (curr.entry != curr.max_entry_speed) {
+            if (! curr.nominal_length && curr.max_entry_speed > next.entry)
+                curr.entry = std::min(curr.max_entry_speed, Block::max_allowable_speed(-curr.acceleration, next.entry, curr.move_length()));
+            else
+                curr.entry = curr.max_entry_speed;
+        }
+    }
+    for (size_t i = 0; i + 1 < blocks.size(); ++ i) {
+        const ReferenceBlock &prev = blocks[i];
+        ReferenceBlock &curr = blocks[i + 1];
+        if (! prev.nominal_length && prev.entry < curr.entry)
+            curr.entry = std::min(curr.entry, Block::max_allowable_speed(-prev.acceleration, prev.entry, prev.move_length()));
+    }
+    for (size_t i = 0; i < blocks.size(); ++ i) {
+        ReferenceBlock &block = blocks[i];
+        block.exit = (i + 1 < blocks.size()) ? blocks[i + 1].entry : block.safe_feedrate;
+        block.calculate_trapezoid();
+    }
+    float time = 0.0f;
+    for (ReferenceBlock &block : blocks) {
+        time += block.time();
+        block.elapsed_time = time;
+    }
+    return time;
+}
+
+} // namespace Slic3r
+
+// Measures the time spent by the GCodeTimeEstimator estimating the print time of the given G-code files.
+int main(const int argc, const char *argv[]) {
+    using namespace Slic3r;
+    using std::cout; using std::endl;
+
+    int first_file  = 1;
+    int repetitions = 1;
+    if (argc > 2 && std::string(argv[1]) == "-n") {
+        repetitions = std::max(1, atoi(argv[2]));
+        first_file  = 3;
+    }
+    if (argc <= first_file) {
+        cout << USAGE_STR << endl;
+        return EXIT_SUCCESS;
+    }
+
+    double total_seconds = 0.;
+    double total_mb      = 0.;
+    bool   mismatch      = false;
+    for (int i = first_file; i < argc; ++ i) {
+        double mb = double(boost::filesystem::file_size(argv[i])) / (1024. * 1024.);
+        GCodeTimeEstimator estimator(GCodeTimeEstimator::Normal);
+        auto start = std::chrono::steady_clock::now();
+        for (int j = 0; j < repetitions; ++ j)
+            estimator.calculate_time_from_file(argv[i]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+        cout << argv[i] << ": estimated " << estimator.get_time_dhms() << " (" << std::setprecision(10) << estimator.get_time() << " s), " <<
+            std::setprecision(4) << seconds << " s, " << mb / seconds << " MB/s, estimator memory " <<
+            estimator.memory_used() / (1024 * 1024) << " MB" << endl;
+
+        // Planning only: run the planner passes and the trapezoid calculation over all the blocks already parsed,
+        // first by the reference block by block planner, then by the estimator itself, starting from the same entry feedrates.
+        std::vector<ReferenceBlock> reference = reference_blocks(estimator.get_blocks());
+        std::vector<ReferenceBlock> reference_planned;
+        float reference_time = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (int j = 0; j < repetitions; ++ j) {
+            reference_planned = reference;
+            reference_time = reference_calculate_time(reference_planned);
+        }
+        double reference_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+        start = std::chrono::steady_clock::now();
+        for (int j = 0; j < repetitions; ++ j)
+            estimator.calculate_time(true);
+        double planning_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+        const GCodeTimeEstimator::BlocksList &blocks = estimator.get_blocks();
+        size_t num_different = 0;
+        for (size_t k = 0; k < blocks.size(); ++ k)
+            if (std::memcmp(&blocks.elapsed_time[k], &reference_planned[k].elapsed_time, sizeof(float)) != 0)
+                ++ num_different;
+        mismatch |= num_different > 0 || estimator.get_time() != reference_time;
+        cout << "    planning " << blocks.size() << " blocks: block by block " << reference_seconds << " s, batched " << planning_seconds <<
+            " s, " << num_different << " elapsed times differ" << endl;
+        total_seconds += seconds;
+        total_mb      += mb;
+    }
+    if (argc - first_file > 1)
+        cout << "Total: " << std::setprecision(4) << total_seconds << " s, " << total_mb / total_seconds << " MB/s" << endl;
+
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/MotionPlanner.hpp>
+
+const std::string USAGE_STR = {
+    "Usage: motionplanner [-n layers] [-t travels_per_layer]"
+};
+
+using namespace Slic3r;
+
+// Gear like contour with the teeth pointing outwards (CCW) or inwards (CW, used for the holes).
+static Polygon gear(double cx, double cy, double r, int teeth, double depth, bool hole)
+{
+    Polygon polygon;
+    int     n = teeth * 8;
+    for (int i = 0; i < n; ++ i) {
+        double a  = 2. * PI * double(i) / double(n);
+        double rr = r + (((i / 4) % 2) ? depth : 0.);
+        polygon.points.emplace_back(scale_(cx + rr * cos(a)), scale_(cy + rr * sin(a)));
+    }
+    if (hole)
+        polygon.reverse();
+    return polygon;
+}
+
+// Measures the travel planning of avoid_crossing_perimeters over a plate of 3x3 gears with holes:
+// with a new MotionPlanner per layer, and with a MotionPlanner reused for the identical layers,
+// as done by AvoidCrossingPerimeters::init_layer_mp().
+int main(const int argc, const char *argv[]) {
+    int num_layers  = 20;
+    int num_travels = 200;
+    for (int i = 1; i < argc; ++ i) {
+        if (std::string(argv[i]) == "-n" && i + 1 < argc)
+            num_layers = std::max(1, atoi(argv[++ i]));
+        else if (std::string(argv[i]) == "-t" && i + 1 < argc)
+            num_travels = std::max(1, atoi(argv[++ i]));
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    ExPolygons islands;
+    for (int i = 0; i < 3; ++ i)
+        for (int j = 0; j < 3; ++ j) {
+            ExPolygon island;
+            double cx = 40. + 60. * i;
+            double cy = 40. + 60. * j;
+            island.contour = gear(cx, cy, 25., 30, 2., false);
+            for (int k = 0; k < 4; ++ k)
+                island.holes.emplace_back(gear(cx + 10. * cos(k * PI / 2.), cy + 10. * sin(k * PI / 2.), 4., 8, 0.5, true));
+            islands.emplace_back(std::move(island));
+        }
+
+    // The same travels for both measurements.
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> coord_dist(10., 190.);
+    std::vector<std::pair<Point, Point>> travels;
+    for (int i = 0; i < num_travels; ++ i)
+        travels.emplace_back(Point(scale_(coord_dist(rng)), scale_(coord_dist(rng))), Point(scale_(coord_dist(rng)), scale_(coord_dist(rng))));
+
+    for (int reuse = 0; reuse < 2; ++ reuse) {
+        auto   start  = std::chrono::steady_clock::now();
+        double length = 0.;
+        std::unique_ptr<MotionPlanner> mp;
+        for (int layer = 0; layer < num_layers; ++ layer) {
+            if (! reuse || ! mp)
+                mp = Slic3r::make_unique<MotionPlanner>(islands);
+            for (const std::pair<Point, Point> &travel : travels)
+                length += mp->shortest_path(travel.first, travel.second).length();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << (reuse ? "reused planner " : "new planner    ") << std::setprecision(4) << seconds << " s, " <<
+            1000. * seconds / double(num_layers * num_travels) << " ms per travel, total length " << std::setprecision(10) << unscale<double>(length) << " mm" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/SLA/SLARaster.hpp>
+
+#include <miniz.h>
+#include <tbb/task_scheduler_init.h>
+
+const std::string USAGE_STR = {
+    "Usage: slapng [-n layers] [-j threads] [--full-plate]"
+};
+
+using namespace Slic3r;
+
+// Display of the Original Prusa SL1 in the portrait orientation.
+static const sla::Raster::Resolution DISPLAY_RESOLUTION(1440, 2560);
+static const sla::Raster::PixelDim   PIXEL_DIM(68.04 / 1440, 120.96 / 2560);
+
+static ExPolygon ring(double cx, double cy, double r_outer, double r_inner)
+{
+    ExPolygon ring;
+    for (int i = 0; i < 400; ++ i) {
+        double a = 2. * M_PI * i / 400.;
+        ring.contour.points.emplace_back(coord_t(scale_(cx + r_outer * cos(a))), coord_t(scale_(cy + r_outer * sin(a))));
+    }
+    if (r_inner > 0.) {
+        Polygon hole;
+        for (int i = 0; i < 400; ++ i) {
+            double a = - 2. * M_PI * i / 400.;
+            hole.points.emplace_back(coord_t(scale_(cx + r_inner * cos(a))), coord_t(scale_(cy + r_inner * sin(a))));
+        }
+        ring.holes.emplace_back(std::move(hole));
+    }
+    return ring;
+}
+
+// A dental arch of hollow teeth narrowing towards the top, or a plate full of rings.
+static void draw_layer(sla::Raster &raster, int layer_id, int num_layers, bool full_plate)
+{
+    double t = double(layer_id) / double(num_layers);
+    if (full_plate) {
+        for (int i = 0; i < 6; ++ i)
+            for (int j = 0; j < 10; ++ j)
+                raster.draw(ring(8. + i * 10.5, 8. + j * 11.5, 4.5 - 2. * t, 2.5 - 1.5 * t));
+    } else {
+        for (int i = 0; i < 14; ++ i) {
+            double a = M_PI * (i + 0.5) / 14.;
+            raster.draw(ring(34. + 22. * cos(a), 50. + 35. * sin(a), 3.5 - 1.5 * t, 2. - 1.5 * t));
+        }
+    }
+}
+
+// Inflate the IDAT chunk of a PNG written by Raster::save() and compare it with the PNG scanlines of the raw pixels.
+static bool png_matches(sla::RawBytes &png, const std::uint8_t *pixels)
+{
+    const size_t idat_offset = 8 + 25;
+    if (png.size() < idat_offset + 12)
+        return false;
+    const std::uint8_t *p = png.data() + idat_offset;
+    size_t idat_len = (size_t(p[0]) << 24) | (size_t(p[1]) << 16) | (size_t(p[2]) << 8) | size_t(p[3]);
+    if (std::memcmp(p + 4, "IDAT", 4) != 0)
+        return false;
+    size_t out_len = 0;
+    void  *out     = tinfl_decompress_mem_to_heap(p + 8, idat_len, &out_len, TINFL_FLAG_PARSE_ZLIB_HEADER);
+    if (out == nullptr)
+        return false;
+    const size_t width  = DISPLAY_RESOLUTION.width_px;
+    bool         match  = out_len == (width + 1) * DISPLAY_RESOLUTION.height_px;
+    for (size_t row = 0; match && row < DISPLAY_RESOLUTION.height_px; ++ row) {
+        const std::uint8_t *scanline = static_cast<const std::uint8_t*>(out) + row * (width + 1);
+        match = scanline[0] == 0 && std::memcmp(scanline + 1, pixels + row * width, width) == 0;
+    }
+    mz_free(out);
+    return match;
+}
+
+// Compares the PNG encoding of Raster::save() with the generic miniz PNG writer, which Raster::save() used before.
+int main(const int argc, const char *argv[]) {
+    int  num_layers  = 200;
+    int  num_threads = tbb::task_scheduler_init::automatic;
+    bool full_plate  = false;
+    for (int i = 1; i < argc; ++ i) {
+        if (std::string(argv[i]) == "-n" && i + 1 < argc)
+            num_layers = std::max(1, atoi(argv[++ i]));
+        else if (std::string(argv[i]) == "-j" && i + 1 < argc)
+            num_threads = std::max(1, atoi(argv[++ i]));
+        else if (std::string(argv[i]) == "--full-plate")
+            full_plate = true;
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+    tbb::task_scheduler_init scheduler(num_threads);
+
+    double time_miniz = 0., time_raster = 0.;
+    size_t size_miniz = 0,  size_raster = 0;
+    int    num_mismatches = 0;
+    for (int layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        sla::Raster raster;
+        raster.reset(DISPLAY_RESOLUTION, PIXEL_DIM, sla::Raster::Format::PNG);
+        draw_layer(raster, layer_id, num_layers, full_plate);
+
+        // The raw pixels follow the "P5 width height 255 " header.
+        sla::RawBytes raw    = raster.save(sla::Raster::Format::RAW);
+        const std::uint8_t *pixels = raw.data() + raw.size() - size_t(DISPLAY_RESOLUTION.pixels());
+
+        auto   start  = std::chrono::steady_clock::now();
+        size_t len    = 0;
+        void  *png    = tdefl_write_image_to_png_file_in_memory(pixels, int(DISPLAY_RESOLUTION.width_px), int(DISPLAY_RESOLUTION.height_px), 1, &len);
+        time_miniz   += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_miniz   += len;
+        mz_free(png);
+
+        start = std::chrono::steady_clock::now();
+        sla::RawBytes encoded = raster.save(sla::Raster::Format::PNG);
+        time_raster += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_raster += encoded.size();
+
+        if (! png_matches(encoded, pixels))
+            ++ num_mismatches;
+    }
+
+    std::cout << std::setprecision(4) <<
+        "miniz:  " << time_miniz  * 1000. / num_layers << " ms, " << size_miniz  / num_layers << " bytes per layer" << std::endl <<
+        "raster: " << time_raster * 1000. / num_layers << " ms, " << size_raster / num_layers << " bytes per layer" << std::endl <<
+        num_mismatches << " layers decoded differently" << std::endl;
+
+    return num_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,131 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SLA/SLACommon.hpp>
+
+#include <igl/AABB.h>
+
+const std::string USAGE_STR = {
+    "Usage: slaraycast [-n bundles] [stlfilename.stl]"
+};
+
+using namespace Slic3r;
+
+// A model with about 100k triangles if no STL file is given.
+static TriangleMesh make_model()
+{
+    TriangleMesh mesh = make_sphere(10., 0.02);
+    for (int i = 0; i < 4; ++ i) {
+        TriangleMesh cylinder = make_cylinder(2., 25., 0.05);
+        cylinder.translate(float(-6. + 4. * i), float(-6. + 4. * i), -15.f);
+        mesh.merge(cylinder);
+    }
+    mesh.repair();
+    return mesh;
+}
+
+// Bundles of 8 rays cast along the side of a pillar or bridge of 0.5 mm radius the way the SLA support tree generator does.
+static void make_bundle(const BoundingBoxf3 &bbox, int idx, std::vector<Vec3d> &sources, std::vector<Vec3d> &dirs)
+{
+    // Low discrepancy points inside the bounding box, every second bundle points down.
+    double fx = std::fmod(0.5 + idx * 0.7548776662466927, 1.), fy = std::fmod(0.5 + idx * 0.5698402909980532, 1.), fz = std::fmod(0.5 + idx * 0.6180339887498949, 1.);
+    Vec3d  s  = bbox.min + Vec3d(fx, fy, fz).cwiseProduct(bbox.size());
+    Vec3d  d  = (idx & 1) ? Vec3d(0., 0., -1.) : Vec3d(Vec3d(std::cos(idx * 0.1), std::sin(idx * 0.1), -1.).normalized());
+    Vec3d  a  = d.cross(Vec3d(0.3, 0.5, 0.7)).normalized();
+    Vec3d  b  = a.cross(d);
+    sources.clear();
+    dirs.assign(8, d);
+    for (int i = 0; i < 8; ++ i) {
+        double phi = i * 2. * M_PI / 8.;
+        sources.emplace_back(s + 0.5 * (std::cos(phi) * a + std::sin(phi) * b));
+    }
+}
+
+// Compares casting the rays one by one with igl::AABB::intersect_ray(), which EigenMesh3D::query_ray_hit() used before,
+// with the bundled queries of EigenMesh3D.
+int main(const int argc, const char *argv[]) {
+    int         num_bundles = 100000;
+    std::string stl_path;
+    for (int i = 1; i < argc; ++ i) {
+        if (std::string(argv[i]) == "-n" && i + 1 < argc)
+            num_bundles = std::max(1, atoi(argv[++ i]));
+        else if (argv[i][0] != '-' && stl_path.empty())
+            stl_path = argv[i];
+        else {
+            std::cout << USAGE_STR << std::endl;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    TriangleMesh mesh;
+    if (stl_path.empty())
+        mesh = make_model();
+    else if (! mesh.ReadSTLFile(stl_path.c_str())) {
+        std::cerr << "Failed to read " << stl_path << std::endl;
+        return EXIT_FAILURE;
+    } else
+        mesh.repair();
+    BoundingBoxf3 bbox = mesh.bounding_box();
+
+    sla::EigenMesh3D emesh(mesh);
+    igl::AABB<Eigen::MatrixXd, 3> tree;
+    tree.init(emesh.V(), emesh.F());
+    std::cout << emesh.F().rows() << " triangles" << std::endl;
+
+    std::vector<Vec3d> sources, dirs;
+    std::vector<double> closest_igl(num_bundles), closest_bundle(num_bundles);
+    auto start = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < num_bundles; ++ idx) {
+        make_bundle(bbox, idx, sources, dirs);
+        double closest = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < sources.size(); ++ i) {
+            igl::Hit hit;
+            hit.t = std::numeric_limits<float>::infinity();
+            tree.intersect_ray(emesh.V(), emesh.F(), sources[i], dirs[i], hit);
+            closest = std::min(closest, double(hit.t));
+        }
+        closest_igl[idx] = closest;
+    }
+    double time_igl = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < num_bundles; ++ idx) {
+        make_bundle(bbox, idx, sources, dirs);
+        double closest = std::numeric_limits<double>::infinity();
+        for (const sla::EigenMesh3D::hit_result &hit : emesh.query_ray_hits(sources, dirs))
+            closest = std::min(closest, hit.distance());
+        closest_bundle[idx] = closest;
+    }
+    double time_bundle = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // The any hit query as used for checking whether a pillar of a given length fits.
+    const double max_distance = 5.;
+    int num_mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < num_bundles; ++ idx) {
+        make_bundle(bbox, idx, sources, dirs);
+        if (emesh.any_ray_hit(sources, dirs, max_distance) != (closest_igl[idx] < max_distance))
+            ++ num_mismatches;
+    }
+    double time_any = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int idx = 0; idx < num_bundles; ++ idx)
+        if (closest_igl[idx] != closest_bundle[idx])
+            ++ num_mismatches;
+
+    std::cout << std::setprecision(4) <<
+        "igl one by one: " << time_igl    << " s" << std::endl <<
+        "bundled:        " << time_bundle << " s" << std::endl <<
+        "any hit < " << max_distance << ":    " << time_any << " s" << std::endl <<
+        num_mismatches << " mismatches" << std::endl;
+
+    return num_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -17,11 +17,15 @@
     #endif /* SLIC3R_GUI */
 #endif /* WIN32 */
 
+#include <atomic>
 #include <cstdio>
 #include <string>
 #include <cstring>
 #include <iostream>
 #include <math.h>
+#include <iomanip>
+#include <sstream>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/nowide/args.hpp>
 #include <boost/nowide/cenv.hpp>
@@ -32,9 +36,11 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Config.hpp"
 #include "libslic3r/Geometry.hpp"
+#include "libslic3r/GCodeTimeEstimator.hpp"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/SliceCache.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/AMF.hpp"
 #include "libslic3r/Format/3mf.hpp"
@@ -44,6 +50,8 @@
 
 #include "PrusaSlicer.hpp"
 
+#include <tbb/parallel_for.h>
+
 #ifdef SLIC3R_GUI
     #include "slic3r/GUI/GUI.hpp"
     #include "slic3r/GUI/GUI_App.hpp"
@@ -57,6 +65,12 @@ PrinterTechnology get_printer_technology(const DynamicConfig &config)
     return (opt == nullptr) ? ptUnknown : opt->value;
 }
 
+static bool is_gcode_file(const std::string &path)
+{
+    return boost::algorithm::iends_with(path, ".gcode") || boost::algorithm::iends_with(path, ".gco") ||
+           boost::algorithm::iends_with(path, ".g")     || boost::algorithm::iends_with(path, ".ngc");
+}
+
 int CLI::run(int argc, char **argv) 
 {
 	if (! this->setup(argc, argv))
@@ -102,11 +116,17 @@ int CLI::run(int argc, char **argv)
     }
         
     // Read input file(s) if any.
+    bool estimate_time = std::find(m_actions.begin(), m_actions.end(), "estimate_time") != m_actions.end();
     for (const std::string &file : m_input_files) {
         if (! boost::filesystem::exists(file)) {
             boost::nowide::cerr << "No such file: " << file << std::endl;
             exit(1);
         }
+        if (estimate_time && is_gcode_file(file)) {
+            // G-code is only processed by the time estimator, no model is loaded.
+            m_gcode_files.push_back(file);
+            continue;
+        }
         Model model;
         try {
             // When loading an AMF or 3MF, config is imported as well, including the printer technology.
@@ -346,6 +366,9 @@ int CLI::run(int argc, char **argv)
         } else if (opt_key == "export_3mf") {
             if (! this->export_models(IO::TMF))
                 return 1;
+        } else if (opt_key == "estimate_time") {
+            if (! this->estimate_print_times(fff_print_config))
+                return 1;
         } else if (opt_key == "export_gcode" || opt_key == "export_sla" || opt_key == "slice") {
             if (opt_key == "export_gcode" && printer_technology == ptSLA) {
                 boost::nowide::cerr << "error: cannot export G-code for an FFF configuration" << std::endl;
@@ -386,6 +409,7 @@ int CLI::run(int argc, char **argv)
                 if (printer_technology == ptFFF) {
                     for (auto* mo : model.objects)
                         fff_print.auto_assign_extruders(mo);
+                    fff_print.set_compact_toolpaths(m_config.opt_bool("compact_toolpaths"));
                 }
                 print->apply(model, m_print_config);
                 std::string err = print->validate();
@@ -564,6 +588,7 @@ bool CLI::setup(int argc, char **argv)
             m_config.optptr(optdef.first, true);
 
 	set_data_dir(m_config.opt_string("datadir"));
+	SliceCache::set_directory(m_config.opt_string("slice_cache"), size_t(std::max(0, m_config.opt_int("slice_cache_size"))) << 20);
 
 	return true;
 }
@@ -627,6 +652,93 @@ bool CLI::export_models(IO::ExportFormat format)
     return true;
 }
 
+static std::string json_escape(const std::string &str)
+{
+    std::string out;
+    out.reserve(str.size() + 2);
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                char buf[8];
+                sprintf(buf, "\\u%04x", (unsigned int)(unsigned char)c);
+                out += buf;
+            } else
+                out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+static void export_time_estimate_json(std::ostream &out, const GCodeTimeEstimator &estimator)
+{
+    out << "{ \"time\": " << estimator.get_time() << ", \"time_dhms\": " << json_escape(estimator.get_time_dhms()) << ", \"color_times\": [";
+    std::vector<float> color_times = estimator.get_color_times();
+    for (size_t i = 0; i < color_times.size(); ++ i)
+        out << ((i == 0) ? " " : ", ") << color_times[i];
+    out << " ], \"moves\": {";
+    bool first = true;
+    for (const GCodeTimeEstimator::MovesStatsMap::value_type &move : estimator.get_moves_stats()) {
+        out << (first ? " " : ", ") << json_escape(GCodeTimeEstimator::get_move_type_name(move.first)) <<
+            ": { \"count\": " << move.second.count << ", \"time\": " << move.second.time << " }";
+        first = false;
+    }
+    out << " } }";
+}
+
+bool CLI::estimate_print_times(const PrintConfig &config) const
+{
+    if (m_gcode_files.empty()) {
+        boost::nowide::cerr << "error: --estimate-time requires G-code input files" << std::endl;
+        return false;
+    }
+
+    bool silent_mode = (config.gcode_flavor == gcfMarlin) && config.silent_mode;
+    // The files are independent, estimate them in parallel, each into its own JSON record.
+    std::vector<std::string> records(m_gcode_files.size());
+    std::atomic<bool>        success(true);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_gcode_files.size(), 1),
+        [this, &config, silent_mode, &records, &success](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(2);
+            out << "    { \"file\": " << json_escape(m_gcode_files[i]);
+            try {
+                GCodeTimeEstimator normal_estimator(GCodeTimeEstimator::Normal);
+                normal_estimator.apply_print_config(config);
+                normal_estimator.calculate_time_from_file(m_gcode_files[i]);
+                out << ",\n      \"normal_mode\": ";
+                export_time_estimate_json(out, normal_estimator);
+                if (silent_mode) {
+                    GCodeTimeEstimator silent_estimator(GCodeTimeEstimator::Silent);
+                    silent_estimator.apply_print_config(config);
+                    silent_estimator.calculate_time_from_file(m_gcode_files[i]);
+                    out << ",\n      \"silent_mode\": ";
+                    export_time_estimate_json(out, silent_estimator);
+                }
+            } catch (const std::exception &ex) {
+                out << ", \"error\": " << json_escape(ex.what());
+                success = false;
+            }
+            out << " }";
+            records[i] = out.str();
+        }
+    });
+
+    boost::nowide::cout << "{ \"files\": [" << std::endl;
+    for (size_t i = 0; i < records.size(); ++ i)
+        boost::nowide::cout << records[i] << ((i + 1 < records.size()) ? "," : "") << std::endl;
+    boost::nowide::cout << "] }" << std::endl;
+    return success.load();
+}
+
 std::string CLI::output_filepath(const Model &model, IO::ExportFormat format) const
 {
     std::string ext;
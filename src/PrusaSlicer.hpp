@@ -28,6 +28,8 @@ private:
     DynamicPrintConfig			m_print_config;
     DynamicPrintConfig          m_extra_config;
     std::vector<std::string>    m_input_files;
+    // Input G-code files for the estimate_time action.
+    std::vector<std::string>    m_gcode_files;
     std::vector<std::string>    m_actions;
     std::vector<std::string>    m_transforms;
     std::vector<Model>          m_models;
@@ -39,6 +41,9 @@ private:
     
     /// Exports loaded models to a file of the specified format, according to the options affecting output filename.
     bool export_models(IO::ExportFormat format);
+
+    /// Estimates the print times of the input G-code files in parallel and writes them to the console in JSON format.
+    bool estimate_print_times(const PrintConfig &config) const;
     
     bool has_print_action() const { return m_config.opt_bool("export_gcode") || m_config.opt_bool("export_sla"); }
     
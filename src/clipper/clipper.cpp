@@ -723,12 +723,12 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
+  std::vector<TEdge> &edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
     // Success, remember the edge array.
-    m_edges.emplace_back(std::move(edges));
+    ++ m_edgesUsed;
   return result;
 }
 
@@ -756,7 +756,7 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(num_edges_total);
+  std::vector<TEdge> &edges = AllocateEdges(num_edges_total);
   // Fill in the edge array.
   bool result = false;
   TEdge *p_edge = edges.data();
@@ -770,10 +770,20 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
     }
   if (result)
     // At least some edges were generated. Remember the edge array.
-    m_edges.emplace_back(std::move(edges));
+    ++ m_edgesUsed;
   return result;
 }
 
+std::vector<TEdge>& ClipperBase::AllocateEdges(size_t num_edges)
+{
+  if (m_edgesUsed == m_edges.size())
+    m_edges.emplace_back();
+  std::vector<TEdge> &edges = m_edges[m_edgesUsed];
+  // Reuses the memory of the edge array if it was allocated by a previous Clipper operation.
+  edges.assign(num_edges, TEdge());
+  return edges;
+}
+
 bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges)
 {
   PROFILE_FUNC();
@@ -952,7 +962,8 @@ void ClipperBase::Clear()
 {
   PROFILE_FUNC();
   m_MinimaList.clear();
-  m_edges.clear();
+  // Keep the edge arrays allocated for the next Clipper operation.
+  m_edgesUsed = 0;
   m_UseFullRange = false;
   m_HasOpenPaths = false;
 }
@@ -1034,6 +1045,7 @@ IntRect ClipperBase::GetBounds()
 
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
+  m_OutPtsChunksUsed(0),
   m_OutPtsFree(nullptr),
   m_OutPtsChunkSize(32),
   m_OutPtsChunkLast(32),
@@ -1050,6 +1062,16 @@ Clipper::Clipper(int initOptions) :
 }
 //------------------------------------------------------------------------------
 
+Clipper::~Clipper()
+{
+  Clear();
+  for (OutPt *pts : m_OutPts)
+    delete[] pts;
+  for (OutRec *rec : m_PolyOutsFree)
+    delete rec;
+}
+//------------------------------------------------------------------------------
+
 void Clipper::Reset()
 {
   PROFILE_FUNC();
@@ -1176,26 +1198,26 @@ OutPt* Clipper::AllocateOutPt()
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
     // Get a point from the last chunk.
-    pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
+    pt = m_OutPts[m_OutPtsChunksUsed - 1] + (m_OutPtsChunkLast ++);
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    // The last chunk is full. Take the next chunk retained from a previous operation or allocate a new one.
+    if (m_OutPtsChunksUsed == m_OutPts.size())
+      m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    pt = m_OutPts[m_OutPtsChunksUsed ++];
     m_OutPtsChunkLast = 1;
-    pt = m_OutPts.back();
   }
   return pt;
 }
 
+// Release the output records and points. Their memory is kept to be recycled by the next Clipper operation,
+// it is released by the Clipper destructor.
 void Clipper::DisposeAllOutRecs()
 {
-  for (OutPt *pts : m_OutPts)
-    delete[] pts;
-  for (OutRec *rec : m_PolyOuts)
-    delete rec;
-  m_OutPts.clear();
+  m_PolyOutsFree.insert(m_PolyOutsFree.end(), m_PolyOuts.begin(), m_PolyOuts.end());
+  m_PolyOuts.clear();
+  m_OutPtsChunksUsed = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
-  m_PolyOuts.clear();
 }
 //------------------------------------------------------------------------------
 
@@ -1975,7 +1997,13 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2) const
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result;
+  if (m_PolyOutsFree.empty())
+    result = new OutRec;
+  else {
+    result = m_PolyOutsFree.back();
+    m_PolyOutsFree.pop_back();
+  }
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -3433,7 +3461,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3463,7 +3493,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -284,7 +284,7 @@ enum EdgeSide { esLeft = 1, esRight = 2};
 class ClipperBase
 {
 public:
-  ClipperBase() : m_UseFullRange(false), m_HasOpenPaths(false) {}
+  ClipperBase() : m_UseFullRange(false), m_edgesUsed(0), m_HasOpenPaths(false) {}
   ~ClipperBase() { Clear(); }
   bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
   bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
@@ -299,6 +299,9 @@ protected:
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
+  // Returns an edge array of num_edges default initialized edges, reusing an edge array retained by Clear() if possible.
+  // The array becomes part of m_edges only after the caller increments m_edgesUsed.
+  std::vector<TEdge>& AllocateEdges(size_t num_edges);
   TEdge* DescendToMin(TEdge *&E);
   void AscendToMax(TEdge *&E, bool Appending, bool IsClosed);
 
@@ -308,8 +311,10 @@ protected:
   // True if the input polygons have abs values higher than loRange, but lower than hiRange.
   // False if the input polygons have abs values lower or equal to loRange.
   bool              m_UseFullRange;
-  // A vector of edges per each input path.
+  // A vector of edges per each AddPath() / AddPaths() call. Only the first m_edgesUsed vectors are valid,
+  // the others are kept by Clear() to be recycled if the Clipper object is reused.
   std::vector<std::vector<TEdge>> m_edges;
+  size_t           m_edgesUsed;
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -321,7 +326,7 @@ class Clipper : public ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
-  ~Clipper() { Clear(); }
+  ~Clipper();
   void Clear() { ClipperBase::Clear(); DisposeAllOutRecs(); }
   bool Execute(ClipType clipType,
       Paths &solution,
@@ -354,8 +359,13 @@ private:
   
   // Output polygons.
   std::vector<OutRec*>  m_PolyOuts;
+  // Output polygons released by DisposeAllOutRecs(), to be recycled by CreateOutRec().
+  std::vector<OutRec*>  m_PolyOutsFree;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // The chunks are kept by DisposeAllOutRecs() to be recycled if the Clipper object is reused,
+  // only the first m_OutPtsChunksUsed chunks are in use.
   std::vector<OutPt*>   m_OutPts;
+  size_t                m_OutPtsChunksUsed;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
@@ -459,6 +469,8 @@ private:
   double m_miterLim, m_StepsPerRad;
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Clipper cleaning up the offsetted polygons, reused by the subsequent calls of Execute().
+  Clipper m_clipper;
 
   void FixOrientations();
   void DoOffset(double delta);
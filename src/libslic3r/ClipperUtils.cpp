@@ -7,12 +7,97 @@
 #include "SVG.hpp"
 #endif /* CLIPPER_UTILS_DEBUG */
 
+#include <memory>
+
 #include <Shiny/Shiny.h>
 
 #define CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR (0.005f)
 
+// Clipper operations with more input points than this limit don't use the per thread Clipper engine,
+// so that the per thread engines do not hold on to large blocks of memory.
+#define CLIPPER_ENGINE_CACHE_MAX_POINTS 50000
+
 namespace Slic3r {
 
+namespace {
+
+// Reset the Clipper engines to the state of a freshly constructed object.
+inline void clipper_engine_reset(ClipperLib::Clipper &clipper)
+{
+    clipper.Clear();
+    clipper.ReverseSolution(false);
+    clipper.StrictlySimple(false);
+    clipper.PreserveCollinear(false);
+}
+
+inline void clipper_engine_reset(ClipperLib::ClipperOffset &co)
+{
+    co.Clear();
+    co.MiterLimit           = 2.;
+    co.ArcTolerance         = 0.25;
+    co.ShortestEdgeLength   = 0.;
+}
+
+// Lease of a Clipper engine (ClipperLib::Clipper or ClipperLib::ClipperOffset) kept per thread.
+// The Clipper engines retain the memory allocated for the edges, output records and output points between the operations,
+// therefore reusing an engine saves most of the memory allocations of the small Clipper operations, which are executed
+// millions of times while slicing. If the engine of this thread is already leased (a nested Clipper operation)
+// or if the operation is large, a private engine is constructed instead.
+template<typename Engine>
+class ClipperEngine
+{
+public:
+    explicit ClipperEngine(size_t num_points = 0) : m_engine(nullptr) {
+        Cache &cache = ClipperEngine::cache();
+        if (cache.leased || num_points > CLIPPER_ENGINE_CACHE_MAX_POINTS) {
+            m_private.reset(new Engine());
+            m_engine = m_private.get();
+        } else {
+            cache.leased = true;
+            m_engine = &cache.engine;
+            clipper_engine_reset(*m_engine);
+        }
+    }
+    ~ClipperEngine() {
+        if (! m_private) {
+            // Release the input and output data, keep the allocated memory.
+            m_engine->Clear();
+            ClipperEngine::cache().leased = false;
+        }
+    }
+
+    Engine& operator*()  { return *m_engine; }
+    Engine* operator->() { return m_engine; }
+
+private:
+    struct Cache {
+        Engine  engine;
+        bool    leased = false;
+    };
+    static Cache& cache() { static thread_local Cache cache; return cache; }
+
+    Engine                  *m_engine;
+    std::unique_ptr<Engine>  m_private;
+};
+
+typedef ClipperEngine<ClipperLib::Clipper>         ClipperLease;
+typedef ClipperEngine<ClipperLib::ClipperOffset>   ClipperOffsetLease;
+
+inline size_t clipper_num_points(const ClipperLib::Paths &paths)
+{
+    size_t n = 0;
+    for (const ClipperLib::Path &path : paths)
+        n += path.size();
+    return n;
+}
+
+inline size_t clipper_num_points(const ClipperLib::Paths &paths1, const ClipperLib::Paths &paths2)
+{
+    return clipper_num_points(paths1) + clipper_num_points(paths2);
+}
+
+} // namespace
+
 #ifdef CLIPPER_UTILS_DEBUG
 bool clipper_export_enabled = false;
 // For debugging the Clipper library, for providing bug reports to the Clipper author.
@@ -119,6 +204,7 @@ PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 {
     Polygon retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -127,6 +213,7 @@ Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 Slic3r::Polyline ClipperPath_to_Slic3rPolyline(const ClipperLib::Path &input)
 {
     Polyline retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -154,13 +241,12 @@ ExPolygons
 ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input)
 {
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLease clipper(clipper_num_points(input));
     
     // perform union
-    clipper.AddPaths(input, ClipperLib::ptSubject, true);
+    clipper->AddPaths(input, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
-    clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);  // offset results work with both EvenOdd and NonZero
+    clipper->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);  // offset results work with both EvenOdd and NonZero
     
     // write to ExPolygons object
     return PolyTreeToExPolygons(polytree);
@@ -170,6 +256,7 @@ ClipperLib::Path
 Slic3rMultiPoint_to_ClipperPath(const MultiPoint &input)
 {
     ClipperLib::Path retval;
+    retval.reserve(input.points.size());
     for (Points::const_iterator pit = input.points.begin(); pit != input.points.end(); ++pit)
         retval.emplace_back((*pit)(0), (*pit)(1));
     return retval;
@@ -188,6 +275,7 @@ Slic3rMultiPoint_to_ClipperPath_reversed(const Slic3r::MultiPoint &input)
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (Polygons::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -196,6 +284,7 @@ ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polygons &input)
 ClipperLib::Paths Slic3rMultiPoints_to_ClipperPaths(const Polylines &input)
 {
     ClipperLib::Paths retval;
+    retval.reserve(input.size());
     for (Polylines::const_iterator it = input.begin(); it != input.end(); ++it)
         retval.emplace_back(Slic3rMultiPoint_to_ClipperPath(*it));
     return retval;
@@ -207,16 +296,16 @@ ClipperLib::Paths _offset(ClipperLib::Paths &&input, ClipperLib::EndType endType
     scaleClipperPolygons(input);
     
     // perform offset
-    ClipperLib::ClipperOffset co;
+    ClipperOffsetLease co(clipper_num_points(input));
     if (joinType == jtRound)
-        co.ArcTolerance = miterLimit;
+        co->ArcTolerance = miterLimit;
     else
-        co.MiterLimit = miterLimit;
+        co->MiterLimit = miterLimit;
     double delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
-    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-    co.AddPaths(input, joinType, endType);
+    co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+    co->AddPaths(input, joinType, endType);
     ClipperLib::Paths retval;
-    co.Execute(retval, delta_scaled);
+    co->Execute(retval, delta_scaled);
     
     // unscale output
     unscaleClipperPolygons(retval);
@@ -243,14 +332,14 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const double delta
     {
         ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(expolygon.contour);
         scaleClipperPolygon(input);
-        ClipperLib::ClipperOffset co;
+        ClipperOffsetLease co(input.size());
         if (joinType == jtRound)
-            co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+            co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
         else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-        co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta_scaled);
+            co->MiterLimit = miterLimit;
+        co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+        co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
+        co->Execute(contours, delta_scaled);
     }
 
     // 2) Offset the holes one by one, collect the results.
@@ -260,15 +349,15 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const double delta
         for (Polygons::const_iterator it_hole = expolygon.holes.begin(); it_hole != expolygon.holes.end(); ++ it_hole) {
             ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
             scaleClipperPolygon(input);
-            ClipperLib::ClipperOffset co;
+            ClipperOffsetLease co(input.size());
             if (joinType == jtRound)
-                co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+                co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
             else
-                co.MiterLimit = miterLimit;
-            co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+                co->MiterLimit = miterLimit;
+            co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+            co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
             ClipperLib::Paths out;
-            co.Execute(out, - delta_scaled);
+            co->Execute(out, - delta_scaled);
             holes.insert(holes.end(), out.begin(), out.end());
         }
     }
@@ -278,11 +367,10 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const double delta
     if (holes.empty()) {
         output = std::move(contours);
     } else {
-        ClipperLib::Clipper clipper;
-        clipper.Clear();
-        clipper.AddPaths(contours, ClipperLib::ptSubject, true);
-        clipper.AddPaths(holes, ClipperLib::ptClip, true);
-        clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        ClipperLease clipper(clipper_num_points(contours, holes));
+        clipper->AddPaths(contours, ClipperLib::ptSubject, true);
+        clipper->AddPaths(holes, ClipperLib::ptClip, true);
+        clipper->Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     }
     
     // 4) Unscale the output.
@@ -309,14 +397,14 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const double del
         {
             ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(it_expoly->contour);
             scaleClipperPolygon(input);
-            ClipperLib::ClipperOffset co;
+            ClipperOffsetLease co(input.size());
             if (joinType == jtRound)
-                co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+                co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
             else
-                co.MiterLimit = miterLimit;
-            co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
-            co.Execute(contours, delta_scaled);
+                co->MiterLimit = miterLimit;
+            co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+            co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            co->Execute(contours, delta_scaled);
         }
         if (contours.empty())
             // No need to try to offset the holes.
@@ -333,15 +421,15 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const double del
                 for (Polygons::const_iterator it_hole = it_expoly->holes.begin(); it_hole != it_expoly->holes.end(); ++ it_hole) {
                     ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
                     scaleClipperPolygon(input);
-                    ClipperLib::ClipperOffset co;
+                    ClipperOffsetLease co(input.size());
                     if (joinType == jtRound)
-                        co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
+                        co->ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
                     else
-                        co.MiterLimit = miterLimit;
-                    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-                    co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+                        co->MiterLimit = miterLimit;
+                    co->ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+                    co->AddPath(input, joinType, ClipperLib::etClosedPolygon);
                     ClipperLib::Paths out;
-                    co.Execute(out, - delta_scaled);
+                    co->Execute(out, - delta_scaled);
                     holes.insert(holes.end(), out.begin(), out.end());
                 }
             }
@@ -354,12 +442,11 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const double del
             } else if (delta < 0) {
                 // Negative offset. There is a chance, that the offsetted hole intersects the outer contour. 
                 // Subtract the offsetted holes from the offsetted contours.
-                ClipperLib::Clipper clipper;
-                clipper.Clear();
-                clipper.AddPaths(contours, ClipperLib::ptSubject, true);
-                clipper.AddPaths(holes, ClipperLib::ptClip, true);
+                ClipperLease clipper(clipper_num_points(contours, holes));
+                clipper->AddPaths(contours, ClipperLib::ptSubject, true);
+                clipper->AddPaths(holes, ClipperLib::ptClip, true);
                 ClipperLib::Paths output;
-                clipper.Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+                clipper->Execute(ClipperLib::ctDifference, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
                 if (! output.empty()) {
                     contours_cummulative.insert(contours_cummulative.end(), output.begin(), output.end());
                     ++ expolygons_collected;
@@ -385,10 +472,9 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const double del
     ClipperLib::Paths output;
     if (expolygons_collected > 1 && delta > 0) {
         // There is a chance that the outwards offsetted expolygons may intersect. Perform a union.
-        ClipperLib::Clipper clipper;
-        clipper.Clear(); 
-        clipper.AddPaths(contours_cummulative, ClipperLib::ptSubject, true);
-        clipper.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        ClipperLease clipper(clipper_num_points(contours_cummulative));
+        clipper->AddPaths(contours_cummulative, ClipperLib::ptSubject, true);
+        clipper->Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     } else {
         // Negative offset. The shrunk expolygons shall not mutually intersect. Just copy the output.
         output = std::move(contours_cummulative);
@@ -410,26 +496,26 @@ _offset2(const Polygons &polygons, const double delta1, const double delta2,
     scaleClipperPolygons(input);
     
     // prepare ClipperOffset object
-    ClipperLib::ClipperOffset co;
+    ClipperOffsetLease co(clipper_num_points(input));
     if (joinType == jtRound) {
-        co.ArcTolerance = miterLimit;
+        co->ArcTolerance = miterLimit;
     } else {
-        co.MiterLimit = miterLimit;
+        co->MiterLimit = miterLimit;
     }
     double delta_scaled1 = delta1 * float(CLIPPER_OFFSET_SCALE);
     double delta_scaled2 = delta2 * float(CLIPPER_OFFSET_SCALE);
-    co.ShortestEdgeLength = double(std::max(std::abs(delta_scaled1), std::abs(delta_scaled2)) * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR);
+    co->ShortestEdgeLength = double(std::max(std::abs(delta_scaled1), std::abs(delta_scaled2)) * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR);
     
     // perform first offset
     ClipperLib::Paths output1;
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
-    co.Execute(output1, delta_scaled1);
+    co->AddPaths(input, joinType, ClipperLib::etClosedPolygon);
+    co->Execute(output1, delta_scaled1);
     
     // perform second offset
-    co.Clear();
-    co.AddPaths(output1, joinType, ClipperLib::etClosedPolygon);
+    co->Clear();
+    co->AddPaths(output1, joinType, ClipperLib::etClosedPolygon);
     ClipperLib::Paths retval;
-    co.Execute(retval, delta_scaled2);
+    co->Execute(retval, delta_scaled2);
     
     // unscale output
     unscaleClipperPolygons(retval);
@@ -490,16 +576,15 @@ _clipper_do(const ClipperLib::ClipType clipType, const Polygons &subject,
     }
     
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLease clipper(clipper_num_points(input_subject, input_clip));
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    clipper->AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper->AddPaths(input_clip,    ClipperLib::ptClip,    true);
     
     // perform operation
     T retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -521,18 +606,18 @@ inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType cli
     if (safety_offset_)
         safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
     
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    ClipperLease clipper(clipper_num_points(input_subject, input_clip));
+    clipper->AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper->AddPaths(input_clip,    ClipperLib::ptClip,    true);
     // Perform the operation with the output to input_subject.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overapping edges.
-    clipper.Execute(clipType, input_subject, fillType, fillType);
+    clipper->Execute(clipType, input_subject, fillType, fillType);
     // Perform an additional Union operation to generate the PolyTree ordering.
-    clipper.Clear();
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper->Clear();
+    clipper->AddPaths(input_subject, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree retval;
-    clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
+    clipper->Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
 }
 
@@ -548,16 +633,15 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
     if (safety_offset_) safety_offset(&input_clip);
     
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLease clipper(clipper_num_points(input_subject, input_clip));
     
     // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
+    clipper->AddPaths(input_subject, ClipperLib::ptSubject, false);
+    clipper->AddPaths(input_clip,    ClipperLib::ptClip,    true);
     
     // perform operation
     ClipperLib::PolyTree retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -696,11 +780,11 @@ Polygons simplify_polygons(const Polygons &subject, bool preserve_collinear)
     
     ClipperLib::Paths output;
     if (preserve_collinear) {
-        ClipperLib::Clipper c;
-        c.PreserveCollinear(true);
-        c.StrictlySimple(true);
-        c.AddPaths(input_subject, ClipperLib::ptSubject, true);
-        c.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        ClipperLease c(clipper_num_points(input_subject));
+        c->PreserveCollinear(true);
+        c->StrictlySimple(true);
+        c->AddPaths(input_subject, ClipperLib::ptSubject, true);
+        c->Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     } else {
         ClipperLib::SimplifyPolygons(input_subject, output, ClipperLib::pftNonZero);
     }
@@ -719,11 +803,11 @@ ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear
     
     ClipperLib::PolyTree polytree;
     
-    ClipperLib::Clipper c;
-    c.PreserveCollinear(true);
-    c.StrictlySimple(true);
-    c.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    c.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    ClipperLease c(clipper_num_points(input_subject));
+    c->PreserveCollinear(true);
+    c->StrictlySimple(true);
+    c->AddPaths(input_subject, ClipperLib::ptSubject, true);
+    c->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     
     // convert into ExPolygons
     return PolyTreeToExPolygons(polytree);
@@ -737,7 +821,7 @@ void safety_offset(ClipperLib::Paths* paths)
     scaleClipperPolygons(*paths);
     
     // perform offset (delta = scale 1e-05)
-    ClipperLib::ClipperOffset co;
+    ClipperOffsetLease co(clipper_num_points(*paths));
 #ifdef CLIPPER_UTILS_DEBUG
     if (clipper_export_enabled) {
         static int iRun = 0;
@@ -747,20 +831,20 @@ void safety_offset(ClipperLib::Paths* paths)
     ClipperLib::Paths out;
     for (size_t i = 0; i < paths->size(); ++ i) {
         ClipperLib::Path &path = (*paths)[i];
-        co.Clear();
-        co.MiterLimit = 2;
+        co->Clear();
+        co->MiterLimit = 2;
         bool ccw = ClipperLib::Orientation(path);
         if (! ccw)
             std::reverse(path.begin(), path.end());
         {
             PROFILE_BLOCK(safety_offset_AddPaths);
-            co.AddPath((*paths)[i], ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+            co->AddPath((*paths)[i], ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
         }
         {
             PROFILE_BLOCK(safety_offset_Execute);
             // offset outside by 10um
             ClipperLib::Paths out_this;
-            co.Execute(out_this, ccw ? 10.f * float(CLIPPER_OFFSET_SCALE) : -10.f * float(CLIPPER_OFFSET_SCALE));
+            co->Execute(out_this, ccw ? 10.f * float(CLIPPER_OFFSET_SCALE) : -10.f * float(CLIPPER_OFFSET_SCALE));
             if (! ccw) {
                 // Reverse the resulting contours once again.
                 for (ClipperLib::Paths::iterator it = out_this.begin(); it != out_this.end(); ++ it)
@@ -781,12 +865,12 @@ void safety_offset(ClipperLib::Paths* paths)
 Polygons top_level_islands(const Slic3r::Polygons &polygons)
 {
     // init Clipper
-    ClipperLib::Clipper clipper;
-    clipper.Clear();
+    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
+    ClipperLease clipper(clipper_num_points(input));
     // perform union
-    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::ptSubject, true);
+    clipper->AddPaths(input, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
-    clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
+    clipper->Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
     // Convert only the top level islands to the output.
     Polygons out;
     out.reserve(polytree.ChildCount());
@@ -2,6 +2,9 @@
 #include <vector>
 #include <float.h>
 #include <unordered_map>
+#include <atomic>
+
+#include <tbb/parallel_for.h>
 
 #if 0
 // #ifdef SLIC3R_GUI
@@ -133,132 +136,9 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 	// 3) First round of contour rasterization, count the edges per grid cell.
 	for (size_t i = 0; i < m_contours.size(); ++ i) {
 		const Slic3r::Points &pts = *m_contours[i];
-		for (size_t j = 0; j < pts.size(); ++ j) {
-			// End points of the line segment.
-			Slic3r::Point p1(pts[j]);
-			Slic3r::Point p2 = pts[(j + 1 == pts.size()) ? 0 : j + 1];
-			p1(0) -= m_bbox.min(0);
-			p1(1) -= m_bbox.min(1);
-			p2(0) -= m_bbox.min(0);
-			p2(1) -= m_bbox.min(1);
-		   	// Get the cells of the end points.
-		    coord_t ix    = p1(0) / m_resolution;
-		    coord_t iy    = p1(1) / m_resolution;
-		    coord_t ixb   = p2(0) / m_resolution;
-		    coord_t iyb   = p2(1) / m_resolution;
-			assert(ix >= 0 && size_t(ix) < m_cols);
-			assert(iy >= 0 && size_t(iy) < m_rows);
-			assert(ixb >= 0 && size_t(ixb) < m_cols);
-			assert(iyb >= 0 && size_t(iyb) < m_rows);
-			// Account for the end points.
-			++ m_cells[iy*m_cols+ix].end;
-			if (ix == ixb && iy == iyb)
-				// Both ends fall into the same cell.
-				continue;
-		    // Raster the centeral part of the line.
-			coord_t dx = std::abs(p2(0) - p1(0));
-			coord_t dy = std::abs(p2(1) - p1(1));
-			if (p1(0) < p2(0)) {
-				int64_t ex = int64_t((ix + 1)*m_resolution - p1(0)) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else if (ex == ey) {
-							ex = int64_t(dy) * m_resolution;
-							ey = int64_t(dx) * m_resolution;
-							ix += 1;
-							iy += 1;
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy >= iyb);
-						if (ex <= ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else {
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-			else {
-				int64_t ex = int64_t(p1(0) - ix*m_resolution) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x non positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else {
-							assert(ex >= ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x non positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy >= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else if (ex == ey) {
-							// The lower edge of a grid cell belongs to the cell.
-							// Handle the case where the ray may cross the lower left corner of a cell in a general case,
-							// or a left or lower edge in a degenerate case (horizontal or vertical line).
-							if (dx > 0) {
-								ex = int64_t(dy) * m_resolution;
-								ix -= 1;
-							}
-							if (dy > 0) {
-								ey = int64_t(dx) * m_resolution;
-								iy -= 1;
-							}
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						++m_cells[iy*m_cols + ix].end;
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-		}
+		for (size_t j = 0; j < pts.size(); ++ j)
+			this->visit_cells_intersecting_line(pts[j], pts[(j + 1 == pts.size()) ? 0 : j + 1],
+				[this](coord_t iy, coord_t ix) { ++ m_cells[iy*m_cols + ix].end; return true; });
 	}
 
 	// 4) Prefix sum the numbers of hits per cells to get an index into m_cell_data.
@@ -277,132 +157,9 @@ void EdgeGrid::Grid::create_from_m_contours(coord_t resolution)
 		m_cells[i].end = m_cells[i].begin;
 	for (size_t i = 0; i < m_contours.size(); ++i) {
 		const Slic3r::Points &pts = *m_contours[i];
-		for (size_t j = 0; j < pts.size(); ++j) {
-			// End points of the line segment.
-			Slic3r::Point p1(pts[j]);
-			Slic3r::Point p2 = pts[(j + 1 == pts.size()) ? 0 : j + 1];
-			p1(0) -= m_bbox.min(0);
-			p1(1) -= m_bbox.min(1);
-			p2(0) -= m_bbox.min(0);
-			p2(1) -= m_bbox.min(1);
-			// Get the cells of the end points.
-			coord_t ix = p1(0) / m_resolution;
-			coord_t iy = p1(1) / m_resolution;
-			coord_t ixb = p2(0) / m_resolution;
-			coord_t iyb = p2(1) / m_resolution;
-			assert(ix >= 0 && size_t(ix) < m_cols);
-			assert(iy >= 0 && size_t(iy) < m_rows);
-			assert(ixb >= 0 && size_t(ixb) < m_cols);
-			assert(iyb >= 0 && size_t(iyb) < m_rows);
-			// Account for the end points.
-			m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-			if (ix == ixb && iy == iyb)
-				// Both ends fall into the same cell.
-				continue;
-			// Raster the centeral part of the line.
-			coord_t dx = std::abs(p2(0) - p1(0));
-			coord_t dy = std::abs(p2(1) - p1(1));
-			if (p1(0) < p2(0)) {
-				int64_t ex = int64_t((ix + 1)*m_resolution - p1(0)) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else if (ex == ey) {
-							ex = int64_t(dy) * m_resolution;
-							ey = int64_t(dx) * m_resolution;
-							ix += 1;
-							iy += 1;
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix <= ixb && iy >= iyb);
-						if (ex <= ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix += 1;
-						}
-						else {
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-			else {
-				int64_t ex = int64_t(p1(0) - ix*m_resolution) * int64_t(dy);
-				if (p1(1) < p2(1)) {
-					// x non positive, y positive
-					int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy <= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else {
-							assert(ex >= ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy += 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-				else {
-					// x non positive, y non positive
-					int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
-					do {
-						assert(ix >= ixb && iy >= iyb);
-						if (ex < ey) {
-							ey -= ex;
-							ex = int64_t(dy) * m_resolution;
-							ix -= 1;
-						}
-						else if (ex == ey) {
-							// The lower edge of a grid cell belongs to the cell.
-							// Handle the case where the ray may cross the lower left corner of a cell in a general case,
-							// or a left or lower edge in a degenerate case (horizontal or vertical line).
-							if (dx > 0) {
-								ex = int64_t(dy) * m_resolution;
-								ix -= 1;
-							}
-							if (dy > 0) {
-								ey = int64_t(dx) * m_resolution;
-								iy -= 1;
-							}
-						}
-						else {
-							assert(ex > ey);
-							ex -= ey;
-							ey = int64_t(dx) * m_resolution;
-							iy -= 1;
-						}
-						m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j);
-					} while (ix != ixb || iy != iyb);
-				}
-			}
-		}
+		for (size_t j = 0; j < pts.size(); ++j)
+			this->visit_cells_intersecting_line(pts[j], pts[(j + 1 == pts.size()) ? 0 : j + 1],
+				[this, i, j](coord_t iy, coord_t ix) { m_cell_data[m_cells[iy*m_cols + ix].end++] = std::pair<size_t, size_t>(i, j); return true; });
 	}
 }
 
@@ -1229,6 +986,21 @@ bool EdgeGrid::Grid::signed_distance(const Point &pt, coord_t search_radius, coo
 	return true;
 }
 
+bool EdgeGrid::Grid::signed_distances(const Points &pts, coord_t search_radius, std::vector<coordf_t> &result_min_dists) const
+{
+	result_min_dists.assign(pts.size(), coordf_t(search_radius));
+	std::atomic<bool> all_found(true);
+	tbb::parallel_for(tbb::blocked_range<size_t>(0, pts.size(), 256),
+		[this, &pts, search_radius, &result_min_dists, &all_found](const tbb::blocked_range<size_t> &range) {
+			for (size_t i = range.begin(); i < range.end(); ++ i)
+				if (! this->signed_distance(pts[i], search_radius, result_min_dists[i])) {
+					result_min_dists[i] = coordf_t(search_radius);
+					all_found = false;
+				}
+		});
+	return all_found;
+}
+
 Polygons EdgeGrid::Grid::contours_simplified(coord_t offset, bool fill_holes) const
 {
 	assert(std::abs(2 * offset) < m_resolution);
@@ -1449,6 +1221,25 @@ bool EdgeGrid::Grid::has_intersecting_edges() const
 	return false;
 }
 
+bool EdgeGrid::Grid::line_intersects_contours(const Point &p1, const Point &p2) const
+{
+	bool intersects = false;
+	this->visit_cells_intersecting_line(p1, p2, [this, &p1, &p2, &intersects](coord_t iy, coord_t ix) {
+		const Cell &cell = m_cells[iy * m_cols + ix];
+		for (size_t i = cell.begin; i != cell.end; ++ i) {
+			const Slic3r::Points &pts = *m_contours[m_cell_data[i].first];
+			size_t                ipt = m_cell_data[i].second;
+			if (segments_intersect(p1, p2, pts[ipt], pts[(ipt + 1 == pts.size()) ? 0 : ipt + 1])) {
+				intersects = true;
+				// Stop the traversal.
+				return false;
+			}
+		}
+		return true;
+	});
+	return intersects;
+}
+
 #if 0
 void EdgeGrid::save_png(const EdgeGrid::Grid &grid, const BoundingBox &bbox, coord_t resolution, const char *path)
 {
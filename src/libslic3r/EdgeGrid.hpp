@@ -1,7 +1,9 @@
 #ifndef slic3r_EdgeGrid_hpp_
 #define slic3r_EdgeGrid_hpp_
 
+#include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "Point.hpp"
@@ -52,6 +54,10 @@ public:
 	// return an interpolated value from m_signed_distance_field, if it exists.
 	bool signed_distance(const Point &pt, coord_t search_radius, coordf_t &result_min_dist) const;
 
+	// Calculate the signed distances of a batch of points by signed_distance(), large batches are processed in parallel.
+	// The distances, which could not be calculated, are set to search_radius. Returns false if there was such a distance.
+	bool signed_distances(const Points &pts, coord_t search_radius, std::vector<coordf_t> &result_min_dists) const;
+
 	const BoundingBox& 	bbox() const { return m_bbox; }
 	const coord_t 		resolution() const { return m_resolution; }
 	const size_t		rows() const { return m_rows; }
@@ -65,6 +71,141 @@ public:
 	std::vector<std::pair<ContourEdge, ContourEdge>> intersecting_edges() const;
 	bool 											 has_intersecting_edges() const;
 
+	// Test whether a line segment intersects, touches or overlaps any edge of the contours.
+	// The end points are expected to be inside the bounding box of the grid.
+	bool 											 line_intersects_contours(const Point &p1, const Point &p2) const;
+
+	// Visit the cells of the grid crossed by a line segment, starting with the cell of p1.
+	// The end points are expected to be inside the bounding box of the grid.
+	// The visitor is called with the row and the column of a cell, it returns false to stop the traversal.
+	template<typename VISITOR> void visit_cells_intersecting_line(Slic3r::Point p1, Slic3r::Point p2, VISITOR visitor) const
+	{
+		p1(0) -= m_bbox.min(0);
+		p1(1) -= m_bbox.min(1);
+		p2(0) -= m_bbox.min(0);
+		p2(1) -= m_bbox.min(1);
+		// Get the cells of the end points.
+		coord_t ix    = p1(0) / m_resolution;
+		coord_t iy    = p1(1) / m_resolution;
+		coord_t ixb   = p2(0) / m_resolution;
+		coord_t iyb   = p2(1) / m_resolution;
+		assert(ix >= 0 && size_t(ix) < m_cols);
+		assert(iy >= 0 && size_t(iy) < m_rows);
+		assert(ixb >= 0 && size_t(ixb) < m_cols);
+		assert(iyb >= 0 && size_t(iyb) < m_rows);
+		// Account for the end points.
+		if (! visitor(iy, ix) || (ix == ixb && iy == iyb))
+			// Stopped by the visitor or both ends fall into the same cell.
+			return;
+		// Raster the centeral part of the line.
+		coord_t dx = std::abs(p2(0) - p1(0));
+		coord_t dy = std::abs(p2(1) - p1(1));
+		if (p1(0) < p2(0)) {
+			int64_t ex = int64_t((ix + 1)*m_resolution - p1(0)) * int64_t(dy);
+			if (p1(1) < p2(1)) {
+				// x positive, y positive
+				int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
+				do {
+					assert(ix <= ixb && iy <= iyb);
+					if (ex < ey) {
+						ey -= ex;
+						ex = int64_t(dy) * m_resolution;
+						ix += 1;
+					}
+					else if (ex == ey) {
+						ex = int64_t(dy) * m_resolution;
+						ey = int64_t(dx) * m_resolution;
+						ix += 1;
+						iy += 1;
+					}
+					else {
+						assert(ex > ey);
+						ex -= ey;
+						ey = int64_t(dx) * m_resolution;
+						iy += 1;
+					}
+					if (! visitor(iy, ix))
+						return;
+				} while (ix != ixb || iy != iyb);
+			}
+			else {
+				// x positive, y non positive
+				int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
+				do {
+					assert(ix <= ixb && iy >= iyb);
+					if (ex <= ey) {
+						ey -= ex;
+						ex = int64_t(dy) * m_resolution;
+						ix += 1;
+					}
+					else {
+						ex -= ey;
+						ey = int64_t(dx) * m_resolution;
+						iy -= 1;
+					}
+					if (! visitor(iy, ix))
+						return;
+				} while (ix != ixb || iy != iyb);
+			}
+		}
+		else {
+			int64_t ex = int64_t(p1(0) - ix*m_resolution) * int64_t(dy);
+			if (p1(1) < p2(1)) {
+				// x non positive, y positive
+				int64_t ey = int64_t((iy + 1)*m_resolution - p1(1)) * int64_t(dx);
+				do {
+					assert(ix >= ixb && iy <= iyb);
+					if (ex < ey) {
+						ey -= ex;
+						ex = int64_t(dy) * m_resolution;
+						ix -= 1;
+					}
+					else {
+						assert(ex >= ey);
+						ex -= ey;
+						ey = int64_t(dx) * m_resolution;
+						iy += 1;
+					}
+					if (! visitor(iy, ix))
+						return;
+				} while (ix != ixb || iy != iyb);
+			}
+			else {
+				// x non positive, y non positive
+				int64_t ey = int64_t(p1(1) - iy*m_resolution) * int64_t(dx);
+				do {
+					assert(ix >= ixb && iy >= iyb);
+					if (ex < ey) {
+						ey -= ex;
+						ex = int64_t(dy) * m_resolution;
+						ix -= 1;
+					}
+					else if (ex == ey) {
+						// The lower edge of a grid cell belongs to the cell.
+						// Handle the case where the ray may cross the lower left corner of a cell in a general case,
+						// or a left or lower edge in a degenerate case (horizontal or vertical line).
+						if (dx > 0) {
+							ex = int64_t(dy) * m_resolution;
+							ix -= 1;
+						}
+						if (dy > 0) {
+							ey = int64_t(dx) * m_resolution;
+							iy -= 1;
+						}
+					}
+					else {
+						assert(ex > ey);
+						ex -= ey;
+						ey = int64_t(dx) * m_resolution;
+						iy -= 1;
+					}
+					if (! visitor(iy, ix))
+						return;
+				} while (ix != ixb || iy != iyb);
+			}
+		}
+	}
+
 protected:
 	struct Cell {
 		Cell() : begin(0), end(0) {}
@@ -25,34 +25,89 @@ void ExtrusionVisitorConst::use(const ExtrusionMultiPath3D &multipath3D) { defau
 void ExtrusionVisitorConst::use(const ExtrusionLoop &loop) { default_use(loop); }
 void ExtrusionVisitorConst::use(const ExtrusionEntityCollection &collection) { default_use(collection); }
     
+size_t ExtrusionPath::compact()
+{
+    const Points &points = this->polyline.points;
+    // The header Point and two points per Point.
+    size_t num_compact = 1 + (points.size() + 1) / 2;
+    if (this->compacted() || num_compact >= points.size())
+        return 0;
+    for (const Point &pt : points)
+        if (pt.x() < std::numeric_limits<int32_t>::min() || pt.x() > std::numeric_limits<int32_t>::max() ||
+            pt.y() < std::numeric_limits<int32_t>::min() || pt.y() > std::numeric_limits<int32_t>::max())
+            return 0;
+    Points compact(num_compact, Point(0, 0));
+    compact.front() = Point(coord_t(points.size()), COMPACT_MARKER);
+    for (size_t i = 0; i < points.size(); ++ i)
+        compact[1 + i / 2](i & 1) = compact_pack(points[i]);
+    size_t released = (points.capacity() - compact.size()) * sizeof(Point);
+    this->polyline.points = std::move(compact);
+    return released;
+}
+
+void ExtrusionPath::uncompact()
+{
+    if (this->compacted())
+        this->polyline = this->as_polyline();
+}
+
+Polyline ExtrusionPath::as_polyline() const
+{
+    if (! this->compacted())
+        return this->polyline;
+    Polyline out;
+    out.points.reserve(this->compact_size());
+    for (size_t i = 0; i < this->compact_size(); ++ i)
+        out.points.emplace_back(this->compact_point(i));
+    return out;
+}
+
+void ExtrusionPath::reverse()
+{
+    if (this->compacted()) {
+        for (size_t i = 0, j = this->compact_size() - 1; i < j; ++ i, -- j)
+            std::swap(this->compact_packed(i), this->compact_packed(j));
+    } else
+        this->polyline.reverse();
+}
+
 void
 ExtrusionPath::intersect_expolygons(const ExPolygonCollection &collection, ExtrusionEntityCollection* retval) const
 {
-    this->_inflate_collection(intersection_pl(this->polyline, collection), retval);
+    Polyline decoded;
+    this->_inflate_collection(intersection_pl(this->decoded_polyline(decoded), collection), retval);
 }
 
 void
 ExtrusionPath::subtract_expolygons(const ExPolygonCollection &collection, ExtrusionEntityCollection* retval) const
 {
-    this->_inflate_collection(diff_pl(this->polyline, collection), retval);
+    Polyline decoded;
+    this->_inflate_collection(diff_pl(this->decoded_polyline(decoded), collection), retval);
 }
 
 void
 ExtrusionPath::clip_end(double distance)
 {
+    this->uncompact();
     this->polyline.clip_end(distance);
 }
 
 void
 ExtrusionPath::simplify(double tolerance)
 {
+    this->uncompact();
     this->polyline.simplify(tolerance);
 }
 
 double
 ExtrusionPath::length() const
 {
-    return this->polyline.length();
+    if (! this->compacted())
+        return this->polyline.length();
+    double len = 0.;
+    for (size_t i = 1; i < this->compact_size(); ++ i)
+        len += (this->compact_point(i) - this->compact_point(i - 1)).cast<double>().norm();
+    return len;
 }
 
 void
@@ -67,7 +122,8 @@ ExtrusionPath::_inflate_collection(const Polylines &polylines, ExtrusionEntityCo
 
 void ExtrusionPath::polygons_covered_by_width(Polygons &out, const float scaled_epsilon) const
 {
-    polygons_append(out, offset(this->polyline, double(scale_(this->width/2)) + scaled_epsilon));
+    Polyline decoded;
+    polygons_append(out, offset(this->decoded_polyline(decoded), double(scale_(this->width/2)) + scaled_epsilon));
 }
 
 void ExtrusionPath::polygons_covered_by_spacing(Polygons &out, const float scaled_epsilon) const
@@ -75,7 +131,8 @@ void ExtrusionPath::polygons_covered_by_spacing(Polygons &out, const float scale
     // Instantiating the Flow class to get the line spacing.
     // Don't know the nozzle diameter, setting to zero. It shall not matter it shall be optimized out by the compiler.
     Flow flow(this->width, this->height, 0.f, is_bridge(this->role()));
-    polygons_append(out, offset(this->polyline, 0.5f * double(flow.scaled_spacing()) + scaled_epsilon));
+    Polyline decoded;
+    polygons_append(out, offset(this->decoded_polyline(decoded), 0.5f * double(flow.scaled_spacing()) + scaled_epsilon));
 }
 
 bool
@@ -106,9 +163,11 @@ Polygon
 ExtrusionLoop::polygon() const
 {
     Polygon polygon;
+    Polyline decoded;
     for (ExtrusionPaths::const_iterator path = this->paths.begin(); path != this->paths.end(); ++path) {
         // for each polyline, append all points except the last one (because it coincides with the first one of the next polyline)
-        polygon.points.insert(polygon.points.end(), path->polyline.points.begin(), path->polyline.points.end()-1);
+        const Polyline &polyline = path->decoded_polyline(decoded);
+        polygon.points.insert(polygon.points.end(), polyline.points.begin(), polyline.points.end()-1);
     }
     return polygon;
 }
@@ -118,7 +177,7 @@ ExtrusionLoop::length() const
 {
     double len = 0;
     for (ExtrusionPaths::const_iterator path = this->paths.begin(); path != this->paths.end(); ++path)
-        len += path->polyline.length();
+        len += path->length();
     return len;
 }
 
@@ -157,6 +157,7 @@ typedef std::vector<ExtrusionEntity*> ExtrusionEntitiesPtr;
 class ExtrusionPath : public ExtrusionEntity
 {
 public:
+    // Points of the path. Holds the compact form of the points while the path is compacted, see compact().
     Polyline polyline;
     // Volumetric velocity. mm^3 of plastic per mm of linear head motion. Used by the G-code generator.
     double mm3_per_mm;
@@ -181,12 +182,24 @@ public:
     ExtrusionPath& operator=(ExtrusionPath &&rhs) { m_role = rhs.m_role; this->mm3_per_mm = rhs.mm3_per_mm; this->width = rhs.width; this->height = rhs.height; this->feedrate = rhs.feedrate, this->extruder_id = rhs.extruder_id, this->cp_color_id = rhs.cp_color_id, this->polyline = std::move(rhs.polyline); return *this; }
 
     virtual ExtrusionPath* clone() const override { return new ExtrusionPath(*this); }
-    void reverse() override { this->polyline.reverse(); }
-    Point first_point() const override { return this->polyline.points.front(); }
-    Point last_point() const override { return this->polyline.points.back(); }
-    size_t size() const { return this->polyline.size(); }
+    void reverse() override;
+    Point first_point() const override { return this->compacted() ? this->compact_point(0) : this->polyline.points.front(); }
+    Point last_point() const override { return this->compacted() ? this->compact_point(this->compact_size() - 1) : this->polyline.points.back(); }
+    size_t size() const { return this->compacted() ? this->compact_size() : this->polyline.size(); }
     bool empty() const { return this->polyline.empty(); }
-    bool is_closed() const { return ! this->empty() && this->polyline.points.front() == this->polyline.points.back(); }
+    bool is_closed() const { return ! this->empty() && this->first_point() == this->last_point(); }
+    // Stores the points of a finished path with 32 bit coordinates, two points per Point of the polyline, to save memory.
+    // The toolpaths of a layer are relative to the origin of their object (the object copies are shifted at the G-code export),
+    // therefore their coordinates fit into 32 bits unless the object is larger than 2 meters. The accessors of the path
+    // decode the points, the G-code export and the preview decode a copy of the path, see Print::set_compact_toolpaths().
+    // Returns the number of bytes released, zero if the points do not fit or if the path is too short to get smaller.
+    size_t compact();
+    // Restores the points of a compacted path.
+    void uncompact();
+    bool compacted() const { return ! this->polyline.points.empty() && this->polyline.points.front().y() == COMPACT_MARKER; }
+    // Returns the polyline of the path, or its points decoded into the given polyline if the path is compacted.
+    const Polyline& decoded_polyline(Polyline &decoded) const
+        { if (! this->compacted()) return this->polyline; decoded = this->as_polyline(); return decoded; }
     // Produce a list of extrusion paths into retval by clipping this path by ExPolygonCollection.
     // Currently not used.
     void intersect_expolygons(const ExPolygonCollection &collection, ExtrusionEntityCollection* retval) const;
@@ -207,8 +220,8 @@ public:
     void polygons_covered_by_spacing(Polygons &out, const float scaled_epsilon) const override;
     // Minimum volumetric velocity of this extrusion entity. Used by the constant nozzle pressure algorithm.
     double min_mm3_per_mm() const override { return this->mm3_per_mm; }
-    Polyline as_polyline() const override { return this->polyline; }
-    void   collect_polylines(Polylines &dst) const override { if (! this->polyline.empty()) dst.emplace_back(this->polyline); }
+    Polyline as_polyline() const override;
+    void   collect_polylines(Polylines &dst) const override { if (! this->polyline.empty()) dst.emplace_back(this->as_polyline()); }
     double total_volume() const override { return mm3_per_mm * unscale<double>(length()); }
     virtual void visit(ExtrusionVisitor &visitor) override { visitor.use(*this); };
     virtual void visit(ExtrusionVisitorConst &visitor) const override { visitor.use(*this); };
@@ -216,6 +229,16 @@ public:
 protected:
     void _inflate_collection(const Polylines &polylines, ExtrusionEntityCollection* collection) const;
 
+    // The first Point of a compacted polyline holds the number of points and this marker, no valid point has such coordinate.
+    // Each coordinate of the following Points holds a point, its 32 bit x and y coordinates packed into the low and high half.
+    static const coord_t COMPACT_MARKER = std::numeric_limits<coord_t>::min();
+    static coord_t compact_pack(const Point &pt) { return coord_t(uint64_t(uint32_t(int32_t(pt.x()))) | (uint64_t(uint32_t(int32_t(pt.y()))) << 32)); }
+    static Point   compact_unpack(coord_t packed) { return Point(int32_t(uint32_t(uint64_t(packed))), int32_t(uint32_t(uint64_t(packed) >> 32))); }
+    size_t         compact_size() const { return size_t(this->polyline.points.front().x()); }
+    const coord_t& compact_packed(size_t idx) const { return this->polyline.points[1 + idx / 2](idx & 1); }
+    coord_t&       compact_packed(size_t idx) { return this->polyline.points[1 + idx / 2](idx & 1); }
+    Point          compact_point(size_t idx) const { return compact_unpack(this->compact_packed(idx)); }
+
     ExtrusionRole m_role;
 };
 typedef std::vector<ExtrusionPath> ExtrusionPaths;
@@ -242,7 +265,7 @@ public:
     virtual void visit(ExtrusionVisitor &visitor) override { visitor.use(*this); };
     virtual void visit(ExtrusionVisitorConst &visitor) const override { visitor.use(*this); };
 
-    void push_back(Point p, coord_t z_offset) { polyline.points.push_back(p); z_offsets.push_back(z_offset); }
+    void push_back(Point p, coord_t z_offset) { assert(! this->compacted()); polyline.points.push_back(p); z_offsets.push_back(z_offset); }
 
     //TODO: simplify only for points that have the same z-offset
     void simplify(double tolerance) override {}
@@ -269,6 +292,9 @@ public:
     virtual Point first_point() const override { return this->paths.back().as_polyline().points.back(); }
     virtual Point last_point() const override { return this->paths.back().as_polyline().points.back(); }
 
+    bool compacted() const { for (const THING &path : this->paths) if (path.compacted()) return true; return false; }
+    void uncompact() { for (THING &path : this->paths) path.uncompact(); }
+
     virtual void reverse() override {
         for (THING &entity : this->paths)
             entity.reverse();
@@ -311,7 +337,7 @@ public:
             size_t len = 0;
             for (size_t i_path = 0; i_path < paths.size(); ++i_path) {
                 assert(!paths[i_path].as_polyline().points.empty());
-                assert(i_path == 0 || paths[i_path - 1].polyline.points.back() == paths[i_path].as_polyline().points.front());
+                assert(i_path == 0 || paths[i_path - 1].last_point() == paths[i_path].first_point());
                 len += paths[i_path].as_polyline().points.size();
             }
             // The connecting points between the segments are equal.
@@ -388,8 +414,10 @@ public:
     bool make_clockwise();
     bool make_counter_clockwise();
     void reverse();
-    Point first_point() const override { return this->paths.front().polyline.points.front(); }
-    Point last_point() const override { assert(first_point() == this->paths.back().polyline.points.back()); return first_point(); }
+    Point first_point() const override { return this->paths.front().first_point(); }
+    Point last_point() const override { assert(first_point() == this->paths.back().last_point()); return first_point(); }
+    bool compacted() const { for (const ExtrusionPath &path : this->paths) if (path.compacted()) return true; return false; }
+    void uncompact() { for (ExtrusionPath &path : this->paths) path.uncompact(); }
     Polygon polygon() const;
     double length() const override;
     bool split_at_vertex(const Point &point);
@@ -108,54 +108,66 @@ void ExtrusionEntityCollection::chained_path_from(Point start_near, ExtrusionEnt
         *retval = *this;
         return;
     }
-    retval->entities.reserve(this->entities.size());
-    retval->orig_indices.reserve(this->entities.size());
-    
-    // if we're asked to return the original indices, build a map
-    std::map<ExtrusionEntity*,size_t> indices_map;
-    
-    ExtrusionEntitiesPtr my_paths;
-    for (ExtrusionEntitiesPtr::const_iterator it = this->entities.begin(); it != this->entities.end(); ++it) {
+    std::vector<ChainedEntity> chained = this->chained_order_from(start_near, no_reverse, role);
+    retval->entities.reserve(chained.size());
+    retval->orig_indices.reserve(chained.size());
+    for (ChainedEntity &entity : chained) {
+        retval->entities.push_back(entity.reversed ? entity.reversed.release() : this->entities[entity.idx]->clone());
+        if (orig_indices != NULL) orig_indices->push_back(entity.idx);
+    }
+}
+
+std::vector<ExtrusionEntityCollection::ChainedEntity> ExtrusionEntityCollection::chained_order_from(Point start_near, bool no_reverse, ExtrusionRole role) const
+{
+    std::vector<ChainedEntity> out;
+    std::vector<size_t>        my_paths;
+    my_paths.reserve(this->entities.size());
+    for (size_t idx = 0; idx < this->entities.size(); ++ idx) {
         if (role != erMixed) {
             // The caller wants only paths with a specific extrusion role.
-            ExtrusionRole role2 = (*it)->role();
+            ExtrusionRole role2 = this->entities[idx]->role();
             if (role != role2) {
                 // This extrusion entity does not match the role asked.
                 assert(role2 != erMixed);
                 continue;
             }
         }
-
-        ExtrusionEntity* entity = (*it)->clone();
-        my_paths.push_back(entity);
-        if (orig_indices != NULL) indices_map[entity] = it - this->entities.begin();
+        my_paths.push_back(idx);
     }
+    out.reserve(my_paths.size());
     
     Points endpoints;
-    for (ExtrusionEntitiesPtr::iterator it = my_paths.begin(); it != my_paths.end(); ++it) {
-        endpoints.push_back((*it)->first_point());
-        if (no_reverse || !(*it)->can_reverse()) {
-            endpoints.push_back((*it)->first_point());
+    endpoints.reserve(2 * my_paths.size());
+    for (size_t idx : my_paths) {
+        const ExtrusionEntity *entity = this->entities[idx];
+        endpoints.push_back(entity->first_point());
+        if (no_reverse || !entity->can_reverse()) {
+            endpoints.push_back(entity->first_point());
         } else {
-            endpoints.push_back((*it)->last_point());
+            endpoints.push_back(entity->last_point());
         }
     }
     
-    while (!my_paths.empty()) {
+    NearestPointLookup lookup(endpoints);
+    while (! lookup.empty()) {
         // find nearest point
-        int start_index = start_near.nearest_point_index(endpoints);
+        int start_index = lookup.nearest(start_near);
         int path_index = start_index/2;
-        ExtrusionEntity* entity = my_paths.at(path_index);
+        ChainedEntity chained;
+        chained.idx = my_paths[path_index];
+        const ExtrusionEntity *entity = this->entities[chained.idx];
         // never reverse loops, since it's pointless for chained path and callers might depend on orientation
         if (start_index % 2 && !no_reverse && entity->can_reverse()) {
-            entity->reverse();
+            chained.reversed.reset(entity->clone());
+            chained.reversed->reverse();
+            entity = chained.reversed.get();
         }
-        retval->entities.push_back(my_paths.at(path_index));
-        if (orig_indices != NULL) orig_indices->push_back(indices_map[entity]);
-        my_paths.erase(my_paths.begin() + path_index);
-        endpoints.erase(endpoints.begin() + 2*path_index, endpoints.begin() + 2*path_index + 2);
-        start_near = retval->entities.back()->last_point();
+        start_near = entity->last_point();
+        out.emplace_back(std::move(chained));
+        lookup.remove(2*path_index);
+        lookup.remove(2*path_index + 1);
     }
+    return out;
 }
 
 void ExtrusionEntityCollection::polygons_covered_by_width(Polygons &out, const float scaled_epsilon) const
@@ -237,6 +249,54 @@ FlatenEntities::use(const ExtrusionEntityCollection &coll) {
         }
     }
 }
+template<typename T> static size_t shrink_vector_to_fit(std::vector<T> &v)
+{
+    size_t released = (v.capacity() - v.size()) * sizeof(T);
+    if (released > 0)
+        v.shrink_to_fit();
+    return released;
+}
+
+void ShrinkToFitEntities::use(ExtrusionPath &path)
+{
+    size_t compacted = this->compact_points ? path.compact() : 0;
+    released += (compacted > 0) ? compacted : shrink_vector_to_fit(path.polyline.points);
+}
+
+void ShrinkToFitEntities::use(ExtrusionPath3D &path3D)
+{
+    size_t compacted = this->compact_points ? path3D.compact() : 0;
+    released += ((compacted > 0) ? compacted : shrink_vector_to_fit(path3D.polyline.points)) + shrink_vector_to_fit(path3D.z_offsets);
+}
+
+void ShrinkToFitEntities::use(ExtrusionMultiPath &multipath)
+{
+    released += shrink_vector_to_fit(multipath.paths);
+    for (ExtrusionPath &path : multipath.paths)
+        this->use(path);
+}
+
+void ShrinkToFitEntities::use(ExtrusionMultiPath3D &multipath3D)
+{
+    released += shrink_vector_to_fit(multipath3D.paths);
+    for (ExtrusionPath3D &path : multipath3D.paths)
+        this->use(path);
+}
+
+void ShrinkToFitEntities::use(ExtrusionLoop &loop)
+{
+    released += shrink_vector_to_fit(loop.paths);
+    for (ExtrusionPath &path : loop.paths)
+        this->use(path);
+}
+
+void ShrinkToFitEntities::use(ExtrusionEntityCollection &collection)
+{
+    released += shrink_vector_to_fit(collection.entities) + shrink_vector_to_fit(collection.orig_indices);
+    for (ExtrusionEntity *entity : collection.entities)
+        entity->visit(*this);
+}
+
 ExtrusionEntityCollection&&
 FlatenEntities::flatten(const ExtrusionEntityCollection &to_flatten) && {
     use(to_flatten);
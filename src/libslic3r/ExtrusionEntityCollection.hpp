@@ -4,6 +4,8 @@
 #include "libslic3r.h"
 #include "ExtrusionEntity.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 class ExtrusionEntityCollection : public ExtrusionEntity
@@ -44,6 +46,7 @@ public:
     void clear();
     void swap (ExtrusionEntityCollection &c);
     void append(const ExtrusionEntity &entity) { this->entities.push_back(entity.clone()); }
+    void append(ExtrusionEntityCollection &&collection) { this->entities.push_back(new ExtrusionEntityCollection(std::move(collection))); }
     void append(const ExtrusionEntitiesPtr &entities) { 
         this->entities.reserve(this->entities.size() + entities.size());
         for (ExtrusionEntitiesPtr::const_iterator ptr = entities.begin(); ptr != entities.end(); ++ptr)
@@ -73,6 +76,16 @@ public:
     void chained_path(ExtrusionEntityCollection* retval, bool no_reverse = false, ExtrusionRole role = erMixed, std::vector<size_t>* orig_indices = nullptr) const;
     ExtrusionEntityCollection chained_path_from(Point start_near, bool no_reverse = false, ExtrusionRole role = erMixed) const;
     void chained_path_from(Point start_near, ExtrusionEntityCollection* retval, bool no_reverse = false, ExtrusionRole role = erMixed, std::vector<size_t>* orig_indices = nullptr) const;
+    // Entity of this collection in the order produced by chained_order_from().
+    struct ChainedEntity {
+        // Index into this->entities.
+        size_t                              idx;
+        // Reversed copy of the entity, if the entity shall be extruded in the opposite direction.
+        std::unique_ptr<ExtrusionEntity>    reversed;
+    };
+    // Same ordering as chained_path_from(), but the entities are referenced by their index instead of being cloned.
+    // Only the entities to be reversed are copied.
+    std::vector<ChainedEntity> chained_order_from(Point start_near, bool no_reverse = false, ExtrusionRole role = erMixed) const;
     void reverse();
     Point first_point() const { return this->entities.front()->first_point(); }
     Point last_point() const { return this->entities.back()->last_point(); }
@@ -133,6 +146,23 @@ public:
     virtual void use(const ExtrusionEntityCollection &coll) override;
 };
 
+// Releases the unused capacity of the vectors of points and paths of final extrusion entities
+// to lower the memory footprint of the finished layers. Returns the number of bytes released.
+// With compact_points, the points of the paths are moved to their 32 bit CompactPoints, see ExtrusionPath::compact().
+class ShrinkToFitEntities : public ExtrusionVisitor {
+public:
+    ShrinkToFitEntities(bool compact_points = false) : compact_points(compact_points) {}
+    size_t shrink(ExtrusionEntity &entity) { entity.visit(*this); return released; }
+    size_t released = 0;
+    bool   compact_points;
+    virtual void use(ExtrusionPath &path) override;
+    virtual void use(ExtrusionPath3D &path3D) override;
+    virtual void use(ExtrusionMultiPath &multipath) override;
+    virtual void use(ExtrusionMultiPath3D &multipath3D) override;
+    virtual void use(ExtrusionLoop &loop) override;
+    virtual void use(ExtrusionEntityCollection &collection) override;
+};
+
 class FlatenEntities : public ExtrusionVisitorConst {
     ExtrusionEntityCollection to_fill;
     bool preserve_ordering;
@@ -9,7 +9,9 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <deque>
 #include <math.h>
+#include <mutex>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/find.hpp>
@@ -21,6 +23,9 @@
 #include <boost/nowide/cstdio.hpp>
 #include <boost/nowide/cstdlib.hpp>
 
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
+
 #include "SVG.hpp"
 
 #include <Shiny/Shiny.h>
@@ -43,6 +48,42 @@ static inline void check_add_eol(std::string &gcode)
         gcode += '\n';    
 }
     
+static bool expolygons_equal(const ExPolygons &expolygons1, const ExPolygons &expolygons2)
+{
+    if (expolygons1.size() != expolygons2.size())
+        return false;
+    for (size_t i = 0; i < expolygons1.size(); ++ i) {
+        const ExPolygon &expoly1 = expolygons1[i];
+        const ExPolygon &expoly2 = expolygons2[i];
+        if (expoly1.holes.size() != expoly2.holes.size() || expoly1.contour.points != expoly2.contour.points)
+            return false;
+        for (size_t j = 0; j < expoly1.holes.size(); ++ j)
+            if (expoly1.holes[j].points != expoly2.holes[j].points)
+                return false;
+    }
+    return true;
+}
+
+void AvoidCrossingPerimeters::init_layer_mp(const ExPolygons &slices)
+{
+    // The motion planner is requested for each object and extruder of each layer. Objects printed multiple times
+    // and prismatic objects produce the same slices over and over, reuse their motion planners.
+    static const size_t layer_mp_cache_size = 8;
+    auto it = std::find_if(m_layer_mp_cache.begin(), m_layer_mp_cache.end(),
+        [&slices](const LayerMotionPlanner &cached) { return expolygons_equal(cached.slices, slices); });
+    if (it == m_layer_mp_cache.end()) {
+        if (m_layer_mp_cache.size() == layer_mp_cache_size)
+            m_layer_mp_cache.pop_back();
+        LayerMotionPlanner layer_mp;
+        layer_mp.slices = slices;
+        layer_mp.mp     = Slic3r::make_unique<MotionPlanner>(union_ex(slices, true));
+        m_layer_mp_cache.insert(m_layer_mp_cache.begin(), std::move(layer_mp));
+    } else if (it != m_layer_mp_cache.begin())
+        // Move to front.
+        std::rotate(m_layer_mp_cache.begin(), it, it + 1);
+    m_layer_mp = m_layer_mp_cache.front().mp.get();
+}
+
 // Plan a travel move while minimizing the number of perimeter crossings.
 // point is in unscaled coordinates, in the coordinate system of the current active object
 // (set by gcodegen.set_origin()).
@@ -52,7 +93,7 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     // Otherwise perform the path planning in the coordinate system of the active object.
     bool  use_external  = this->use_external_mp || this->use_external_mp_once;
     Point scaled_origin = use_external ? Point::new_scale(gcodegen.origin()(0), gcodegen.origin()(1)) : Point(0, 0);
-    Polyline result = (use_external ? m_external_mp.get() : m_layer_mp.get())->
+    Polyline result = (use_external ? m_external_mp.get() : m_layer_mp)->
         shortest_path(gcodegen.last_pos() + scaled_origin, point + scaled_origin);
     if (use_external)
         result.translate(- scaled_origin);
@@ -532,6 +573,7 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
     try {
         m_placeholder_parser_failed_templates.clear();
         this->_do_export(*print, file);
+        assert(! m_output_pipeline);
         fflush(file);
         if (ferror(file)) {
             fclose(file);
@@ -540,7 +582,8 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
         }
     } catch (std::exception & /* ex */) {
         // Rethrow on any exception. std::runtime_exception and CanceledException are expected to be thrown.
-        // Close and remove the file.
+        // Stop the output threads, close and remove the file.
+        m_output_pipeline.reset();
         fclose(file);
         boost::nowide::remove(path_tmp.c_str());
         throw;
@@ -561,14 +604,10 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
     }
 
     if (print->config().remaining_times.value) {
-        BOOST_LOG_TRIVIAL(debug) << "Processing remaining times for normal mode";
-        m_normal_time_estimator.post_process_remaining_times(path_tmp, 60.0f);
+        // The remaining times were already filled in by _do_export().
         m_normal_time_estimator.reset();
-        if (m_silent_time_estimator_enabled) {
-            BOOST_LOG_TRIVIAL(debug) << "Processing remaining times for silent mode";
-            m_silent_time_estimator.post_process_remaining_times(path_tmp, 60.0f);
+        if (m_silent_time_estimator_enabled)
             m_silent_time_estimator.reset();
-        }
     }
 
     // starts analyzer calculations
@@ -591,72 +630,40 @@ void GCode::do_export(Print *print, const char *path, GCodePreviewData *preview_
     PROFILE_OUTPUT(debug_out_path("gcode-export-profile.txt").c_str());
 }
 
+static int fseek_64(FILE *file, int64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, off_t(offset), origin);
+#endif
+}
+
+static int64_t ftell_64(FILE *file)
+{
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return int64_t(ftello(file));
+#endif
+}
+
 void GCode::_do_export(Print &print, FILE *file)
 {
     PROFILE_FUNC();
 
     // resets time estimators
-    m_normal_time_estimator.reset();
-    m_normal_time_estimator.set_dialect(print.config().gcode_flavor);
-    m_silent_time_estimator_enabled = (print.config().gcode_flavor == gcfMarlin) && print.config().silent_mode;
-
-    // Until we have a UI support for the other firmwares than the Marlin, use the hardcoded default values
-    // and let the user to enter the G-code limits into the start G-code.
-    // If the following block is enabled for other firmwares than the Marlin, then the function
+    // Until we have a UI support for the other firmwares than the Marlin, the time estimators use the hardcoded default values
+    // for the other firmwares and let the user to enter the G-code limits into the start G-code.
+    // If the machine limits are applied for other firmwares than the Marlin, then the function
     // this->print_machine_envelope(file, print);
     // shall be adjusted as well to produce a G-code block compatible with the particular firmware flavor.
-    if (print.config().gcode_flavor.value == gcfMarlin) {
-        m_normal_time_estimator.set_max_acceleration((float)print.config().machine_max_acceleration_extruding.values[0]);
-		m_normal_time_estimator.set_retract_acceleration((float)print.config().machine_max_acceleration_retracting.values[0]);
-		m_normal_time_estimator.set_minimum_feedrate((float)print.config().machine_min_extruding_rate.values[0]);
-		m_normal_time_estimator.set_minimum_travel_feedrate((float)print.config().machine_min_travel_rate.values[0]);
-		m_normal_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::X, (float)print.config().machine_max_acceleration_x.values[0]);
-		m_normal_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::Y, (float)print.config().machine_max_acceleration_y.values[0]);
-		m_normal_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::Z, (float)print.config().machine_max_acceleration_z.values[0]);
-		m_normal_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::E, (float)print.config().machine_max_acceleration_e.values[0]);
-		m_normal_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::X, (float)print.config().machine_max_feedrate_x.values[0]);
-		m_normal_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::Y, (float)print.config().machine_max_feedrate_y.values[0]);
-		m_normal_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::Z, (float)print.config().machine_max_feedrate_z.values[0]);
-		m_normal_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::E, (float)print.config().machine_max_feedrate_e.values[0]);
-		m_normal_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::X, (float)print.config().machine_max_jerk_x.values[0]);
-		m_normal_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::Y, (float)print.config().machine_max_jerk_y.values[0]);
-		m_normal_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::Z, (float)print.config().machine_max_jerk_z.values[0]);
-		m_normal_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::E, (float)print.config().machine_max_jerk_e.values[0]);
-
-        if (m_silent_time_estimator_enabled && print.config().machine_max_acceleration_extruding.values.size() > 1)
-        {
-            m_silent_time_estimator.reset();
-            m_silent_time_estimator.set_dialect(print.config().gcode_flavor);
-			m_silent_time_estimator.set_max_acceleration((float)print.config().machine_max_acceleration_extruding.values[1]);
-			m_silent_time_estimator.set_retract_acceleration((float)print.config().machine_max_acceleration_retracting.values[1]);
-			m_silent_time_estimator.set_minimum_feedrate((float)print.config().machine_min_extruding_rate.values[1]);
-			m_silent_time_estimator.set_minimum_travel_feedrate((float)print.config().machine_min_travel_rate.values[1]);
-			m_silent_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::X, (float)print.config().machine_max_acceleration_x.values[1]);
-			m_silent_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::Y, (float)print.config().machine_max_acceleration_y.values[1]);
-			m_silent_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::Z, (float)print.config().machine_max_acceleration_z.values[1]);
-			m_silent_time_estimator.set_axis_max_acceleration(GCodeTimeEstimator::E, (float)print.config().machine_max_acceleration_e.values[1]);
-			m_silent_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::X, (float)print.config().machine_max_feedrate_x.values[1]);
-			m_silent_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::Y, (float)print.config().machine_max_feedrate_y.values[1]);
-			m_silent_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::Z, (float)print.config().machine_max_feedrate_z.values[1]);
-			m_silent_time_estimator.set_axis_max_feedrate(GCodeTimeEstimator::E, (float)print.config().machine_max_feedrate_e.values[1]);
-			m_silent_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::X, (float)print.config().machine_max_jerk_x.values[1]);
-			m_silent_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::Y, (float)print.config().machine_max_jerk_y.values[1]);
-			m_silent_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::Z, (float)print.config().machine_max_jerk_z.values[1]);
-			m_silent_time_estimator.set_axis_max_jerk(GCodeTimeEstimator::E, (float)print.config().machine_max_jerk_e.values[1]);
-            if (print.config().single_extruder_multi_material) {
-                // As of now the fields are shown at the UI dialog in the same combo box as the ramming values, so they
-                // are considered to be active for the single extruder multi-material printers only.
-                m_silent_time_estimator.set_filament_load_times(print.config().filament_load_time.values);
-                m_silent_time_estimator.set_filament_unload_times(print.config().filament_unload_time.values);
-            }
-        }
-    }
-    // Filament load / unload times are not specific to a firmware flavor. Let anybody use it if they find it useful.
-    if (print.config().single_extruder_multi_material) {
-        // As of now the fields are shown at the UI dialog in the same combo box as the ramming values, so they
-        // are considered to be active for the single extruder multi-material printers only.
-        m_normal_time_estimator.set_filament_load_times(print.config().filament_load_time.values);
-        m_normal_time_estimator.set_filament_unload_times(print.config().filament_unload_time.values);
+    m_normal_time_estimator.reset();
+    m_normal_time_estimator.apply_print_config(print.config());
+    m_silent_time_estimator_enabled = (print.config().gcode_flavor == gcfMarlin) && print.config().silent_mode;
+    if (m_silent_time_estimator_enabled) {
+        m_silent_time_estimator.reset();
+        m_silent_time_estimator.apply_print_config(print.config());
     }
 
     // resets analyzer
@@ -680,6 +687,46 @@ void GCode::_do_export(Print &print, FILE *file)
     m_last_width = GCodeAnalyzer::Default_Width;
     m_last_height = GCodeAnalyzer::Default_Height;
 
+    // From now on the G-code is passed to the analyzer, to the time estimators and to the output file
+    // on background threads, overlapping with the G-code generation. The analyzer and the time estimators
+    // shall not be accessed until the pipeline is flushed.
+    {
+        m_remaining_times_placeholder.clear();
+        m_remaining_times_offsets.clear();
+        if (print.config().remaining_times.value) {
+            m_remaining_times_placeholder = GCodeTimeEstimator::Normal_M73_Placeholder + "\n";
+            if (m_silent_time_estimator_enabled)
+                m_remaining_times_placeholder += GCodeTimeEstimator::Silent_M73_Placeholder + "\n";
+        }
+        std::vector<GCodeOutputPipeline::Consumer> consumers;
+        int64_t file_pos = ftell_64(file);
+        consumers.emplace_back([this, file, file_pos](const std::string &gcode, bool reserved) mutable {
+            // The reserved M73 lines are pushed by _reserve_remaining_times(), remember where they were written.
+            if (reserved)
+                m_remaining_times_offsets.emplace_back(file_pos);
+            fwrite(gcode.data(), 1, gcode.size(), file);
+            file_pos += int64_t(gcode.size());
+        });
+        consumers.emplace_back([this](const std::string &gcode, bool reserved) {
+            if (reserved)
+                m_normal_time_estimator.add_remaining_times_placeholder();
+            else
+                m_normal_time_estimator.add_gcode_block(gcode);
+        });
+        if (m_silent_time_estimator_enabled)
+            consumers.emplace_back([this](const std::string &gcode, bool reserved) {
+                if (reserved)
+                    m_silent_time_estimator.add_remaining_times_placeholder();
+                else
+                    m_silent_time_estimator.add_gcode_block(gcode);
+            });
+        GCodeOutputPipeline::Filter filter;
+        if (m_enable_analyzer)
+            // The analyzer removes its tags from the G-code.
+            filter = [this](const std::string &gcode) { return m_analyzer.process_gcode(gcode); };
+        m_output_pipeline.reset(new GCodeOutputPipeline(std::move(filter), std::move(consumers)));
+    }
+
     // How many times will be change_layer() called?
     // change_layer() in turn increments the progress bar status.
     m_layer_count = 0;
@@ -828,13 +875,8 @@ void GCode::_do_export(Print &print, FILE *file)
 
     print.throw_if_canceled();
     
-    // adds tags for time estimators
-    if (print.config().remaining_times.value)
-    {
-        _writeln(file, GCodeTimeEstimator::Normal_First_M73_Output_Placeholder_Tag);
-        if (m_silent_time_estimator_enabled)
-            _writeln(file, GCodeTimeEstimator::Silent_First_M73_Output_Placeholder_Tag);
-    }
+    // Reserve the lines for the total print time.
+    this->_reserve_remaining_times(file);
 
     // Prepare the helper object for replacing placeholders in custom G-code and output filename.
     m_placeholder_parser = print.placeholder_parser();
@@ -1032,13 +1074,10 @@ void GCode::_do_export(Print &print, FILE *file)
                 m_cooling_buffer->reset();
                 m_cooling_buffer->set_current_extruder(initial_extruder_id);
                 // Pair the object layers with the support layers by z, extrude them.
-                std::vector<LayerToPrint> layers_to_print = collect_layers_to_print(object);
-                for (const LayerToPrint &ltp : layers_to_print) {
-                    std::vector<LayerToPrint> lrs;
-                    lrs.emplace_back(std::move(ltp));
-                    this->process_layer(file, print, lrs, tool_ordering.tools_for_layer(ltp.print_z()), &copy - object.copies().data());
-                    print.throw_if_canceled();
-                }
+                std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> layers_to_print;
+                for (const LayerToPrint &ltp : collect_layers_to_print(object))
+                    layers_to_print.emplace_back(ltp.print_z(), std::vector<LayerToPrint>(1, ltp));
+                this->process_layers(file, print, tool_ordering, layers_to_print, &copy - object.copies().data());
 #ifdef HAS_PRESSURE_EQUALIZER
                 if (m_pressure_equalizer)
                     _write(file, m_pressure_equalizer->process("", true));
@@ -1090,13 +1129,7 @@ void GCode::_do_export(Print &print, FILE *file)
             print.throw_if_canceled();
         }
         // Extrude the layers.
-        for (auto &layer : layers_to_print) {
-            const LayerTools &layer_tools = tool_ordering.tools_for_layer(layer.first);
-            if (m_wipe_tower && layer_tools.has_wipe_tower)
-                m_wipe_tower->next_layer();
-            this->process_layer(file, print, layer.second, layer_tools, size_t(-1));
-            print.throw_if_canceled();
-        }
+        this->process_layers(file, print, tool_ordering, layers_to_print, size_t(-1));
 #ifdef HAS_PRESSURE_EQUALIZER
         if (m_pressure_equalizer)
             _write(file, m_pressure_equalizer->process("", true));
@@ -1140,16 +1173,22 @@ void GCode::_do_export(Print &print, FILE *file)
     _write(file, m_writer.update_progress(m_layer_count, m_layer_count, true)); // 100%
     _write(file, m_writer.postamble());
 
-    // adds tags for time estimators
+    // Print finished.
     if (print.config().remaining_times.value)
     {
-        _writeln(file, GCodeTimeEstimator::Normal_Last_M73_Output_Placeholder_Tag);
+        _write(file, "M73 P100 R0\n");
         if (m_silent_time_estimator_enabled)
-            _writeln(file, GCodeTimeEstimator::Silent_Last_M73_Output_Placeholder_Tag);
+            _write(file, "M73 Q100 S0\n");
     }
 
     print.throw_if_canceled();
 
+    // Wait for the time estimators to process the G-code exported so far.
+    m_output_pipeline->flush();
+    BOOST_LOG_TRIVIAL(debug) << "Exported G-code, time estimator memory: " <<
+        format_memsize_MB(m_normal_time_estimator.memory_used() + (m_silent_time_estimator_enabled ? m_silent_time_estimator.memory_used() : 0)) <<
+        ", analyzer memory: " << format_memsize_MB(m_analyzer.memory_used());
+
     // calculates estimated printing time
     m_normal_time_estimator.calculate_time(false);
     if (m_silent_time_estimator_enabled)
@@ -1212,9 +1251,10 @@ void GCode::_do_export(Print &print, FILE *file)
     }
     _write_format(file, "; total filament used [g] = %.1lf\n", print.m_print_statistics.total_weight);
     _write_format(file, "; total filament cost = %.1lf\n", print.m_print_statistics.total_cost);
-    _write_format(file, "; estimated printing time (normal mode) = %s\n", m_normal_time_estimator.get_time_dhms().c_str());
+    // The time estimators are consuming the G-code again, use the times stored into the print statistics above.
+    _write_format(file, "; estimated printing time (normal mode) = %s\n", print.m_print_statistics.estimated_normal_print_time.c_str());
     if (m_silent_time_estimator_enabled)
-        _write_format(file, "; estimated printing time (silent mode) = %s\n", m_silent_time_estimator.get_time_dhms().c_str());
+        _write_format(file, "; estimated printing time (silent mode) = %s\n", print.m_print_statistics.estimated_silent_print_time.c_str());
 
     // Append full config.
     _write(file, "\n");
@@ -1225,6 +1265,13 @@ void GCode::_do_export(Print &print, FILE *file)
             _write(file, full_config);
     }
     print.throw_if_canceled();
+
+    // Write the rest of the G-code and stop the output threads.
+    m_output_pipeline->finish();
+    m_output_pipeline.reset();
+
+    // The print time is known now, fill in the reserved M73 lines.
+    this->_write_remaining_times(file);
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
@@ -1301,28 +1348,36 @@ static bool custom_gcode_sets_temperature(const std::string &gcode, const int mc
 void GCode::print_machine_envelope(FILE *file, Print &print)
 {
     if (print.config().gcode_flavor.value == gcfMarlin) {
-        fprintf(file, "M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
+        char buf[1024];
+        std::string out;
+        sprintf(buf, "M201 X%d Y%d Z%d E%d ; sets maximum accelerations, mm/sec^2\n",
             int(print.config().machine_max_acceleration_x.values.front() + 0.5),
             int(print.config().machine_max_acceleration_y.values.front() + 0.5),
             int(print.config().machine_max_acceleration_z.values.front() + 0.5),
             int(print.config().machine_max_acceleration_e.values.front() + 0.5));
-        fprintf(file, "M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
+        out += buf;
+        sprintf(buf, "M203 X%d Y%d Z%d E%d ; sets maximum feedrates, mm/sec\n",
             int(print.config().machine_max_feedrate_x.values.front() + 0.5),
             int(print.config().machine_max_feedrate_y.values.front() + 0.5),
             int(print.config().machine_max_feedrate_z.values.front() + 0.5),
             int(print.config().machine_max_feedrate_e.values.front() + 0.5));
-        fprintf(file, "M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
+        out += buf;
+        sprintf(buf, "M204 P%d R%d T%d ; sets acceleration (P, T) and retract acceleration (R), mm/sec^2\n",
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5),
             int(print.config().machine_max_acceleration_retracting.values.front() + 0.5),
             int(print.config().machine_max_acceleration_extruding.values.front() + 0.5));
-        fprintf(file, "M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
+        out += buf;
+        sprintf(buf, "M205 X%.2lf Y%.2lf Z%.2lf E%.2lf ; sets the jerk limits, mm/sec\n",
             print.config().machine_max_jerk_x.values.front(),
             print.config().machine_max_jerk_y.values.front(),
             print.config().machine_max_jerk_z.values.front(),
             print.config().machine_max_jerk_e.values.front());
-        fprintf(file, "M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
+        out += buf;
+        sprintf(buf, "M205 S%d T%d ; sets the minimum extruding and travel feed rate, mm/sec\n",
             int(print.config().machine_min_extruding_rate.values.front() + 0.5),
             int(print.config().machine_min_travel_rate.values.front() + 0.5));
+        out += buf;
+        _write_unprocessed(file, std::move(out));
     }
 }
 
@@ -1405,6 +1460,276 @@ inline std::vector<GCode::ObjectByExtruder::Island>& object_islands_by_extruder(
     return islands;
 }
 
+// Distance field over the slices of a layer, used to detect overhangs of the perimeters of the layer above.
+static std::shared_ptr<const EdgeGrid::Grid> calculate_layer_edge_grid(const Layer &layer)
+{
+    const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
+    std::shared_ptr<EdgeGrid::Grid> grid = std::make_shared<EdgeGrid::Grid>();
+    grid->create(layer.slices, distance_field_resolution);
+    grid->calculate_sdf();
+    return grid;
+}
+
+// Distance fields over the slices of the recently prepared layers. A distance field is shared by the layers printed
+// over identical slices (prismatic objects), it references the slices of the first of these layers.
+// Called by collect_layer_extrusions() from multiple threads.
+class GCode::EdgeGridCache
+{
+public:
+    std::shared_ptr<const EdgeGrid::Grid> get(const Layer &layer)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const Entry &entry : m_entries)
+                if (expolygons_equal(entry.layer->slices.expolygons, layer.slices.expolygons))
+                    return entry.grid;
+        }
+        // Calculate the distance field outside of the lock. If two threads calculate the same distance field, both are cached,
+        // which is harmless.
+        Entry entry { &layer, calculate_layer_edge_grid(layer) };
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.size() == max_entries)
+            m_entries.pop_back();
+        m_entries.push_front(entry);
+        return entry.grid;
+    }
+
+private:
+    // A few layers of each of a few objects are prepared at the same time.
+    static const size_t max_entries = 8;
+    struct Entry {
+        const Layer                            *layer;
+        std::shared_ptr<const EdgeGrid::Grid>   grid;
+    };
+    std::mutex          m_mutex;
+    // The most recently calculated first.
+    std::deque<Entry>   m_entries;
+};
+
+void GCode::process_layers(
+    FILE                                                               *file,
+    const Print                                                        &print,
+    const ToolOrdering                                                 &tool_ordering,
+    const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>  &layers,
+    const size_t                                                        single_object_idx)
+{
+    std::vector<const LayerTools*> layer_tools;
+    layer_tools.reserve(layers.size());
+    for (const std::pair<coordf_t, std::vector<LayerToPrint>> &layer : layers)
+        layer_tools.emplace_back(&tool_ordering.tools_for_layer(layer.first));
+    // Extrusions of the layers prepared ahead of the G-code emission, released once a layer is emitted.
+    std::vector<LayerExtrusions> layer_extrusions(layers.size());
+    EdgeGridCache                edge_grid_cache;
+    // Limit the number of layers prepared ahead to keep the memory use bounded.
+    const size_t max_layers_in_flight = 2 * size_t(std::max(1, tbb::task_scheduler_init::default_num_threads()));
+    size_t       next_layer           = 0;
+    // A range of layers to be prepared by a single task.
+    typedef std::pair<size_t, size_t> LayerRange;
+    tbb::parallel_pipeline(max_layers_in_flight,
+        tbb::make_filter<void, LayerRange>(tbb::filter::serial_in_order,
+            [&layers, &layer_tools, &next_layer](tbb::flow_control &fc) -> LayerRange {
+                if (next_layer == layers.size()) {
+                    fc.stop();
+                    return LayerRange(0, 0);
+                }
+                // Consecutive layers sharing the same LayerTools are prepared by a single task,
+                // as grouping of their extrusions updates the wiping extrusions of the LayerTools.
+                size_t begin = next_layer ++;
+                while (next_layer < layers.size() && layer_tools[next_layer] == layer_tools[begin])
+                    ++ next_layer;
+                return LayerRange(begin, next_layer);
+            }) &
+        tbb::make_filter<LayerRange, LayerRange>(tbb::filter::parallel,
+            [&print, &layers, &layer_tools, &edge_grid_cache, &layer_extrusions](const LayerRange &range) -> LayerRange {
+                for (size_t i = range.first; i < range.second; ++ i)
+                    collect_layer_extrusions(print, layers[i].second, *layer_tools[i], edge_grid_cache, layer_extrusions[i]);
+                return range;
+            }) &
+        tbb::make_filter<LayerRange, void>(tbb::filter::serial_in_order,
+            [this, file, &print, &layers, &layer_tools, &layer_extrusions, single_object_idx](const LayerRange &range) {
+                for (size_t i = range.first; i < range.second; ++ i) {
+                    if (m_wipe_tower && layer_tools[i]->has_wipe_tower)
+                        m_wipe_tower->next_layer();
+                    this->process_layer(file, print, layers[i].second, *layer_tools[i], layer_extrusions[i], single_object_idx);
+                    layer_extrusions[i] = LayerExtrusions();
+                    print.throw_if_canceled();
+                }
+            }));
+}
+
+// Group the extrusions of a single print_z by an extruder, then by an object, an island and a region,
+// and calculate the distance fields over the layers below, used to place the seams away from the overhangs.
+// Neither depends on the state of the G-code generator, therefore the layers are prepared in parallel
+// by process_layers() ahead of their G-code being emitted by process_layer().
+void GCode::collect_layer_extrusions(
+    const Print                     &print,
+    const std::vector<LayerToPrint> &layers,
+    const LayerTools                &layer_tools,
+    EdgeGridCache                   &edge_grid_cache,
+    LayerExtrusions                 &out)
+{
+    out.lower_layer_edge_grids.resize(layers.size());
+    if (layer_tools.extruders.empty())
+        // Nothing to extrude.
+        return;
+    unsigned int first_extruder_id = layer_tools.extruders.front();
+
+    // Group extrusions by an extruder, then by an object, an island and a region.
+    std::map<unsigned int, std::vector<ObjectByExtruder>> &by_extruder = out.by_extruder;
+    for (const LayerToPrint &layer_to_print : layers) {
+        if (layer_to_print.support_layer != nullptr) {
+            const SupportLayer &support_layer = *layer_to_print.support_layer;
+            const PrintObject  &object = *support_layer.object();
+            if (! support_layer.support_fills.entities.empty()) {
+                ExtrusionRole   role               = support_layer.support_fills.role();
+                bool            has_support        = role == erMixed || role == erSupportMaterial;
+                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
+                // Extruder ID of the support base. -1 if "don't care".
+                unsigned int    support_extruder   = object.config().support_material_extruder.value - 1;
+                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            support_dontcare   = object.config().support_material_extruder.value == 0;
+                // Extruder ID of the support interface. -1 if "don't care".
+                unsigned int    interface_extruder = object.config().support_material_interface_extruder.value - 1;
+                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
+                bool            interface_dontcare = object.config().support_material_interface_extruder.value == 0;
+                if (support_dontcare || interface_dontcare) {
+                    // Some support will be printed with "don't care" material, preferably non-soluble.
+                    // Is the current extruder assigned a soluble filament?
+                    unsigned int dontcare_extruder = first_extruder_id;
+                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
+                        // The last extruder printed on the previous layer extrudes soluble filament.
+                        // Try to find a non-soluble extruder on the same layer.
+                        for (unsigned int extruder_id : layer_tools.extruders)
+                            if (! print.config().filament_soluble.get_at(extruder_id)) {
+                                dontcare_extruder = extruder_id;
+                                break;
+                            }
+                    }
+                    if (support_dontcare)
+                        support_extruder = dontcare_extruder;
+                    if (interface_dontcare)
+                        interface_extruder = dontcare_extruder;
+                }
+                // Both the support and the support interface are printed with the same extruder, therefore
+                // the interface may be interleaved with the support base.
+                bool single_extruder = ! has_support || support_extruder == interface_extruder;
+                // Assign an extruder to the base.
+                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
+                obj.support = &support_layer.support_fills;
+                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
+                if (! single_extruder && has_interface) {
+                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
+                    obj_interface.support = &support_layer.support_fills;
+                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
+                }
+            }
+        }
+        if (layer_to_print.object_layer != nullptr) {
+            const Layer &layer = *layer_to_print.object_layer;
+            // We now define a strategy for building perimeters and fills. The separation 
+            // between regions doesn't matter in terms of printing order, as we follow 
+            // another logic instead:
+            // - we group all extrusions by extruder so that we minimize toolchanges
+            // - we start from the last used extruder
+            // - for each extruder, we group extrusions by island
+            // - for each island, we extrude perimeters first, unless user set the infill_first
+            //   option
+            // (Still, we have to keep track of regions because we need to apply their config)
+            size_t n_slices = layer.slices.expolygons.size();
+            std::vector<BoundingBox> layer_surface_bboxes;
+            layer_surface_bboxes.reserve(n_slices);
+            for (const ExPolygon &expoly : layer.slices.expolygons)
+                layer_surface_bboxes.push_back(get_extents(expoly.contour));
+            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) { 
+                const BoundingBox &bbox = layer_surface_bboxes[i];
+                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
+                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
+                       layer.slices.expolygons[i].contour.contains(point);
+            };
+
+            for (size_t region_id = 0; region_id < print.regions().size(); ++ region_id) {
+                const LayerRegion *layerm = (region_id < layer.regions().size()) ? layer.regions()[region_id] : nullptr;
+                if (layerm == nullptr)
+                    continue;
+                const PrintRegion &region = *print.regions()[region_id];
+                
+                
+                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
+                // It is also necessary to save which extrusions are part of MM wiping and which are not.
+                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
+                for (std::string entity_type("infills") ; entity_type != "done" ; entity_type = entity_type=="infills" ? "perimeters" : "done") {
+
+                    const ExtrusionEntitiesPtr& source_entities = entity_type=="infills" ? layerm->fills.entities : layerm->perimeters.entities;
+
+                    for (const ExtrusionEntity *ee : source_entities) {
+                        // fill represents infill extrusions of a single island.
+                        const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                        if (fill->entities.empty()) // This shouldn't happen but first_point() would fail.
+                            continue;
+
+                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
+                        int correct_extruder_id = Print::get_extruder(*fill, region);
+                        //FIXME what is this?
+                        entity_type=="infills" ? 
+                            std::max<int>(0, (is_solid_infill(fill->entities.front()->role()) ? region.config().solid_infill_extruder : region.config().infill_extruder) - 1) :
+                            std::max<int>(region.config().perimeter_extruder.value - 1, 0);
+
+                        // Let's recover vector of extruder overrides:
+                        const ExtruderPerCopy* entity_overrides = const_cast<LayerTools&>(layer_tools).wiping_extrusions().get_extruder_overrides(fill, correct_extruder_id, (int)layer_to_print.object()->copies().size());
+
+                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
+                        for (unsigned int extruder : layer_tools.extruders)
+                        {
+                            // Init by_extruder item only if we actually use the extruder:
+                            if (std::find(entity_overrides->begin(), entity_overrides->end(), extruder) != entity_overrides->end() ||      // at least one copy is overridden to use this extruder
+                                std::find(entity_overrides->begin(), entity_overrides->end(), -extruder-1) != entity_overrides->end() ||   // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
+                                (std::find(layer_tools.extruders.begin(), layer_tools.extruders.end(), correct_extruder_id) == layer_tools.extruders.end() && extruder == layer_tools.extruders.back())) // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
+                                                                                                                                            //by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
+                            {
+                                std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
+                                    by_extruder,
+                                    extruder,
+                                    &layer_to_print - layers.data(),
+                                    layers.size(), n_slices+1);
+                                for (size_t i = 0; i <= n_slices; ++i) {
+                                    if (// fill->first_point does not fit inside any slice
+                                        i == n_slices ||
+                                        // fill->first_point fits inside ith slice
+                                        point_inside_surface(i, fill->first_point())) {
+                                        if (islands[i].by_region.empty()) {
+                                            islands[i].by_region.assign(print.regions().size(), ObjectByExtruder::Island::Region());
+                                        }
+                                        //don't do fill->entities because it will discard no_sort
+                                        islands[i].by_region[region_id].append(entity_type, fill, entity_overrides, layer_to_print.object()->copies().size());
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            } // for regions
+        }
+    } // for objects
+
+    // The distance fields are only used by extrude_loop() to find a seam position on perimeters of non-spiral vase prints.
+    if (! print.config().spiral_vase.value) {
+        for (size_t layer_id = 0; layer_id < layers.size(); ++ layer_id) {
+            const Layer *layer = layers[layer_id].object_layer;
+            if (layer == nullptr || layer->lower_layer == nullptr)
+                continue;
+            SeamPosition seam_position = layer->object()->config().seam_position.value;
+            if (seam_position != spNearest && seam_position != spAligned && seam_position != spRear && seam_position != spHidden)
+                continue;
+            for (const LayerRegion *layerm : layer->regions())
+                if (! layerm->perimeters.entities.empty()) {
+                    out.lower_layer_edge_grids[layer_id] = edge_grid_cache.get(*layer->lower_layer);
+                    break;
+                }
+        }
+    }
+}
+
 // In sequential mode, process_layer is called once per each object and its copy, 
 // therefore layers will contain a single entry and single_object_idx will point to the copy of the object.
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
@@ -1417,6 +1742,8 @@ void GCode::process_layer(
     // Set of object & print layers of the same PrintObject and with the same print_z.
     const std::vector<LayerToPrint> &layers,
     const LayerTools                &layer_tools,
+    // Extrusions of the layers grouped by collect_layer_extrusions().
+    LayerExtrusions                 &layer_extrusions,
     // If set to size_t(-1), then print all copies of all objects.
     // Otherwise print a single copy of a single object.
     const size_t                     single_object_idx)
@@ -1430,6 +1757,9 @@ void GCode::process_layer(
         // Nothing to extrude.
         return;
 
+    // Reserve the lines for the remaining time before the layer change.
+    this->_reserve_remaining_times(file);
+
     // Extract 1st object_layer and support_layer of this set of layers with an equal print_z.
     const Layer         *object_layer  = nullptr;
     const SupportLayer  *support_layer = nullptr;
@@ -1566,146 +1896,11 @@ void GCode::process_layer(
             skirt_loops_per_extruder[first_extruder_id] = std::pair<size_t, size_t>(0, print.config().skirts.value);
     }
 
-    // Group extrusions by an extruder, then by an object, an island and a region.
-    std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
-    for (const LayerToPrint &layer_to_print : layers) {
-        if (layer_to_print.support_layer != nullptr) {
-            const SupportLayer &support_layer = *layer_to_print.support_layer;
-            const PrintObject  &object = *support_layer.object();
-            if (! support_layer.support_fills.entities.empty()) {
-                ExtrusionRole   role               = support_layer.support_fills.role();
-                bool            has_support        = role == erMixed || role == erSupportMaterial;
-                bool            has_interface      = role == erMixed || role == erSupportMaterialInterface;
-                // Extruder ID of the support base. -1 if "don't care".
-                unsigned int    support_extruder   = object.config().support_material_extruder.value - 1;
-                // Shall the support be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            support_dontcare   = object.config().support_material_extruder.value == 0;
-                // Extruder ID of the support interface. -1 if "don't care".
-                unsigned int    interface_extruder = object.config().support_material_interface_extruder.value - 1;
-                // Shall the support interface be printed with the active extruder, preferably with non-soluble, to avoid tool changes?
-                bool            interface_dontcare = object.config().support_material_interface_extruder.value == 0;
-                if (support_dontcare || interface_dontcare) {
-                    // Some support will be printed with "don't care" material, preferably non-soluble.
-                    // Is the current extruder assigned a soluble filament?
-                    unsigned int dontcare_extruder = first_extruder_id;
-                    if (print.config().filament_soluble.get_at(dontcare_extruder)) {
-                        // The last extruder printed on the previous layer extrudes soluble filament.
-                        // Try to find a non-soluble extruder on the same layer.
-                        for (unsigned int extruder_id : layer_tools.extruders)
-                            if (! print.config().filament_soluble.get_at(extruder_id)) {
-                                dontcare_extruder = extruder_id;
-                                break;
-                            }
-                    }
-                    if (support_dontcare)
-                        support_extruder = dontcare_extruder;
-                    if (interface_dontcare)
-                        interface_extruder = dontcare_extruder;
-                }
-                // Both the support and the support interface are printed with the same extruder, therefore
-                // the interface may be interleaved with the support base.
-                bool single_extruder = ! has_support || support_extruder == interface_extruder;
-                // Assign an extruder to the base.
-                ObjectByExtruder &obj = object_by_extruder(by_extruder, has_support ? support_extruder : interface_extruder, &layer_to_print - layers.data(), layers.size());
-                obj.support = &support_layer.support_fills;
-                obj.support_extrusion_role = single_extruder ? erMixed : erSupportMaterial;
-                if (! single_extruder && has_interface) {
-                    ObjectByExtruder &obj_interface = object_by_extruder(by_extruder, interface_extruder, &layer_to_print - layers.data(), layers.size());
-                    obj_interface.support = &support_layer.support_fills;
-                    obj_interface.support_extrusion_role = erSupportMaterialInterface;
-                }
-            }
-        }
-        if (layer_to_print.object_layer != nullptr) {
-            const Layer &layer = *layer_to_print.object_layer;
-            // We now define a strategy for building perimeters and fills. The separation 
-            // between regions doesn't matter in terms of printing order, as we follow 
-            // another logic instead:
-            // - we group all extrusions by extruder so that we minimize toolchanges
-            // - we start from the last used extruder
-            // - for each extruder, we group extrusions by island
-            // - for each island, we extrude perimeters first, unless user set the infill_first
-            //   option
-            // (Still, we have to keep track of regions because we need to apply their config)
-            size_t n_slices = layer.slices.expolygons.size();
-            std::vector<BoundingBox> layer_surface_bboxes;
-            layer_surface_bboxes.reserve(n_slices);
-            for (const ExPolygon &expoly : layer.slices.expolygons)
-                layer_surface_bboxes.push_back(get_extents(expoly.contour));
-            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) { 
-                const BoundingBox &bbox = layer_surface_bboxes[i];
-                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
-                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
-                       layer.slices.expolygons[i].contour.contains(point);
-            };
-
-            for (size_t region_id = 0; region_id < print.regions().size(); ++ region_id) {
-                const LayerRegion *layerm = (region_id < layer.regions().size()) ? layer.regions()[region_id] : nullptr;
-                if (layerm == nullptr)
-                    continue;
-                const PrintRegion &region = *print.regions()[region_id];
-                
-                
-                // Now we must process perimeters and infills and create islands of extrusions in by_region std::map.
-                // It is also necessary to save which extrusions are part of MM wiping and which are not.
-                // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
-                for (std::string entity_type("infills") ; entity_type != "done" ; entity_type = entity_type=="infills" ? "perimeters" : "done") {
-
-                    const ExtrusionEntitiesPtr& source_entities = entity_type=="infills" ? layerm->fills.entities : layerm->perimeters.entities;
-
-                    for (const ExtrusionEntity *ee : source_entities) {
-                        // fill represents infill extrusions of a single island.
-                        const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                        if (fill->entities.empty()) // This shouldn't happen but first_point() would fail.
-                            continue;
-
-                        // This extrusion is part of certain Region, which tells us which extruder should be used for it:
-                        int correct_extruder_id = Print::get_extruder(*fill, region);
-                        //FIXME what is this?
-                        entity_type=="infills" ? 
-                            std::max<int>(0, (is_solid_infill(fill->entities.front()->role()) ? region.config().solid_infill_extruder : region.config().infill_extruder) - 1) :
-                            std::max<int>(region.config().perimeter_extruder.value - 1, 0);
-
-                        // Let's recover vector of extruder overrides:
-                        const ExtruderPerCopy* entity_overrides = const_cast<LayerTools&>(layer_tools).wiping_extrusions().get_extruder_overrides(fill, correct_extruder_id, (int)layer_to_print.object()->copies().size());
-
-                        // Now we must add this extrusion into the by_extruder map, once for each extruder that will print it:
-                        for (unsigned int extruder : layer_tools.extruders)
-                        {
-                            // Init by_extruder item only if we actually use the extruder:
-                            if (std::find(entity_overrides->begin(), entity_overrides->end(), extruder) != entity_overrides->end() ||      // at least one copy is overridden to use this extruder
-                                std::find(entity_overrides->begin(), entity_overrides->end(), -extruder-1) != entity_overrides->end() ||   // at least one copy would normally be printed with this extruder (see get_extruder_overrides function for explanation)
-                                (std::find(layer_tools.extruders.begin(), layer_tools.extruders.end(), correct_extruder_id) == layer_tools.extruders.end() && extruder == layer_tools.extruders.back())) // this entity is not overridden, but its extruder is not in layer_tools - we'll print it
-                                                                                                                                            //by last extruder on this layer (could happen e.g. when a wiping object is taller than others - dontcare extruders are eradicated from layer_tools)
-                            {
-                                std::vector<ObjectByExtruder::Island> &islands = object_islands_by_extruder(
-                                    by_extruder,
-                                    extruder,
-                                    &layer_to_print - layers.data(),
-                                    layers.size(), n_slices+1);
-                                for (size_t i = 0; i <= n_slices; ++i) {
-                                    if (// fill->first_point does not fit inside any slice
-                                        i == n_slices ||
-                                        // fill->first_point fits inside ith slice
-                                        point_inside_surface(i, fill->first_point())) {
-                                        if (islands[i].by_region.empty()) {
-                                            islands[i].by_region.assign(print.regions().size(), ObjectByExtruder::Island::Region());
-                                        }
-                                        //don't do fill->entities because it will discard no_sort
-                                        islands[i].by_region[region_id].append(entity_type, fill, entity_overrides, layer_to_print.object()->copies().size());
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            } // for regions
-        }
-    } // for objects
+    // Extrusions grouped by an extruder, then by an object, an island and a region, see collect_layer_extrusions().
+    std::map<unsigned int, std::vector<ObjectByExtruder>> &by_extruder            = layer_extrusions.by_extruder;
+    std::vector<std::shared_ptr<const EdgeGrid::Grid>>    &lower_layer_edge_grids = layer_extrusions.lower_layer_edge_grids;
 
     // Extrude the skirt, brim, support, perimeters, infill ordered by the extruders.
-    std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
     for (unsigned int extruder_id : layer_tools.extruders)
     {   
         gcode += (layer_tools.has_wipe_tower && m_wipe_tower) ?
@@ -1800,7 +1995,7 @@ void GCode::process_layer(
                 m_config.apply(print_object->config(), true);
                 m_layer = layers[layer_id].layer();
                 if (m_config.avoid_crossing_perimeters)
-                    m_avoid_crossing_perimeters.init_layer_mp(union_ex(m_layer->slices, true));
+                    m_avoid_crossing_perimeters.init_layer_mp(m_layer->slices.expolygons);
                 Points copies;
                 if (single_object_idx == size_t(-1)) 
                     copies = print_object->copies();
@@ -1866,11 +2061,8 @@ void GCode::process_layer(
 #endif /* HAS_PRESSURE_EQUALIZER */
     
     _write(file, gcode);
-    BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z << 
-        ", time estimator memory: " <<
-            format_memsize_MB(m_normal_time_estimator.memory_used() + m_silent_time_estimator_enabled ? m_silent_time_estimator.memory_used() : 0) <<
-        ", analyzer memory: " <<
-            format_memsize_MB(m_analyzer.memory_used());
+    // The memory of the time estimators and of the analyzer is reported once the output pipeline is flushed.
+    BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z;
 }
 
 void GCode::apply_print_config(const PrintConfig &print_config)
@@ -2147,13 +2339,13 @@ std::vector<float> polygon_angles_at_vertices(const Polygon &polygon, const std:
     return angles;
 }
 
-std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::string &description, double speed, std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid)
+std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::string &description, double speed, std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid)
 {
 #if DEBUG_EXTRUSION_OUTPUT
     std::cout << "extrude loop_" << (original_loop.polygon().is_counter_clockwise() ? "ccw" : "clw") << ": ";
     for (const ExtrusionPath &path : original_loop.paths) {
         std::cout << ", path{ ";
-        for (const Point &pt : path.polyline.points) {
+        for (const Point &pt : path.as_polyline().points) {
             std::cout << ", " << floor(100 * unscale<double>(pt.x())) / 100.0 << ":" << floor(100 * unscale<double>(pt.y())) / 100.0;
         }
         std::cout << "}";
@@ -2163,14 +2355,13 @@ std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::s
     // get a copy; don't modify the orientation of the original loop object otherwise
     // next copies (if any) would not detect the correct orientation
     ExtrusionLoop loop = original_loop;
+    // decode the points of a compacted loop, see Print::set_compact_toolpaths()
+    loop.uncompact();
 
     if (m_layer->lower_layer != nullptr && lower_layer_edge_grid != nullptr) {
         if (! *lower_layer_edge_grid) {
-            // Create the distance field for a layer below.
-            const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
-            *lower_layer_edge_grid = make_unique<EdgeGrid::Grid>();
-            (*lower_layer_edge_grid)->create(m_layer->lower_layer->slices, distance_field_resolution);
-            (*lower_layer_edge_grid)->calculate_sdf();
+            // Create the distance field for a layer below, if it was not prepared by collect_layer_extrusions().
+            *lower_layer_edge_grid = calculate_layer_edge_grid(*m_layer->lower_layer);
             #if 0
             {
                 static int iRun = 0;
@@ -2291,22 +2482,21 @@ std::string GCode::extrude_loop(const ExtrusionLoop &original_loop, const std::s
             // Use the edge grid distance field structure over the lower layer to calculate overhangs.
             coord_t nozzle_r = coord_t(floor(scale_(0.5 * nozzle_dmr) + 0.5));
             coord_t search_r = coord_t(floor(scale_(0.8 * nozzle_dmr) + 0.5));
-            for (size_t i = 0; i < polygon.points.size(); ++ i) {
-                const Point &p = polygon.points[i];
-                coordf_t dist;
-                // Signed distance is positive outside the object, negative inside the object.
-                // The point is considered at an overhang, if it is more than nozzle radius
-                // outside of the lower layer contour.
-                #ifdef NDEBUG // to suppress unused variable warning in release mode
-                    (*lower_layer_edge_grid)->signed_distance(p, search_r, dist);
-                #else
-                    bool found = (*lower_layer_edge_grid)->signed_distance(p, search_r, dist);
-                #endif
-                // If the approximate Signed Distance Field was initialized over lower_layer_edge_grid,
-                // then the signed distnace shall always be known.
-                assert(found); 
-                penalties[i] += extrudate_overlap_penalty(float(nozzle_r), penaltyOverhangHalf, float(dist));
-            }
+            // Signed distance is positive outside the object, negative inside the object.
+            // The point is considered at an overhang, if it is more than nozzle radius
+            // outside of the lower layer contour.
+            // All the candidate points are evaluated at once, in parallel for long loops.
+            std::vector<coordf_t> dists;
+            #ifdef NDEBUG // to suppress unused variable warning in release mode
+                (*lower_layer_edge_grid)->signed_distances(polygon.points, search_r, dists);
+            #else
+                bool found = (*lower_layer_edge_grid)->signed_distances(polygon.points, search_r, dists);
+            #endif
+            // If the approximate Signed Distance Field was initialized over lower_layer_edge_grid,
+            // then the signed distnace shall always be known.
+            assert(found); 
+            for (size_t i = 0; i < polygon.points.size(); ++ i)
+                penalties[i] += extrudate_overlap_penalty(float(nozzle_r), penaltyOverhangHalf, float(dists[i]));
         }
 
         // Find a point with a minimum penalty.
@@ -2453,7 +2643,7 @@ std::string GCode::extrude_multi_path(const ExtrusionMultiPath &multipath, const
         gcode += this->_extrude(path, description, speed);
     }
     if (m_wipe.enable) {
-        m_wipe.path = std::move(multipath.paths.back().polyline);  // TODO: don't limit wipe to last path
+        m_wipe.path = multipath.paths.back().as_polyline();  // TODO: don't limit wipe to last path
         m_wipe.path.reverse();
     }
     // reset acceleration
@@ -2462,6 +2652,12 @@ std::string GCode::extrude_multi_path(const ExtrusionMultiPath &multipath, const
 }
 
 std::string GCode::extrude_multi_path3D(const ExtrusionMultiPath3D &multipath3D, const std::string &description, double speed) {
+    if (multipath3D.compacted()) {
+        // decode the points of a copy of the compacted paths, see Print::set_compact_toolpaths()
+        ExtrusionMultiPath3D decoded = multipath3D;
+        decoded.uncompact();
+        return this->extrude_multi_path3D(decoded, description, speed);
+    }
     // extrude along the path
     std::string gcode;
     for (const ExtrusionPath3D &path : multipath3D.paths) {
@@ -2496,7 +2692,7 @@ std::string GCode::extrude_multi_path3D(const ExtrusionMultiPath3D &multipath3D,
     return gcode;
 }
 
-std::string GCode::extrude_entity(const ExtrusionEntity &entity, const std::string &description, double speed, std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid)
+std::string GCode::extrude_entity(const ExtrusionEntity &entity, const std::string &description, double speed, std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid)
 {
     this->visitor_gcode.clear();
     this->visitor_comment = description;
@@ -2507,17 +2703,21 @@ std::string GCode::extrude_entity(const ExtrusionEntity &entity, const std::stri
 }
 
 void GCode::use(const ExtrusionEntityCollection &collection) {
-    ExtrusionEntityCollection chained;
-    if (collection.no_sort) chained = collection;
-    else chained = collection.chained_path_from(m_last_pos, false);
-    for (const ExtrusionEntity *next_entity : chained.entities) {
-        next_entity->visit(*this);
+    if (collection.no_sort) {
+        for (const ExtrusionEntity *next_entity : collection.entities)
+            next_entity->visit(*this);
+    } else {
+        // Chain the entities without cloning them, only the reversed entities are copied.
+        for (const ExtrusionEntityCollection::ChainedEntity &chained : collection.chained_order_from(m_last_pos, false))
+            (chained.reversed ? *chained.reversed : *collection.entities[chained.idx]).visit(*this);
     }
 }
 
 std::string GCode::extrude_path(const ExtrusionPath &path, const std::string &description, double speed) {
     //    description += ExtrusionRole2String(path.role());
     ExtrusionPath simplifed_path = path;
+    // decode the points of a compacted path, see Print::set_compact_toolpaths()
+    simplifed_path.uncompact();
     simplifed_path.simplify(SCALED_RESOLUTION);
     std::string gcode = this->_extrude(simplifed_path, description, speed);
 
@@ -2531,6 +2731,12 @@ std::string GCode::extrude_path(const ExtrusionPath &path, const std::string &de
 }
 
 std::string GCode::extrude_path_3D(const ExtrusionPath3D &path, const std::string &description, double speed) {
+    if (path.compacted()) {
+        // decode the points of a copy of the compacted path, see Print::set_compact_toolpaths()
+        ExtrusionPath3D decoded = path;
+        decoded.uncompact();
+        return this->extrude_path_3D(decoded, description, speed);
+    }
     //    description += ExtrusionRole2String(path.role());
     //path.simplify(SCALED_RESOLUTION);
     std::string gcode = this->_before_extrude(path, description, speed);
@@ -2564,7 +2770,7 @@ std::string GCode::extrude_path_3D(const ExtrusionPath3D &path, const std::strin
 }
 
 // Extrude perimeters: Decide where to put seams (hide or align seams).
-std::string GCode::extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::unique_ptr<EdgeGrid::Grid> &lower_layer_edge_grid)
+std::string GCode::extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::shared_ptr<const EdgeGrid::Grid> &lower_layer_edge_grid)
 {
     std::string gcode;
     for (const ObjectByExtruder::Island::Region &region : by_region) {
@@ -2628,7 +2834,9 @@ void GCode::_post_process(std::string& what) {
 
 void GCode::_write(FILE* file, const char *what)
 {
-    if (what != nullptr) {
+    if (what != nullptr && m_output_pipeline) {
+        m_output_pipeline->push(std::string(what));
+    } else if (what != nullptr) {
         
         //const char * gcode_pp = _post_process(what).c_str();
         std::string str_preproc{ what };
@@ -2648,6 +2856,53 @@ void GCode::_write(FILE* file, const char *what)
     }
 }
 
+void GCode::_write_unprocessed(FILE* file, std::string &&what)
+{
+    if (m_output_pipeline)
+        m_output_pipeline->push_unfiltered(std::move(what));
+    else
+        fwrite(what.data(), 1, what.size(), file);
+}
+
+void GCode::_reserve_remaining_times(FILE* file)
+{
+    if (m_remaining_times_placeholder.empty())
+        return;
+    if (m_output_pipeline) {
+        m_output_pipeline->push_reserved(std::string(m_remaining_times_placeholder));
+    } else {
+        m_remaining_times_offsets.emplace_back(ftell_64(file));
+        fwrite(m_remaining_times_placeholder.data(), 1, m_remaining_times_placeholder.size(), file);
+        m_normal_time_estimator.add_remaining_times_placeholder();
+        if (m_silent_time_estimator_enabled)
+            m_silent_time_estimator.add_remaining_times_placeholder();
+    }
+}
+
+void GCode::_write_remaining_times(FILE* file)
+{
+    if (m_remaining_times_placeholder.empty())
+        return;
+    std::vector<std::string> normal_lines = m_normal_time_estimator.get_remaining_times_lines();
+    std::vector<std::string> silent_lines;
+    if (m_silent_time_estimator_enabled)
+        silent_lines = m_silent_time_estimator.get_remaining_times_lines();
+    if (normal_lines.size() != m_remaining_times_offsets.size() || (m_silent_time_estimator_enabled && silent_lines.size() != m_remaining_times_offsets.size()))
+        // Don't ship the zeroed placeholders, the printer would report 0% and 0 minutes for the whole print.
+        throw std::runtime_error(std::string("Remaining times export failed.\n") + std::to_string(m_remaining_times_offsets.size()) + 
+            " M73 lines reserved, " + std::to_string(normal_lines.size()) + " M73 lines processed by the time estimator.\n");
+    for (size_t i = 0; i < m_remaining_times_offsets.size(); ++ i) {
+        std::string lines = normal_lines[i] + "\n";
+        if (m_silent_time_estimator_enabled)
+            lines += silent_lines[i] + "\n";
+        assert(lines.size() == m_remaining_times_placeholder.size());
+        if (fseek_64(file, m_remaining_times_offsets[i], SEEK_SET) != 0 || fwrite(lines.data(), 1, lines.size(), file) != lines.size())
+            throw std::runtime_error(std::string("Remaining times export failed.\nCannot write into the G-code file.\n"));
+    }
+    fseek_64(file, 0, SEEK_END);
+    m_remaining_times_offsets.clear();
+}
+
 void GCode::_writeln(FILE* file, const std::string &what)
 {
     if (! what.empty())
@@ -2687,6 +2942,8 @@ void GCode::_write_format(FILE* file, const char* format, ...)
 }
 
 std::string GCode::_extrude(const ExtrusionPath &path, const std::string &description, double speed) {
+    // The callers extrude a decoded copy of a compacted path.
+    assert(! path.compacted());
 
     std::string gcode = this->_before_extrude(path, description, speed);
 
@@ -3147,11 +3404,10 @@ void GCode::ObjectByExtruder::Island::Region::append(const std::string& type, co
 
     // First we append the entities, there are eec->entities.size() of them:
     //don't do fill->entities because it will discard no_sort, we must use flatten(preserve_ordering = true)
-    ExtrusionEntitiesPtr entities = eec->flatten(true).entities;
-    perimeters_or_infills->append(entities);
-
-    for (unsigned int i = 0; i<entities.size(); ++i)
-        perimeters_or_infills_overrides->push_back(copies_extruder);
+    // The flattened entities are moved, not cloned once more.
+    ExtrusionEntityCollection flattened = eec->flatten(true);
+    perimeters_or_infills_overrides->insert(perimeters_or_infills_overrides->end(), flattened.entities.size(), copies_extruder);
+    perimeters_or_infills->append(std::move(flattened.entities));
 }
 
 }   // namespace Slic3r
@@ -17,6 +17,7 @@
 #include "GCodeTimeEstimator.hpp"
 #include "EdgeGrid.hpp"
 #include "GCode/Analyzer.hpp"
+#include "GCode/OutputPipeline.hpp"
 
 #include <memory>
 #include <string>
@@ -46,14 +47,25 @@ public:
     ~AvoidCrossingPerimeters() {}
 
     void init_external_mp(const ExPolygons &islands) { m_external_mp = Slic3r::make_unique<MotionPlanner>(islands); }
-    void init_layer_mp(const ExPolygons &islands) { m_layer_mp = Slic3r::make_unique<MotionPlanner>(islands); }
+    // Initialize the motion planner of a layer with the slices of the layer.
+    // The motion planners of the recently processed layers are reused for identical slices,
+    // together with their lazily built visibility graphs.
+    void init_layer_mp(const ExPolygons &slices);
 
     Polyline travel_to(const GCode &gcodegen, const Point &point);
 
-    bool is_init() { return (use_external_mp || use_external_mp_once) ? m_external_mp.get() != nullptr : m_layer_mp.get() != nullptr; }
+    bool is_init() { return (use_external_mp || use_external_mp_once) ? m_external_mp.get() != nullptr : m_layer_mp != nullptr; }
 private:
-    std::unique_ptr<MotionPlanner> m_external_mp;
-    std::unique_ptr<MotionPlanner> m_layer_mp;
+    struct LayerMotionPlanner {
+        ExPolygons                      slices;
+        std::unique_ptr<MotionPlanner>  mp;
+    };
+
+    std::unique_ptr<MotionPlanner>  m_external_mp;
+    // Points into m_layer_mp_cache.
+    MotionPlanner                  *m_layer_mp = nullptr;
+    // Motion planners of the recently processed layers, the most recently used first.
+    std::vector<LayerMotionPlanner> m_layer_mp_cache;
 };
 
 class OozePrevention {
@@ -202,6 +214,19 @@ protected:
     };
     static std::vector<GCode::LayerToPrint>                            collect_layers_to_print(const PrintObject &object);
     static std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>> collect_layers_to_print(const Print &print);
+    struct LayerExtrusions;
+    // Generate G-code for a sequence of print_z heights. The extrusions of the layers are grouped by collect_layer_extrusions()
+    // in parallel ahead of the serial G-code emission by process_layer().
+    void            process_layers(
+        // Write into the output file.
+        FILE                                                               *file,
+        const Print                                                        &print,
+        const ToolOrdering                                                 &tool_ordering,
+        // Sets of object & print layers of the same print_z, sorted by print_z.
+        const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>  &layers,
+        // If set to size_t(-1), then print all copies of all objects.
+        // Otherwise print a single copy of a single object.
+        const size_t                                                        single_object_idx);
     void            process_layer(
         // Write into the output file.
         FILE                            *file,
@@ -209,6 +234,8 @@ protected:
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
         const LayerTools  &layer_tools,
+        // Extrusions of the layers grouped by collect_layer_extrusions().
+        LayerExtrusions                 &layer_extrusions,
         // If set to size_t(-1), then print all copies of all objects.
         // Otherwise print a single copy of a single object.
         const size_t                     single_object_idx = size_t(-1));
@@ -221,15 +248,15 @@ protected:
     std::string     visitor_gcode;
     std::string     visitor_comment;
     double          visitor_speed;
-    std::unique_ptr<EdgeGrid::Grid> *visitor_lower_layer_edge_grid;
+    std::shared_ptr<const EdgeGrid::Grid> *visitor_lower_layer_edge_grid;
     virtual void use(const ExtrusionPath &path) override { visitor_gcode += extrude_path(path, visitor_comment, visitor_speed); };
     virtual void use(const ExtrusionPath3D &path3D) override { visitor_gcode += extrude_path_3D(path3D, visitor_comment, visitor_speed); };
     virtual void use(const ExtrusionMultiPath &multipath) override { visitor_gcode += extrude_multi_path(multipath, visitor_comment, visitor_speed); };
     virtual void use(const ExtrusionMultiPath3D &multipath) override { visitor_gcode += extrude_multi_path3D(multipath, visitor_comment, visitor_speed); };
     virtual void use(const ExtrusionLoop &loop) override { visitor_gcode += extrude_loop(loop, visitor_comment, visitor_speed, visitor_lower_layer_edge_grid); };
     virtual void use(const ExtrusionEntityCollection &collection) override;
-    std::string     extrude_entity(const ExtrusionEntity &entity, const std::string &description, double speed = -1., std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
-    std::string     extrude_loop(const ExtrusionLoop &loop, const std::string &description, double speed = -1., std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
+    std::string     extrude_entity(const ExtrusionEntity &entity, const std::string &description, double speed = -1., std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
+    std::string     extrude_loop(const ExtrusionLoop &loop, const std::string &description, double speed = -1., std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
     std::string     extrude_multi_path(const ExtrusionMultiPath &multipath, const std::string &description, double speed = -1.);
     std::string     extrude_multi_path3D(const ExtrusionMultiPath3D &multipath, const std::string &description, double speed = -1.);
     std::string     extrude_path(const ExtrusionPath &path, const std::string &description, double speed = -1.);
@@ -268,8 +295,19 @@ protected:
         std::vector<Island>         islands;
     };
 
+    // Extrusions of a single print_z grouped by an extruder, then by an object, an island and a region.
+    struct LayerExtrusions
+    {
+        std::map<unsigned int, std::vector<ObjectByExtruder>> by_extruder;
+        // Distance fields over the layers below the object layers, one per LayerToPrint, null if not calculated yet.
+        // Layers printed over identical slices share the distance field.
+        std::vector<std::shared_ptr<const EdgeGrid::Grid>> lower_layer_edge_grids;
+    };
+    // Distance fields over the slices of the recently prepared layers, see collect_layer_extrusions().
+    class EdgeGridCache;
+    static void     collect_layer_extrusions(const Print &print, const std::vector<LayerToPrint> &layers, const LayerTools &layer_tools, EdgeGridCache &edge_grid_cache, LayerExtrusions &out);
 
-    std::string     extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::unique_ptr<EdgeGrid::Grid> &lower_layer_edge_grid);
+    std::string     extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::shared_ptr<const EdgeGrid::Grid> &lower_layer_edge_grid);
     std::string     extrude_infill(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, bool is_infill_first);
 	std::string     extrude_support(const ExtrusionEntityCollection &support_fills);
 
@@ -350,13 +388,26 @@ protected:
     GCodeTimeEstimator m_normal_time_estimator;
     GCodeTimeEstimator m_silent_time_estimator;
     bool m_silent_time_estimator_enabled;
+    // M73 lines reserved for the remaining times at the layer changes, empty if the remaining times are not exported.
+    std::string m_remaining_times_placeholder;
+    // File offsets of the reserved M73 lines, recorded by the output file writer.
+    std::vector<int64_t> m_remaining_times_offsets;
 
     // Analyzer
     GCodeAnalyzer m_analyzer;
 
+    // Runs the analyzer, the time estimators and the file writer on their own threads while exporting G-code.
+    std::unique_ptr<GCodeOutputPipeline> m_output_pipeline;
+
     // Write a string into a file.
     void _write(FILE* file, const std::string& what) { this->_write(file, what.c_str()); }
     void _write(FILE* file, const char *what);
+    // Write a string into a file, bypassing the analyzer and the time estimators.
+    void _write_unprocessed(FILE* file, std::string &&what);
+    // Reserve M73 lines for the remaining times, to be filled in by _write_remaining_times().
+    void _reserve_remaining_times(FILE* file);
+    // Overwrite the reserved M73 lines with the remaining times once the print time is known.
+    void _write_remaining_times(FILE* file);
     
 
     // Write a string into a file. 
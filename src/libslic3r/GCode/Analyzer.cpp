@@ -286,7 +286,8 @@ void GCodeAnalyzer::_process_gcode_line(GCodeReader&, const GCodeReader::GCodeLi
     }
 
     // puts the line back into the gcode
-    m_process_output += line.raw() + "\n";
+    m_process_output += line.raw();
+    m_process_output += '\n';
 }
 
 // Returns the new absolute position on the given axis in dependence of the given parameters
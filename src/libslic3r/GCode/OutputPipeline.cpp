@@ -0,0 +1,139 @@
+#include "OutputPipeline.hpp"
+
+#include <cassert>
+
+namespace Slic3r {
+
+GCodeOutputPipeline::GCodeOutputPipeline(Filter filter, std::vector<Consumer> consumers, size_t capacity) :
+    m_filter(std::move(filter)), m_consumers(std::move(consumers)), m_num_consumed(m_consumers.size(), 0), m_canceled(false)
+{
+    assert(! m_consumers.empty());
+    m_input.set_capacity(capacity);
+    m_outputs.reserve(m_consumers.size());
+    for (size_t i = 0; i < m_consumers.size(); ++ i) {
+        m_outputs.emplace_back(new Queue());
+        m_outputs.back()->set_capacity(capacity);
+    }
+    m_threads.reserve(m_consumers.size() + 1);
+    m_threads.emplace_back([this]() { this->run_filter(); });
+    for (size_t i = 0; i < m_consumers.size(); ++ i)
+        m_threads.emplace_back([this, i]() { this->run_consumer(i); });
+}
+
+GCodeOutputPipeline::~GCodeOutputPipeline()
+{
+    if (! m_stopped) {
+        // Destroyed without finish(), most likely the G-code export was canceled. Don't process the remaining blocks.
+        m_canceled = true;
+        this->stop();
+    }
+}
+
+void GCodeOutputPipeline::push_block(std::string &&gcode, bool unfiltered, bool reserved)
+{
+    assert(! m_stopped);
+    if (m_canceled)
+        this->rethrow();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++ m_num_pushed;
+    }
+    m_input.push(std::make_shared<const Block>(std::move(gcode), unfiltered, reserved));
+}
+
+void GCodeOutputPipeline::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() {
+            for (size_t num_consumed : m_num_consumed)
+                if (num_consumed < m_num_pushed)
+                    return false;
+            return true;
+        });
+    }
+    this->rethrow();
+}
+
+void GCodeOutputPipeline::finish()
+{
+    if (! m_stopped)
+        this->stop();
+    this->rethrow();
+}
+
+void GCodeOutputPipeline::stop()
+{
+    // The null block is passed by the filter to the consumers, terminating all the threads.
+    m_input.push(BlockPtr());
+    for (std::thread &thread : m_threads)
+        thread.join();
+    m_threads.clear();
+    m_stopped = true;
+}
+
+void GCodeOutputPipeline::run_filter()
+{
+    for (;;) {
+        BlockPtr block;
+        m_input.pop(block);
+        if (block && m_filter && ! block->unfiltered && ! block->reserved && ! m_canceled) {
+            try {
+                block = std::make_shared<const Block>(m_filter(block->gcode), false, false);
+            } catch (...) {
+                this->set_exception();
+            }
+        }
+        // Even the canceled blocks are passed to the consumers to keep their counters in sync with m_num_pushed.
+        for (std::unique_ptr<Queue> &output : m_outputs)
+            output->push(block);
+        if (! block)
+            break;
+    }
+}
+
+void GCodeOutputPipeline::run_consumer(size_t idx)
+{
+    Queue &input = *m_outputs[idx];
+    for (;;) {
+        BlockPtr block;
+        input.pop(block);
+        if (! block)
+            break;
+        if ((idx == 0 || ! block->unfiltered) && ! m_canceled) {
+            try {
+                m_consumers[idx](block->gcode, block->reserved);
+            } catch (...) {
+                this->set_exception();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++ m_num_consumed[idx];
+        }
+        m_condition.notify_all();
+    }
+}
+
+void GCodeOutputPipeline::set_exception()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (! m_exception)
+            m_exception = std::current_exception();
+    }
+    m_canceled = true;
+}
+
+void GCodeOutputPipeline::rethrow()
+{
+    std::exception_ptr ex;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ex = m_exception;
+    }
+    if (ex)
+        std::rethrow_exception(ex);
+}
+
+} // namespace Slic3r
@@ -0,0 +1,91 @@
+#ifndef slic3r_GCode_OutputPipeline_hpp_
+#define slic3r_GCode_OutputPipeline_hpp_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tbb/concurrent_queue.h>
+
+namespace Slic3r {
+
+// Pipeline consuming the blocks of G-code produced by GCode::process_layer() and friends.
+// The blocks are first passed through an optional filter (the G-code analyzer), then to a set of consumers
+// (the file writer, the time estimators). The filter and each consumer run on their own thread, they receive
+// the blocks in the order the blocks were pushed, therefore each stage sees the same sequence of G-code
+// as if the stages were executed serially. The queues between the stages are bounded to limit the memory use.
+class GCodeOutputPipeline
+{
+public:
+    typedef std::function<std::string(const std::string &gcode)>   Filter;
+    // reserved is set for the blocks pushed with push_reserved().
+    typedef std::function<void(const std::string &gcode, bool reserved)> Consumer;
+
+    // The first consumer is the primary output (the file writer), it is the only consumer receiving the unfiltered blocks.
+    // The filter may be empty, then the blocks are passed to the consumers as they are.
+    GCodeOutputPipeline(Filter filter, std::vector<Consumer> consumers, size_t capacity = 64);
+    // Stops the threads. If finish() was not called, the blocks not processed yet are dropped.
+    ~GCodeOutputPipeline();
+
+    // Pass a block of G-code to the filter and to all the consumers. Blocks if the pipeline is full.
+    // Rethrows an exception thrown by the filter or by a consumer.
+    void push(std::string &&gcode) { this->push_block(std::move(gcode), false, false); }
+    // Pass a block of G-code to the primary output only, bypassing the filter and the other consumers.
+    void push_unfiltered(std::string &&gcode) { this->push_block(std::move(gcode), true, false); }
+    // Pass a block of G-code reserved to be overwritten at the end of the export to all the consumers,
+    // bypassing the filter. The consumers receive the block with the reserved flag set.
+    void push_reserved(std::string &&gcode) { this->push_block(std::move(gcode), false, true); }
+    // Wait until all the blocks pushed so far were processed by all the consumers.
+    // Rethrows an exception thrown by the filter or by a consumer.
+    void flush();
+    // Process all the blocks pushed so far and stop the threads.
+    // Rethrows an exception thrown by the filter or by a consumer.
+    void finish();
+
+private:
+    struct Block {
+        Block(std::string &&gcode, bool unfiltered, bool reserved) : gcode(std::move(gcode)), unfiltered(unfiltered), reserved(reserved) {}
+        std::string gcode;
+        bool        unfiltered;
+        bool        reserved;
+    };
+    // Null block terminates the stage.
+    typedef std::shared_ptr<const Block>                BlockPtr;
+    typedef tbb::concurrent_bounded_queue<BlockPtr>     Queue;
+
+    void push_block(std::string &&gcode, bool unfiltered, bool reserved);
+    void run_filter();
+    void run_consumer(size_t idx);
+    void stop();
+    void set_exception();
+    // Throw the exception stored by set_exception(), if any.
+    void rethrow();
+
+    Filter                                  m_filter;
+    std::vector<Consumer>                   m_consumers;
+    Queue                                   m_input;
+    std::vector<std::unique_ptr<Queue>>     m_outputs;
+    std::vector<std::thread>                m_threads;
+
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_condition;
+    // Number of blocks pushed into the pipeline, only modified by the producer thread.
+    size_t                                  m_num_pushed = 0;
+    // Number of blocks processed by each consumer, guarded by m_mutex.
+    std::vector<size_t>                     m_num_consumed;
+    // The first exception thrown by a stage, guarded by m_mutex.
+    std::exception_ptr                      m_exception;
+    // Set on failure or when the pipeline is destroyed without finish(), the stages then skip the remaining blocks.
+    std::atomic<bool>                       m_canceled;
+    bool                                    m_stopped = false;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_GCode_OutputPipeline_hpp_ */
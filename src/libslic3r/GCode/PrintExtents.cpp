@@ -27,9 +27,15 @@ static inline BoundingBox extrusion_polyline_extents(const Polyline &polyline, c
     return bbox;
 }
 
+static inline BoundingBox extrusion_path_extents(const ExtrusionPath &extrusion_path)
+{
+    Polyline decoded;
+    return extrusion_polyline_extents(extrusion_path.decoded_polyline(decoded), scale_(0.5 * extrusion_path.width));
+}
+
 static inline BoundingBoxf extrusionentity_extents(const ExtrusionPath &extrusion_path)
 {
-    BoundingBox bbox = extrusion_polyline_extents(extrusion_path.polyline, scale_(0.5 * extrusion_path.width));
+    BoundingBox bbox = extrusion_path_extents(extrusion_path);
     BoundingBoxf bboxf;
     if (! empty(bbox)) {
         bboxf.min = unscale(bbox.min);
@@ -43,7 +49,7 @@ static inline BoundingBoxf extrusionentity_extents(const ExtrusionLoop &extrusio
 {
     BoundingBox bbox;
     for (const ExtrusionPath &extrusion_path : extrusion_loop.paths)
-        bbox.merge(extrusion_polyline_extents(extrusion_path.polyline, scale_(0.5 * extrusion_path.width)));
+        bbox.merge(extrusion_path_extents(extrusion_path));
     BoundingBoxf bboxf;
     if (! empty(bbox)) {
         bboxf.min = unscale(bbox.min);
@@ -57,7 +63,7 @@ static inline BoundingBoxf extrusionentity_extents(const ExtrusionMultiPath &ext
 {
     BoundingBox bbox;
     for (const ExtrusionPath &extrusion_path : extrusion_multi_path.paths)
-        bbox.merge(extrusion_polyline_extents(extrusion_path.polyline, scale_(0.5 * extrusion_path.width)));
+        bbox.merge(extrusion_path_extents(extrusion_path));
     BoundingBoxf bboxf;
     if (! empty(bbox)) {
         bboxf.min = unscale(bbox.min);
@@ -1,6 +1,7 @@
 #include "GCodeReader.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/nowide/cstdio.hpp>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -21,6 +22,37 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_extrusion_axis = m_config.get_extrusion_axis()[0];
 }
 
+// Parse a decimal number of the most common form [+-]digits[.digits], as written by the G-code generator.
+// If the number does not end with an end of a word, if it has an exponent or if it has too many digits
+// to be converted exactly, the number is parsed by strtod(). Returns the end of the number or nullptr.
+static inline const char* parse_axis_value(const char *c, double &value)
+{
+    static const double pow10[] = { 1., 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    const char *p        = c;
+    bool        negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        ++ p;
+    uint64_t    mantissa = 0;
+    int         digits   = 0;
+    int         decimals = 0;
+    for (; *p >= '0' && *p <= '9'; ++ p, ++ digits)
+        mantissa = mantissa * 10 + uint64_t(*p - '0');
+    if (*p == '.')
+        for (++ p; *p >= '0' && *p <= '9'; ++ p, ++ digits, ++ decimals)
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+    if (digits > 0 && digits <= 15 && (*p == ' ' || *p == '\t' || *p == ';' || *p == '\r' || *p == '\n' || *p == 0)) {
+        // Both the mantissa and the power of ten are exact in double precision, therefore the single division
+        // is correctly rounded and the result is the same as the one of strtod().
+        value = double(mantissa) / pow10[decimals];
+        if (negative)
+            value = - value;
+        return p;
+    }
+    char *pend = nullptr;
+    value = strtod(c, &pend);
+    return pend;
+}
+
 const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
     PROFILE_FUNC();
@@ -53,8 +85,8 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
             }
             if (axis != NUM_AXES) {
                 // Try to parse the numeric value.
-                char   *pend = nullptr;
-                double  v = strtod(++ c, &pend);
+                double      v;
+                const char *pend = parse_axis_value(++ c, v);
                 if (pend != nullptr && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     gline.m_axis[int(axis)] = float(v);
@@ -72,8 +104,8 @@ const char* GCodeReader::parse_line_internal(const char *ptr, GCodeLine &gline,
     if (gline.has(E) && m_config.use_relative_e_distances)
         m_position[E] = 0;
 
-    // Skip the rest of the line.
-    for (; ! is_end_of_line(*c); ++ c);
+    // Skip the rest of the line, strcspn() is vectorized by the C runtime.
+    c += strcspn(c, "\r\n");
 
     // Copy the raw string including the comment, without the trailing newlines.
     if (c > ptr) {
@@ -109,10 +141,46 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 
 void GCodeReader::parse_file(const std::string &file, callback_t callback)
 {
-    std::ifstream f(file);
-    std::string line;
-    while (std::getline(f, line))
-        this->parse_line(line, callback);
+    FILE *f = boost::nowide::fopen(file.c_str(), "rb");
+    if (f == nullptr)
+        return;
+    // The file is read in large blocks, the complete lines of a block are parsed in place.
+    // The incomplete last line of a block is moved to the start of the buffer to be completed by the next block.
+    std::vector<char> buffer(4 * 1024 * 1024);
+    size_t            len = 0;
+    GCodeLine         gline;
+    for (;;) {
+        if (len + 1 == buffer.size())
+            // A single line does not fit into the buffer.
+            buffer.resize(buffer.size() * 2);
+        // Keep one character for the terminating zero.
+        size_t num_read = fread(buffer.data() + len, 1, buffer.size() - len - 1, f);
+        len += num_read;
+        bool   eof      = num_read == 0;
+        char  *begin    = buffer.data();
+        char  *end      = begin + len;
+        // Parse up to the last line break, or up to the end of the file.
+        char  *last     = end;
+        if (! eof) {
+            for (; last > begin && last[-1] != '\n'; -- last) ;
+            if (last == begin)
+                continue;
+        }
+        char saved = *last;
+        *last = 0;
+        for (const char *ptr = begin; ptr < last;) {
+            gline.reset();
+            const char *next = this->parse_line(ptr, gline, callback);
+            // Skip a zero character inside the file, the parser stops at it.
+            ptr = (next == ptr || *next == 0) ? next + 1 : next;
+        }
+        *last = saved;
+        len = size_t(end - last);
+        memmove(begin, last, len);
+        if (eof)
+            break;
+    }
+    fclose(f);
 }
 
 bool GCodeReader::GCodeLine::has(char axis) const
@@ -153,8 +221,8 @@ bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
         // Check the name of the axis.
         if (*c == axis) {
             // Try to parse the numeric value.
-            char   *pend = nullptr;
-            double  v = strtod(++ c, &pend);
+            double      v;
+            const char *pend = parse_axis_value(++ c, v);
             if (pend != nullptr && is_end_of_word(*pend)) {
                 // The axis value has been parsed correctly.
                 value = float(v);
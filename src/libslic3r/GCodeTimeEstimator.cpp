@@ -25,7 +25,6 @@ static const float DEFAULT_EXTRUDE_FACTOR_OVERRIDE_PERCENTAGE = 1.0f; // 100 per
 
 static const float PREVIOUS_FEEDRATE_THRESHOLD = 0.0001f;
 
-#if ENABLE_MOVE_STATS
 static const std::string MOVE_TYPE_STR[Slic3r::GCodeTimeEstimator::Block::Num_Types] =
 {
     "Noop",
@@ -35,7 +34,6 @@ static const std::string MOVE_TYPE_STR[Slic3r::GCodeTimeEstimator::Block::Num_Ty
     "Move",
     "Extrude"
 };
-#endif // ENABLE_MOVE_STATS
 
 namespace Slic3r {
     void GCodeTimeEstimator::Feedrates::reset()
@@ -46,38 +44,6 @@ namespace Slic3r {
         ::memset(abs_axis_feedrate, 0, Num_Axis * sizeof(float));
     }
 
-    float GCodeTimeEstimator::Block::Trapezoid::acceleration_time(float acceleration) const
-    {
-        return acceleration_time_from_distance(feedrate.entry, accelerate_until, acceleration);
-    }
-
-    float GCodeTimeEstimator::Block::Trapezoid::cruise_time() const
-    {
-        return (feedrate.cruise != 0.0f) ? cruise_distance() / feedrate.cruise : 0.0f;
-    }
-
-    float GCodeTimeEstimator::Block::Trapezoid::deceleration_time(float acceleration) const
-    {
-        return acceleration_time_from_distance(feedrate.cruise, (distance - decelerate_after), -acceleration);
-    }
-
-    float GCodeTimeEstimator::Block::Trapezoid::cruise_distance() const
-    {
-        return decelerate_after - accelerate_until;
-    }
-
-    float GCodeTimeEstimator::Block::Trapezoid::acceleration_time_from_distance(float initial_feedrate, float distance, float acceleration)
-    {
-        return (acceleration != 0.0f) ? (speed_from_distance(initial_feedrate, distance, acceleration) - initial_feedrate) / acceleration : 0.0f;
-    }
-
-    float GCodeTimeEstimator::Block::Trapezoid::speed_from_distance(float initial_feedrate, float distance, float acceleration)
-    {
-        // to avoid invalid negative numbers due to numerical imprecision 
-        float value = std::max(0.0f, sqr(initial_feedrate) + 2.0f * acceleration * distance);
-        return ::sqrt(value);
-    }
-
     GCodeTimeEstimator::Block::Block()
     {
     }
@@ -98,49 +64,51 @@ namespace Slic3r {
         return delta_pos[E] == 0.0f;
     }
 
-    float GCodeTimeEstimator::Block::acceleration_time() const
-    {
-        return trapezoid.acceleration_time(acceleration);
-    }
-
-    float GCodeTimeEstimator::Block::cruise_time() const
-    {
-        return trapezoid.cruise_time();
-    }
-
-    float GCodeTimeEstimator::Block::deceleration_time() const
+    void GCodeTimeEstimator::Block::trapezoid_times(size_t num_blocks, const float *distance, const float *acceleration,
+        const float *entry_feedrate, const float *cruise_feedrate, const float *exit_feedrate, float *time)
     {
-        return trapezoid.deceleration_time(acceleration);
-    }
-
-    float GCodeTimeEstimator::Block::cruise_distance() const
-    {
-        return trapezoid.cruise_distance();
-    }
-
-    void GCodeTimeEstimator::Block::calculate_trapezoid()
-    {
-        float distance = move_length();
-
-        trapezoid.distance = distance;
-        trapezoid.feedrate = feedrate;
-
-        float accelerate_distance = std::max(0.0f, estimate_acceleration_distance(feedrate.entry, feedrate.cruise, acceleration));
-        float decelerate_distance = std::max(0.0f, estimate_acceleration_distance(feedrate.cruise, feedrate.exit, -acceleration));
-        float cruise_distance = distance - accelerate_distance - decelerate_distance;
-
-        // Not enough space to reach the nominal feedrate.
-        // This means no cruising, and we'll have to use intersection_distance() to calculate when to abort acceleration 
-        // and start braking in order to reach the exit_feedrate exactly at the end of this block.
-        if (cruise_distance < 0.0f)
+        // The formulas of estimate_acceleration_distance(), intersection_distance() and acceleration_time_from_distance() inlined.
+        // All the divisions are evaluated with safe denominators and their results are selected afterwards, as a guarded division
+        // is a branch the vectorizer gives up on. The operations are kept in the order of the block by block calculation.
+        for (size_t i = 0; i < num_blocks; ++ i)
         {
-            accelerate_distance = clamp(0.0f, distance, intersection_distance(feedrate.entry, feedrate.exit, acceleration, distance));
-            cruise_distance = 0.0f;
-            trapezoid.feedrate.cruise = Trapezoid::speed_from_distance(feedrate.entry, accelerate_distance, acceleration);
+            float d = distance[i];
+            float a = acceleration[i];
+            float entry = entry_feedrate[i];
+            float cruise = cruise_feedrate[i];
+            float exit = exit_feedrate[i];
+
+            bool has_acceleration = a != 0.0f;
+            float a_safe = has_acceleration ? a : 1.0f;
+            float accelerate_distance = (sqr(cruise) - sqr(entry)) / (2.0f * a_safe);
+            float decelerate_distance = (sqr(exit) - sqr(cruise)) / (2.0f * -a_safe);
+            accelerate_distance = std::max(0.0f, has_acceleration ? accelerate_distance : 0.0f);
+            decelerate_distance = std::max(0.0f, has_acceleration ? decelerate_distance : 0.0f);
+            float cruise_distance = d - accelerate_distance - decelerate_distance;
+
+            // Not enough space to reach the nominal feedrate.
+            // This means no cruising, and we'll have to use the intersection distance to abort acceleration 
+            // and start braking in order to reach the exit_feedrate exactly at the end of this block.
+            float intersection = (2.0f * a_safe * d - sqr(entry) + sqr(exit)) / (4.0f * a_safe);
+            float triangle_accelerate_distance = clamp(0.0f, d, has_acceleration ? intersection : 0.0f);
+            float triangle_cruise = std::sqrt(std::max(0.0f, sqr(entry) + 2.0f * a * triangle_accelerate_distance));
+            bool triangle = cruise_distance < 0.0f;
+            accelerate_distance = triangle ? triangle_accelerate_distance : accelerate_distance;
+            cruise_distance = triangle ? 0.0f : cruise_distance;
+            cruise = triangle ? triangle_cruise : cruise;
+
+            float decelerate_after = accelerate_distance + cruise_distance;
+            float cruise_safe = (cruise != 0.0f) ? cruise : 1.0f;
+            float acceleration_time = (std::sqrt(std::max(0.0f, sqr(entry) + 2.0f * a * accelerate_distance)) - entry) / a_safe;
+            float cruise_time = (decelerate_after - accelerate_distance) / cruise_safe;
+            float deceleration_time = (std::sqrt(std::max(0.0f, sqr(cruise) + 2.0f * -a * (d - decelerate_after))) - cruise) / -a_safe;
+
+            float t = 0.0f;
+            t += has_acceleration ? acceleration_time : 0.0f;
+            t += (cruise != 0.0f) ? cruise_time : 0.0f;
+            t += has_acceleration ? deceleration_time : 0.0f;
+            time[i] = t;
         }
-
-        trapezoid.accelerate_until = accelerate_distance;
-        trapezoid.decelerate_after = accelerate_distance + cruise_distance;
     }
 
     float GCodeTimeEstimator::Block::max_allowable_speed(float acceleration, float target_velocity, float distance)
@@ -160,18 +128,73 @@ namespace Slic3r {
         return (acceleration == 0.0f) ? 0.0f : (2.0f * acceleration * distance - sqr(initial_rate) + sqr(final_rate)) / (4.0f * acceleration);
     }
 
-#if ENABLE_MOVE_STATS
+    float GCodeTimeEstimator::Block::acceleration_time_from_distance(float initial_feedrate, float distance, float acceleration)
+    {
+        return (acceleration != 0.0f) ? (speed_from_distance(initial_feedrate, distance, acceleration) - initial_feedrate) / acceleration : 0.0f;
+    }
+
+    float GCodeTimeEstimator::Block::speed_from_distance(float initial_feedrate, float distance, float acceleration)
+    {
+        // to avoid invalid negative numbers due to numerical imprecision 
+        float value = std::max(0.0f, sqr(initial_feedrate) + 2.0f * acceleration * distance);
+        return ::sqrt(value);
+    }
+
+    void GCodeTimeEstimator::BlocksList::clear()
+    {
+        distance.clear();
+        acceleration.clear();
+        max_entry_speed.clear();
+        safe_feedrate.clear();
+        entry_feedrate.clear();
+        cruise_feedrate.clear();
+        nominal_length.clear();
+        elapsed_time.clear();
+        move_type.clear();
+    }
+
+    void GCodeTimeEstimator::BlocksList::push_back(const Block &block)
+    {
+        distance.push_back(block.move_length());
+        acceleration.push_back(block.acceleration);
+        max_entry_speed.push_back(block.max_entry_speed);
+        safe_feedrate.push_back(block.safe_feedrate);
+        entry_feedrate.push_back(block.feedrate.entry);
+        cruise_feedrate.push_back(block.feedrate.cruise);
+        nominal_length.push_back(block.flags.nominal_length);
+        elapsed_time.push_back(-1.0f);
+        move_type.push_back(block.move_type);
+    }
+
+    size_t GCodeTimeEstimator::BlocksList::memory_used() const
+    {
+        size_t out = 0;
+        out += SLIC3R_STDVEC_MEMSIZE(distance, float);
+        out += SLIC3R_STDVEC_MEMSIZE(acceleration, float);
+        out += SLIC3R_STDVEC_MEMSIZE(max_entry_speed, float);
+        out += SLIC3R_STDVEC_MEMSIZE(safe_feedrate, float);
+        out += SLIC3R_STDVEC_MEMSIZE(entry_feedrate, float);
+        out += SLIC3R_STDVEC_MEMSIZE(cruise_feedrate, float);
+        out += SLIC3R_STDVEC_MEMSIZE(nominal_length, unsigned char);
+        out += SLIC3R_STDVEC_MEMSIZE(elapsed_time, float);
+        out += SLIC3R_STDVEC_MEMSIZE(move_type, Block::EMoveType);
+        return out;
+    }
+
     GCodeTimeEstimator::MoveStats::MoveStats()
         : count(0)
         , time(0.0f)
     {
     }
-#endif // ENABLE_MOVE_STATS
 
-    const std::string GCodeTimeEstimator::Normal_First_M73_Output_Placeholder_Tag = "; NORMAL_FIRST_M73_OUTPUT_PLACEHOLDER";
-    const std::string GCodeTimeEstimator::Silent_First_M73_Output_Placeholder_Tag = "; SILENT_FIRST_M73_OUTPUT_PLACEHOLDER";
-    const std::string GCodeTimeEstimator::Normal_Last_M73_Output_Placeholder_Tag = "; NORMAL_LAST_M73_OUTPUT_PLACEHOLDER";
-    const std::string GCodeTimeEstimator::Silent_Last_M73_Output_Placeholder_Tag = "; SILENT_LAST_M73_OUTPUT_PLACEHOLDER";
+    const std::string& GCodeTimeEstimator::get_move_type_name(Block::EMoveType type)
+    {
+        return MOVE_TYPE_STR[type];
+    }
+
+    // The firmware parses the zero padded numbers as usual.
+    const std::string GCodeTimeEstimator::Normal_M73_Placeholder = "M73 P000 R00000";
+    const std::string GCodeTimeEstimator::Silent_M73_Placeholder = "M73 Q000 S00000";
 
     GCodeTimeEstimator::GCodeTimeEstimator(EMode mode)
         : m_mode(mode)
@@ -206,6 +229,7 @@ namespace Slic3r {
         if (start_from_beginning)
         {
             _reset_time();
+            _moves_stats.clear();
             m_last_st_synchronized_block_id = -1;
         }
         _calculate_time();
@@ -269,132 +293,24 @@ namespace Slic3r {
 #endif // ENABLE_MOVE_STATS
     }
 
-    bool GCodeTimeEstimator::post_process_remaining_times(const std::string& filename, float interval)
+    std::vector<std::string> GCodeTimeEstimator::get_remaining_times_lines() const
     {
-        boost::nowide::ifstream in(filename);
-        if (!in.good())
-            throw std::runtime_error(std::string("Remaining times export failed.\nCannot open file for reading.\n"));
-
-        std::string path_tmp = filename + ".times";
-
-        FILE* out = boost::nowide::fopen(path_tmp.c_str(), "wb");
-        if (out == nullptr)
-            throw std::runtime_error(std::string("Remaining times export failed.\nCannot open file for writing.\n"));
-
-        std::string time_mask;
-        switch (m_mode)
-        {
-        default:
-        case Normal:
-        {
-            time_mask = "M73 P%s R%s\n";
-            break;
-        }
-        case Silent:
-        {
-            time_mask = "M73 Q%s S%s\n";
-            break;
-        }
-        }
-
-        unsigned int g1_lines_count = 0;
-        float last_recorded_time = 0.0f;
-        std::string gcode_line;
-        // buffer line to export only when greater than 64K to reduce writing calls
-        std::string export_line;
+        const char *time_mask = (m_mode == Silent) ? "M73 Q%03d S%05d" : "M73 P%03d R%05d";
+        std::vector<std::string> lines;
+        lines.reserve(m_remaining_times_block_ids.size());
         char time_line[64];
-		G1LineIdToBlockIdMap::const_iterator it_line_id = m_g1_line_ids.begin();
-		while (std::getline(in, gcode_line))
-        {
-            if (!in.good())
-            {
-                fclose(out);
-                throw std::runtime_error(std::string("Remaining times export failed.\nError while reading from file.\n"));
-            }
-
-            // replaces placeholders for initial line M73 with the real lines
-            if (((m_mode == Normal) && (gcode_line == Normal_First_M73_Output_Placeholder_Tag)) ||
-                ((m_mode == Silent) && (gcode_line == Silent_First_M73_Output_Placeholder_Tag)))
-            {
-                sprintf(time_line, time_mask.c_str(), "0", _get_time_minutes(m_time).c_str());
-                gcode_line = time_line;
-            }
-            // replaces placeholders for final line M73 with the real lines
-            else if (((m_mode == Normal) && (gcode_line == Normal_Last_M73_Output_Placeholder_Tag)) ||
-                     ((m_mode == Silent) && (gcode_line == Silent_Last_M73_Output_Placeholder_Tag)))
-            {
-                sprintf(time_line, time_mask.c_str(), "100", "0");
-                gcode_line = time_line;
-            }
-            else
-               gcode_line += "\n";
-
-
-            // add remaining time lines where needed
-            m_parser.parse_line(gcode_line,
-                [this, &it_line_id, &g1_lines_count, &last_recorded_time, &time_line, &gcode_line, time_mask, interval](GCodeReader& reader, const GCodeReader::GCodeLine& line)
-            {
-                if (line.cmd_is("G1"))
-                {
-                    ++g1_lines_count;
-
-					assert(it_line_id == m_g1_line_ids.end() || it_line_id->first >= g1_lines_count);
-
-					const Block *block = nullptr;
-					if (it_line_id != m_g1_line_ids.end() && it_line_id->first == g1_lines_count) {
-						if (line.has_e() && it_line_id->second < (unsigned int)m_blocks.size())
-							block = &m_blocks[it_line_id->second];
-						++it_line_id;
-					}
-
-					if (block != nullptr && block->elapsed_time != -1.0f) {
-                        float block_remaining_time = m_time - block->elapsed_time;
-                        if (std::abs(last_recorded_time - block_remaining_time) > interval)
-                        {
-                            sprintf(time_line, time_mask.c_str(), std::to_string((int)(100.0f * block->elapsed_time / m_time)).c_str(), _get_time_minutes(block_remaining_time).c_str());
-                            gcode_line += time_line;
-
-                            last_recorded_time = block_remaining_time;
-                        }
-                    }
-                }
-            });
-
-            export_line += gcode_line;
-            if (export_line.length() > 65535)
-            {
-                fwrite((const void*)export_line.c_str(), 1, export_line.length(), out);
-                if (ferror(out))
-                {
-                    in.close();
-                    fclose(out);
-                    boost::nowide::remove(path_tmp.c_str());
-                    throw std::runtime_error(std::string("Remaining times export failed.\nIs the disk full?\n"));
-                }
-                export_line.clear();
-            }
-        }
-
-        if (export_line.length() > 0)
+        for (unsigned int block_id : m_remaining_times_block_ids)
         {
-            fwrite((const void*)export_line.c_str(), 1, export_line.length(), out);
-            if (ferror(out))
-            {
-                in.close();
-                fclose(out);
-                boost::nowide::remove(path_tmp.c_str());
-                throw std::runtime_error(std::string("Remaining times export failed.\nIs the disk full?\n"));
-            }
+            // Time elapsed at the end of the last block preceding the placeholder.
+            float elapsed_time = 0.0f;
+            if (block_id > 0 && block_id <= (unsigned int)m_blocks.size() && m_blocks.elapsed_time[block_id - 1] != -1.0f)
+                elapsed_time = m_blocks.elapsed_time[block_id - 1];
+            int percent = (m_time > 0.0f) ? std::min(100, std::max(0, (int)(100.0f * elapsed_time / m_time))) : 0;
+            int minutes = std::min(99999, std::max(0, (int)::roundf((m_time - elapsed_time) / 60.0f)));
+            sprintf(time_line, time_mask, percent, minutes);
+            lines.emplace_back(time_line);
         }
-
-        fclose(out);
-        in.close();
-
-        if (rename_file(path_tmp, filename) != 0)
-            throw std::runtime_error(std::string("Failed to rename the output G-code file from ") + path_tmp + " to " + filename + '\n' +
-            "Is " + path_tmp + " locked?" + '\n');
-
-        return true;
+        return lines;
     }
 
     void GCodeTimeEstimator::set_axis_position(EAxis axis, float position)
@@ -664,12 +580,47 @@ namespace Slic3r {
         m_state.filament_unload_times.clear();
     }
 
+    void GCodeTimeEstimator::apply_print_config(const PrintConfig &config)
+    {
+        set_dialect(config.gcode_flavor);
+
+        // Until we have a UI support for the other firmwares than the Marlin, use the hardcoded default values
+        // and let the user to enter the G-code limits into the start G-code.
+        size_t idx = (m_mode == Silent) ? 1 : 0;
+        if (config.gcode_flavor.value == gcfMarlin && config.machine_max_acceleration_extruding.values.size() > idx)
+        {
+            set_max_acceleration((float)config.machine_max_acceleration_extruding.values[idx]);
+            set_retract_acceleration((float)config.machine_max_acceleration_retracting.values[idx]);
+            set_minimum_feedrate((float)config.machine_min_extruding_rate.values[idx]);
+            set_minimum_travel_feedrate((float)config.machine_min_travel_rate.values[idx]);
+            set_axis_max_acceleration(X, (float)config.machine_max_acceleration_x.values[idx]);
+            set_axis_max_acceleration(Y, (float)config.machine_max_acceleration_y.values[idx]);
+            set_axis_max_acceleration(Z, (float)config.machine_max_acceleration_z.values[idx]);
+            set_axis_max_acceleration(E, (float)config.machine_max_acceleration_e.values[idx]);
+            set_axis_max_feedrate(X, (float)config.machine_max_feedrate_x.values[idx]);
+            set_axis_max_feedrate(Y, (float)config.machine_max_feedrate_y.values[idx]);
+            set_axis_max_feedrate(Z, (float)config.machine_max_feedrate_z.values[idx]);
+            set_axis_max_feedrate(E, (float)config.machine_max_feedrate_e.values[idx]);
+            set_axis_max_jerk(X, (float)config.machine_max_jerk_x.values[idx]);
+            set_axis_max_jerk(Y, (float)config.machine_max_jerk_y.values[idx]);
+            set_axis_max_jerk(Z, (float)config.machine_max_jerk_z.values[idx]);
+            set_axis_max_jerk(E, (float)config.machine_max_jerk_e.values[idx]);
+        }
+
+        // Filament load / unload times are not specific to a firmware flavor. Let anybody use it if they find it useful.
+        if (config.single_extruder_multi_material)
+        {
+            // As of now the fields are shown at the UI dialog in the same combo box as the ramming values, so they
+            // are considered to be active for the single extruder multi-material printers only.
+            set_filament_load_times(config.filament_load_time.values);
+            set_filament_unload_times(config.filament_unload_time.values);
+        }
+    }
+
     void GCodeTimeEstimator::reset()
     {
         _reset_time();
-#if ENABLE_MOVE_STATS
         _moves_stats.clear();
-#endif // ENABLE_MOVE_STATS
         _reset_blocks();
         _reset();
     }
@@ -718,8 +669,8 @@ namespace Slic3r {
 	size_t GCodeTimeEstimator::memory_used() const
     {
         size_t out = sizeof(*this);
-		out += SLIC3R_STDVEC_MEMSIZE(this->m_blocks, Block);
-		out += SLIC3R_STDVEC_MEMSIZE(this->m_g1_line_ids, G1LineIdToBlockId);
+		out += this->m_blocks.memory_used();
+		out += SLIC3R_STDVEC_MEMSIZE(this->m_remaining_times_block_ids, unsigned int);
         return out;
     }
 
@@ -738,7 +689,7 @@ namespace Slic3r {
 
         reset_extruder_id();
         reset_g1_line_id();
-        m_g1_line_ids.clear();
+        m_remaining_times_block_ids.clear();
 
         m_last_st_synchronized_block_id = -1;
 
@@ -762,33 +713,36 @@ namespace Slic3r {
         PROFILE_FUNC();
         _forward_pass();
         _reverse_pass();
-        _recalculate_trapezoids();
+        _calculate_blocks_time();
 
         m_time += get_additional_time();
         m_color_time_cache += get_additional_time();
 
-        for (int i = m_last_st_synchronized_block_id + 1; i < (int)m_blocks.size(); ++i)
+        // Accumulate the times of the blocks, replacing them with the elapsed times.
+        MoveStats moves_stats[Block::Num_Types];
+        for (size_t i = size_t(m_last_st_synchronized_block_id + 1); i < m_blocks.size(); ++i)
         {
-            Block& block = m_blocks[i];
-            float block_time = 0.0f;
-            block_time += block.acceleration_time();
-            block_time += block.cruise_time();
-            block_time += block.deceleration_time();
+            float block_time = m_blocks.elapsed_time[i];
             m_time += block_time;
-            block.elapsed_time = m_time;
+            m_blocks.elapsed_time[i] = m_time;
 
-#if ENABLE_MOVE_STATS
-            MovesStatsMap::iterator it = _moves_stats.find(block.move_type);
-            if (it == _moves_stats.end())
-                it = _moves_stats.insert(MovesStatsMap::value_type(block.move_type, MoveStats())).first;
-
-            it->second.count += 1;
-            it->second.time += block_time;
-#endif // ENABLE_MOVE_STATS
+            MoveStats &stats = moves_stats[m_blocks.move_type[i]];
+            stats.count += 1;
+            stats.time += block_time;
 
             m_color_time_cache += block_time;
         }
 
+        for (unsigned char type = 0; type < Block::Num_Types; ++type)
+        {
+            if (moves_stats[type].count > 0)
+            {
+                MoveStats &stats = _moves_stats[(Block::EMoveType)type];
+                stats.count += moves_stats[type].count;
+                stats.time += moves_stats[type].time;
+            }
+        }
+
         m_last_st_synchronized_block_id = (int)m_blocks.size() - 1;
         // The additional time has been consumed (added to the total time), reset it to zero.
         set_additional_time(0.);
@@ -1027,8 +981,6 @@ namespace Slic3r {
                 m_curr.safe_feedrate = std::min(m_curr.safe_feedrate, axis_max_jerk);
         }
 
-        block.feedrate.exit = m_curr.safe_feedrate;
-
         // calculates block entry feedrate
         float vmax_junction = m_curr.safe_feedrate;
         if (!m_blocks.empty() && (m_prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD))
@@ -1096,12 +1048,8 @@ namespace Slic3r {
 
         block.max_entry_speed = vmax_junction;
         block.flags.nominal_length = (block.feedrate.cruise <= v_allowable);
-        block.flags.recalculate = true;
         block.safe_feedrate = m_curr.safe_feedrate;
 
-        // calculates block trapezoid
-        block.calculate_trapezoid();
-
         // updates previous
         m_prev = m_curr;
 
@@ -1111,7 +1059,6 @@ namespace Slic3r {
             set_axis_position((EAxis)a, new_pos[a]);
         }
 
-#if ENABLE_MOVE_STATS
         // detects block move type
         block.move_type = Block::Noop;
 
@@ -1131,11 +1078,9 @@ namespace Slic3r {
         }
         else if ((block.delta_pos[X] != 0.0f) || (block.delta_pos[Y] != 0.0f) || (block.delta_pos[Z] != 0.0f))
             block.move_type = Block::Move;
-#endif // ENABLE_MOVE_STATS
 
         // adds block to blocks list
-        m_blocks.emplace_back(block);
-        m_g1_line_ids.emplace_back(G1LineIdToBlockIdMap::value_type(get_g1_line_id(), (unsigned int)m_blocks.size() - 1));
+        m_blocks.push_back(block);
     }
 
     void GCodeTimeEstimator::_processG4(const GCodeReader::GCodeLine& line)
@@ -1431,105 +1376,75 @@ namespace Slic3r {
     void GCodeTimeEstimator::_forward_pass()
     {
         PROFILE_FUNC();
-        if (m_blocks.size() > 1)
+        size_t num_blocks = m_blocks.size();
+        const float         *distance       = m_blocks.distance.data();
+        const float         *acceleration   = m_blocks.acceleration.data();
+        const unsigned char *nominal_length = m_blocks.nominal_length.data();
+        float               *entry_feedrate = m_blocks.entry_feedrate.data();
+        for (size_t i = size_t(m_last_st_synchronized_block_id + 1); i + 1 < num_blocks; ++i)
         {
-            for (int i = m_last_st_synchronized_block_id + 1; i < (int)m_blocks.size() - 1; ++i)
-            {
-                _planner_forward_pass_kernel(m_blocks[i], m_blocks[i + 1]);
-            }
+            // If the previous block is an acceleration block, but it is not long enough to complete the
+            // full speed change within the block, we need to adjust the entry speed accordingly. Entry
+            // speeds have already been reset, maximized, and reverse planned by reverse planner.
+            // If nominal length is true, max junction speed is guaranteed to be reached. No need to recheck.
+            if (!nominal_length[i] && (entry_feedrate[i] < entry_feedrate[i + 1]))
+                entry_feedrate[i + 1] = std::min(entry_feedrate[i + 1], Block::max_allowable_speed(-acceleration[i], entry_feedrate[i], distance[i]));
         }
     }
 
     void GCodeTimeEstimator::_reverse_pass()
     {
         PROFILE_FUNC();
-        if (m_blocks.size() > 1)
-        {
-            for (int i = (int)m_blocks.size() - 1; i >= m_last_st_synchronized_block_id + 2; --i)
-            {
-                _planner_reverse_pass_kernel(m_blocks[i - 1], m_blocks[i]);
-            }
-        }
-    }
+        size_t num_blocks = m_blocks.size();
+        size_t first_block = size_t(m_last_st_synchronized_block_id + 1);
+        const float         *distance        = m_blocks.distance.data();
+        const float         *acceleration    = m_blocks.acceleration.data();
+        const float         *max_entry_speed = m_blocks.max_entry_speed.data();
+        const unsigned char *nominal_length  = m_blocks.nominal_length.data();
+        float               *entry_feedrate  = m_blocks.entry_feedrate.data();
+        if (num_blocks < 2)
+            return;
 
-    void GCodeTimeEstimator::_planner_forward_pass_kernel(Block& prev, Block& curr)
-    {
-        PROFILE_FUNC();
-        // If the previous block is an acceleration block, but it is not long enough to complete the
-        // full speed change within the block, we need to adjust the entry speed accordingly. Entry
-        // speeds have already been reset, maximized, and reverse planned by reverse planner.
-        // If nominal length is true, max junction speed is guaranteed to be reached. No need to recheck.
-        if (!prev.flags.nominal_length)
+        for (size_t next = num_blocks - 1; next > first_block; --next)
         {
-            if (prev.feedrate.entry < curr.feedrate.entry)
+            size_t curr = next - 1;
+            // If entry speed is already at the maximum entry speed, no need to recheck. Block is cruising.
+            // If not, block in state of acceleration or deceleration. Reset entry speed to maximum and
+            // check for maximum allowable speed reductions to ensure maximum possible planned speed.
+            if (entry_feedrate[curr] != max_entry_speed[curr])
             {
-                float entry_speed = std::min(curr.feedrate.entry, Block::max_allowable_speed(-prev.acceleration, prev.feedrate.entry, prev.move_length()));
-
-                // Check for junction speed change
-                if (curr.feedrate.entry != entry_speed)
-                {
-                    curr.feedrate.entry = entry_speed;
-                    curr.flags.recalculate = true;
-                }
+                // If nominal length true, max junction speed is guaranteed to be reached. Only compute
+                // for max allowable speed if block is decelerating and nominal length is false.
+                if (!nominal_length[curr] && (max_entry_speed[curr] > entry_feedrate[next]))
+                    entry_feedrate[curr] = std::min(max_entry_speed[curr], Block::max_allowable_speed(-acceleration[curr], entry_feedrate[next], distance[curr]));
+                else
+                    entry_feedrate[curr] = max_entry_speed[curr];
             }
         }
     }
 
-    void GCodeTimeEstimator::_planner_reverse_pass_kernel(Block& curr, Block& next)
-    {
-        // If entry speed is already at the maximum entry speed, no need to recheck. Block is cruising.
-        // If not, block in state of acceleration or deceleration. Reset entry speed to maximum and
-        // check for maximum allowable speed reductions to ensure maximum possible planned speed.
-        if (curr.feedrate.entry != curr.max_entry_speed)
-        {
-            // If nominal length true, max junction speed is guaranteed to be reached. Only compute
-            // for max allowable speed if block is decelerating and nominal length is false.
-            if (!curr.flags.nominal_length && (curr.max_entry_speed > next.feedrate.entry))
-                curr.feedrate.entry = std::min(curr.max_entry_speed, Block::max_allowable_speed(-curr.acceleration, next.feedrate.entry, curr.move_length()));
-            else
-                curr.feedrate.entry = curr.max_entry_speed;
-
-            curr.flags.recalculate = true;
-        }
-    }
-
-    void GCodeTimeEstimator::_recalculate_trapezoids()
+    void GCodeTimeEstimator::_calculate_blocks_time()
     {
         PROFILE_FUNC();
-        Block* curr = nullptr;
-        Block* next = nullptr;
-
-        for (int i = m_last_st_synchronized_block_id + 1; i < (int)m_blocks.size(); ++i)
-        {
-            Block& b = m_blocks[i];
-
-            curr = next;
-            next = &b;
-
-            if (curr != nullptr)
-            {
-                // Recalculate if current block entry or exit junction speed has changed.
-                if (curr->flags.recalculate || next->flags.recalculate)
-                {
-                    // NOTE: Entry and exit factors always > 0 by all previous logic operations.
-                    Block block = *curr;
-                    block.feedrate.exit = next->feedrate.entry;
-                    block.calculate_trapezoid();
-                    curr->trapezoid = block.trapezoid;
-                    curr->flags.recalculate = false; // Reset current only to ensure next trapezoid is computed
-                }
-            }
-        }
+        size_t num_blocks = m_blocks.size();
+        size_t first_block = size_t(m_last_st_synchronized_block_id + 1);
+        if (first_block >= num_blocks)
+            return;
 
-        // Last/newest block in buffer. Always recalculated.
-        if (next != nullptr)
-        {
-            Block block = *next;
-            block.feedrate.exit = next->safe_feedrate;
-            block.calculate_trapezoid();
-            next->trapezoid = block.trapezoid;
-            next->flags.recalculate = false;
-        }
+        // After the planner passes the entry feedrates are final, the trapezoid of a block only depends on the block itself
+        // and on the entry feedrate of the next block, thus the blocks are evaluated independently of each other.
+        const float *distance        = m_blocks.distance.data();
+        const float *acceleration    = m_blocks.acceleration.data();
+        const float *entry_feedrate  = m_blocks.entry_feedrate.data();
+        const float *cruise_feedrate = m_blocks.cruise_feedrate.data();
+        float       *time            = m_blocks.elapsed_time.data();
+        size_t last_block = num_blocks - 1;
+        Block::trapezoid_times(last_block - first_block, distance + first_block, acceleration + first_block,
+            entry_feedrate + first_block, cruise_feedrate + first_block, entry_feedrate + first_block + 1, time + first_block);
+
+        // Last/newest block in buffer, decelerating to its safe feedrate.
+        Block::trapezoid_times(1, distance + last_block, acceleration + last_block,
+            entry_feedrate + last_block, cruise_feedrate + last_block, m_blocks.safe_feedrate.data() + last_block, time + last_block);
     }
 
     std::string GCodeTimeEstimator::_get_time_dhms(float time_in_secs)
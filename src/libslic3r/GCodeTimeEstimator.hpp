@@ -5,6 +5,7 @@
 #include "PrintConfig.hpp"
 #include "GCodeReader.hpp"
 
+// Print the statistics of the move types to the console after each time estimate.
 #define ENABLE_MOVE_STATS 0
 
 namespace Slic3r {
@@ -17,10 +18,10 @@ namespace Slic3r {
     class GCodeTimeEstimator
     {
     public:
-        static const std::string Normal_First_M73_Output_Placeholder_Tag;
-        static const std::string Silent_First_M73_Output_Placeholder_Tag;
-        static const std::string Normal_Last_M73_Output_Placeholder_Tag;
-        static const std::string Silent_Last_M73_Output_Placeholder_Tag;
+        // Fixed width M73 lines reserved in the G-code for the remaining times. Once the print time is known,
+        // the G-code generator overwrites them in place with the lines returned by get_remaining_times_lines().
+        static const std::string Normal_M73_Placeholder;
+        static const std::string Silent_M73_Placeholder;
 
         enum EMode : unsigned char
         {
@@ -98,7 +99,6 @@ namespace Slic3r {
     public:
         struct Block
         {
-#if ENABLE_MOVE_STATS
             enum EMoveType : unsigned char
             {
                 Noop,
@@ -109,43 +109,19 @@ namespace Slic3r {
                 Extrude,
                 Num_Types
             };
-#endif // ENABLE_MOVE_STATS
 
             struct FeedrateProfile
             {
                 float entry;  // mm/s
                 float cruise; // mm/s
-                float exit;   // mm/s
-            };
-
-            struct Trapezoid
-            {
-                float distance;         // mm
-                float accelerate_until; // mm
-                float decelerate_after; // mm
-                FeedrateProfile feedrate;
-
-                float acceleration_time(float acceleration) const;
-                float cruise_time() const;
-                float deceleration_time(float acceleration) const;
-                float cruise_distance() const;
-
-                // This function gives the time needed to accelerate from an initial speed to reach a final distance.
-                static float acceleration_time_from_distance(float initial_feedrate, float distance, float acceleration);
-
-                // This function gives the final speed while accelerating at the given constant acceleration from the given initial speed along the given distance.
-                static float speed_from_distance(float initial_feedrate, float distance, float acceleration);
             };
 
             struct Flags
             {
-                bool recalculate;
                 bool nominal_length;
             };
 
-#if ENABLE_MOVE_STATS
             EMoveType move_type;
-#endif // ENABLE_MOVE_STATS
             Flags flags;
 
             float delta_pos[Num_Axis]; // mm
@@ -154,8 +130,6 @@ namespace Slic3r {
             float safe_feedrate;       // mm/s
 
             FeedrateProfile feedrate;
-            Trapezoid trapezoid;
-            float elapsed_time;
 
             Block();
 
@@ -168,20 +142,12 @@ namespace Slic3r {
             // Returns true if this block is a move with no extrusion
             float is_travel_move() const;
 
-            // Returns the time spent accelerating toward cruise speed, in seconds
-            float acceleration_time() const;
-
-            // Returns the time spent at cruise speed, in seconds
-            float cruise_time() const;
-
-            // Returns the time spent decelerating from cruise speed, in seconds
-            float deceleration_time() const;
-
-            // Returns the distance covered at cruise speed, in mm
-            float cruise_distance() const;
-
-            // Calculates this block's trapezoid
-            void calculate_trapezoid();
+            // Calculates the times needed to cover the distances of num_blocks blocks following their trapezoidal feedrate profiles,
+            // accelerating from the entry feedrate to the cruise feedrate and decelerating to the exit feedrate, in seconds.
+            // If the distance is too short to reach the cruise feedrate, the profile degenerates into a triangle.
+            // The loop is branch free so that the compiler vectorizes it, the results are the same as block by block.
+            static void trapezoid_times(size_t num_blocks, const float *distance, const float *acceleration,
+                const float *entry_feedrate, const float *cruise_feedrate, const float *exit_feedrate, float *time);
 
             // Calculates the maximum allowable speed at this point when you must be able to reach target_velocity using the 
             // acceleration within the allotted distance.
@@ -195,11 +161,38 @@ namespace Slic3r {
             // a total travel of distance. This can be used to compute the intersection point between acceleration and
             // deceleration in the cases where the trapezoid has no plateau (i.e. never reaches maximum speed)
             static float intersection_distance(float initial_rate, float final_rate, float acceleration, float distance);
+
+            // This function gives the time needed to accelerate from an initial speed to reach a final distance.
+            static float acceleration_time_from_distance(float initial_feedrate, float distance, float acceleration);
+
+            // This function gives the final speed while accelerating at the given constant acceleration from the given initial speed along the given distance.
+            static float speed_from_distance(float initial_feedrate, float distance, float acceleration);
         };
 
-        typedef std::vector<Block> BlocksList;
+        // The blocks are stored as a structure of arrays. The planner passes and the time calculation only touch
+        // the few values they need, streaming through contiguous arrays instead of striding over whole blocks,
+        // and the trapezoids of the blocks are evaluated by a loop over plain float arrays.
+        struct BlocksList
+        {
+            std::vector<float>          distance;           // mm
+            std::vector<float>          acceleration;       // mm/s^2
+            std::vector<float>          max_entry_speed;    // mm/s
+            std::vector<float>          safe_feedrate;      // mm/s
+            std::vector<float>          entry_feedrate;     // mm/s
+            std::vector<float>          cruise_feedrate;    // mm/s
+            std::vector<unsigned char>  nominal_length;
+            // Time elapsed from the beginning of the print at the end of the block, -1 until the block is st_synchronized.
+            std::vector<float>          elapsed_time;       // s
+            std::vector<Block::EMoveType> move_type;
+
+            size_t size() const { return distance.size(); }
+            bool empty() const { return distance.empty(); }
+            void clear();
+            void push_back(const Block &block);
+            // Memory allocated by the arrays.
+            size_t memory_used() const;
+        };
 
-#if ENABLE_MOVE_STATS
         struct MoveStats
         {
             unsigned int count;
@@ -209,10 +202,9 @@ namespace Slic3r {
         };
 
         typedef std::map<Block::EMoveType, MoveStats> MovesStatsMap;
-#endif // ENABLE_MOVE_STATS
 
-        typedef std::pair<unsigned int, unsigned int> G1LineIdToBlockId;
-        typedef std::vector<G1LineIdToBlockId> G1LineIdToBlockIdMap;
+        // Returns the name of the given move type
+        static const std::string& get_move_type_name(Block::EMoveType type);
 
     private:
         EMode m_mode;
@@ -221,8 +213,8 @@ namespace Slic3r {
         Feedrates m_curr;
         Feedrates m_prev;
         BlocksList m_blocks;
-        // Map between g1 line id and blocks id, used to speed up export of remaining times
-        G1LineIdToBlockIdMap m_g1_line_ids;
+        // Ids of the blocks following the M73 placeholders of this estimator's mode, used to export the remaining times
+        std::vector<unsigned int> m_remaining_times_block_ids;
         // Index of the last block already st_synchronized
         int m_last_st_synchronized_block_id;
         float m_time; // s
@@ -232,9 +224,7 @@ namespace Slic3r {
         std::vector<float> m_color_times;
         float m_color_time_cache;
 
-#if ENABLE_MOVE_STATS
         MovesStatsMap _moves_stats;
-#endif // ENABLE_MOVE_STATS
 
     public:
         explicit GCodeTimeEstimator(EMode mode);
@@ -260,12 +250,14 @@ namespace Slic3r {
         // Calculates the time estimate from the gcode contained in given list of gcode lines
         void calculate_time_from_lines(const std::vector<std::string>& gcode_lines);
 
-        // Process the gcode contained in the file with the given filename, 
-        // placing in it new lines (M73) containing the remaining time, at the given interval in seconds
-        // and saving the result back in the same file
-        // This time estimator should have been already used to calculate the time estimate for the gcode
-        // contained in the given file before to call this method
-        bool post_process_remaining_times(const std::string& filename, float interval_sec);
+        // Records that a M73 placeholder was reserved in the G-code after the gcode added so far.
+        // The placeholder itself shall not be passed to add_gcode_block().
+        void add_remaining_times_placeholder() { m_remaining_times_block_ids.emplace_back((unsigned int)m_blocks.size()); }
+
+        // Returns the M73 lines with the remaining times, one for each call to add_remaining_times_placeholder(),
+        // in the order of the calls. Each line has the length of the placeholder.
+        // The time estimate shall be calculated before calling this method.
+        std::vector<std::string> get_remaining_times_lines() const;
 
         // Set current position on the given axis with the given value
         void set_axis_position(EAxis axis, float position);
@@ -334,6 +326,10 @@ namespace Slic3r {
 
         void set_default();
 
+        // Sets the machine limits and the filament load / unload times from the print configuration, the same way
+        // the G-code generator does. The silent mode estimator uses the second set of the machine limits.
+        void apply_print_config(const PrintConfig &config);
+
         // Call this method before to start adding lines using add_gcode_line() when reusing an instance of GCodeTimeEstimator
         void reset();
 
@@ -355,6 +351,12 @@ namespace Slic3r {
         // Returns the estimated time, in minutes (integer), for each color
         std::vector<std::string> get_color_times_minutes() const;
 
+        // Returns the number of moves and the estimated time, in seconds, for each move type
+        const MovesStatsMap& get_moves_stats() const { return _moves_stats; }
+
+        // Returns the blocks of the moves added so far
+        const BlocksList& get_blocks() const { return m_blocks; }
+
         // Return an estimate of the memory consumed by the time estimator.
         size_t memory_used() const;
 
@@ -438,10 +440,8 @@ namespace Slic3r {
         void _forward_pass();
         void _reverse_pass();
 
-        void _planner_forward_pass_kernel(Block& prev, Block& curr);
-        void _planner_reverse_pass_kernel(Block& curr, Block& next);
-
-        void _recalculate_trapezoids();
+        // Calculates the time of the blocks not yet st_synchronized, storing it into m_blocks.elapsed_time
+        void _calculate_blocks_time();
 
         // Returns the given time is seconds in format DDd HHh MMm SSs
         static std::string _get_time_dhms(float time_in_secs);
@@ -314,20 +314,13 @@ convex_hull(const Polygons &polygons)
 void
 chained_path(const Points &points, std::vector<Points::size_type> &retval, Point start_near)
 {
-    PointConstPtrs my_points;
-    std::map<const Point*,Points::size_type> indices;
-    my_points.reserve(points.size());
-    for (Points::const_iterator it = points.begin(); it != points.end(); ++it) {
-        my_points.push_back(&*it);
-        indices[&*it] = it - points.begin();
-    }
-    
-    retval.reserve(points.size());
-    while (!my_points.empty()) {
-        Points::size_type idx = start_near.nearest_point_index(my_points);
-        start_near = *my_points[idx];
-        retval.push_back(indices[ my_points[idx] ]);
-        my_points.erase(my_points.begin() + idx);
+    NearestPointLookup lookup(points);
+    retval.reserve(retval.size() + points.size());
+    while (! lookup.empty()) {
+        Points::size_type idx = lookup.nearest(start_near);
+        start_near = points[idx];
+        retval.push_back(idx);
+        lookup.remove(idx);
     }
 }
 
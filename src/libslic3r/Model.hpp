@@ -392,6 +392,8 @@ public:
     std::string         name;
     // The triangular model.
     const TriangleMesh& mesh() const { return *m_mesh.get(); }
+    // Shared pointer to the mesh, to be able to test the mesh for identity.
+    const std::shared_ptr<const TriangleMesh>& mesh_ptr() const { return m_mesh; }
     void                set_mesh(const TriangleMesh &mesh) { m_mesh = std::make_shared<const TriangleMesh>(mesh); }
     void                set_mesh(TriangleMesh &&mesh) { m_mesh = std::make_shared<const TriangleMesh>(std::move(mesh)); }
     void                set_mesh(std::shared_ptr<const TriangleMesh> &mesh) { m_mesh = mesh; }
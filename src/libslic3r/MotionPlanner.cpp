@@ -73,7 +73,7 @@ Polyline MotionPlanner::shortest_path(const Point &from, const Point &to)
         if (island_idx_from == idx && island_idx_to == idx) {
             // Since both points are in the same island, is a direct move possible?
             // If so, we avoid generating the visibility environment.
-            if (island.m_island.contains(Line(from, to)))
+            if (island.island_contains(from, to))
                 return Polyline(from, to);
             // Both points are inside a single island, but the straight line crosses the island boundary.
             island_idx = idx;
@@ -123,7 +123,7 @@ Polyline MotionPlanner::shortest_path(const Point &from, const Point &to)
     {
         // grow our environment slightly in order for simplify_by_visibility()
         // to work best by considering moves on boundaries valid as well
-        ExPolygonCollection grown_env(offset_ex(env.m_env.expolygons, double(+SCALED_EPSILON)));
+        const ExPolygonCollection &grown_env = env.m_env_grown;
         
         if (island_idx == -1) {
             /*  If 'from' or 'to' are not inside our env, they were connected using the 
@@ -136,11 +136,11 @@ Polyline MotionPlanner::shortest_path(const Point &from, const Point &to)
             if (! grown_env.contains(from)) {
                 // delete second point while the line connecting first to third crosses the
                 // boundaries as many times as the current first to second
-                while (polyline.points.size() > 2 && intersection_ln(Line(from, polyline.points[2]), grown_env).size() == 1)
+                while (polyline.points.size() > 2 && env.num_grown_env_pieces(Line(from, polyline.points[2])) == 1)
                     polyline.points.erase(polyline.points.begin() + 1);
             }
             if (! grown_env.contains(to))
-                while (polyline.points.size() > 2 && intersection_ln(Line(*(polyline.points.end() - 3), to), grown_env).size() == 1)
+                while (polyline.points.size() > 2 && env.num_grown_env_pieces(Line(*(polyline.points.end() - 3), to)) == 1)
                     polyline.points.erase(polyline.points.end() - 2);
         }
 
@@ -194,8 +194,11 @@ const MotionPlannerGraph& MotionPlanner::init_graph(int island_idx)
         VD vd;
         // Mapping between Voronoi vertices and graph nodes.
         std::map<const VD::vertex_type*, size_t> vd_vertices;
+        MotionPlannerEnv &env = (island_idx == -1) ? m_outer : m_islands[island_idx];
+        // The grown environment is used by shortest_path() to trim the path, it is shared by all the paths
+        // searched in this environment.
+        env.init_grown_env();
         // get boundaries as lines
-        const MotionPlannerEnv &env = this->get_env(island_idx);
         Lines lines = env.m_env.lines();
         boost::polygon::construct_voronoi(lines.begin(), lines.end(), &vd);
         // traverse the Voronoi diagram and generate graph nodes and edges
@@ -208,7 +211,14 @@ const MotionPlannerGraph& MotionPlanner::init_graph(int island_idx)
             Point p1(v1->x(), v1->y());
             // Insert only Voronoi edges fully contained in the island.
             //FIXME This test has a terrible O(n^2) time complexity.
-            if (env.island_contains_b(p0) && env.island_contains_b(p1)) {
+            // A Voronoi vertex is shared by several edges, therefore the result of the test is cached in the color of the vertex:
+            // 0 - not tested yet, 1 - inside, 2 - outside.
+            auto vertex_inside = [&env](const VD::vertex_type *v, const Point &p) {
+                if (v->color() == 0)
+                    v->color(env.island_contains_b(p) ? 1 : 2);
+                return v->color() == 1;
+            };
+            if (vertex_inside(v0, p0) && vertex_inside(v1, p1)) {
                 // Find v0 in the graph, allocate a new node if v0 does not exist in the graph yet.
                 auto i_v0 = vd_vertices.find(v0);
                 size_t v0_idx;
@@ -227,6 +237,7 @@ const MotionPlannerGraph& MotionPlanner::init_graph(int island_idx)
                 graph->add_edge(v0_idx, v1_idx, (p1 - p0).cast<double>().norm());
             }
         }
+        graph->build_node_lookup();
     }
 
     return *graph;
@@ -291,6 +302,39 @@ Point MotionPlannerEnv::nearest_env_point(const Point &from, const Point &to) co
     return pp.empty() ? from : pp.front();
 }
 
+bool MotionPlannerEnv::island_contains(const Point &from, const Point &to)
+{
+    assert(this->island_contains(from) && this->island_contains(to));
+    if (! m_island_grid) {
+        m_island_grid = make_unique<EdgeGrid::Grid>();
+        m_island_grid->create(m_island, coord_t(scale_(1.) + 0.5));
+    }
+    // Both end points are inside the island, thus the line is inside the island if it does not cross its boundary.
+    return ! m_island_grid->line_intersects_contours(from, to);
+}
+
+void MotionPlannerEnv::init_grown_env()
+{
+    m_env_grown = ExPolygonCollection(offset_ex(m_env.expolygons, double(+SCALED_EPSILON)));
+    m_env_grown_polygons = m_env_grown;
+    m_env_grown_bboxes.clear();
+    m_env_grown_bboxes.reserve(m_env_grown_polygons.size());
+    for (const Polygon &polygon : m_env_grown_polygons)
+        m_env_grown_bboxes.emplace_back(get_extents(polygon));
+}
+
+size_t MotionPlannerEnv::num_grown_env_pieces(const Line &line) const
+{
+    // A polygon not overlapping the bounding box of the line neither crosses the line nor contains any of its points,
+    // thus it does not influence the clipping result. Clip with the polygons close to the line only.
+    BoundingBox bbox(Point(line.a.cwiseMin(line.b)), Point(line.a.cwiseMax(line.b)));
+    Polygons    polygons;
+    for (size_t i = 0; i < m_env_grown_polygons.size(); ++ i)
+        if (m_env_grown_bboxes[i].overlap(bbox))
+            polygons.emplace_back(m_env_grown_polygons[i]);
+    return polygons.empty() ? 0 : intersection_ln(line, polygons).size();
+}
+
 // Add a new directed edge to the adjacency graph.
 void MotionPlannerGraph::add_edge(size_t from, size_t to, double weight)
 {
@@ -304,7 +348,8 @@ void MotionPlannerGraph::add_edge(size_t from, size_t to, double weight)
     m_adjacency_list[from].emplace_back(Neighbor(node_t(to), weight));
 }
 
-// Dijkstra's shortest path in a weighted graph from node_start to node_end.
+// A* shortest path in a weighted graph from node_start to node_end, guided by the Euclidean distance to node_end.
+// As the edge weights are the Euclidean lengths of the edges, the heuristic is consistent and the path found is the shortest one.
 // The returned path contains the end points.
 // If no path exists from node_start to node_end, a straight segment is returned.
 Polyline MotionPlannerGraph::shortest_path(size_t node_start, size_t node_end) const
@@ -313,45 +358,61 @@ Polyline MotionPlannerGraph::shortest_path(size_t node_start, size_t node_end) c
     if (this->empty())
         return Polyline();
 
-    // Dijkstra algorithm, previous node of the current node 'u' in the shortest path towards node_start.
-    std::vector<node_t>   previous(m_adjacency_list.size(), -1);
-    std::vector<weight_t> distance(m_adjacency_list.size(), std::numeric_limits<weight_t>::infinity());
-    std::vector<size_t>   map_node_to_queue_id(m_adjacency_list.size(), size_t(-1));
+    // Node of the queue, which was not reached yet or which was already visited.
+    const size_t QUEUE_ID_NONE    = size_t(-1);
+    const size_t QUEUE_ID_VISITED = size_t(-2);
+    // Previous node of the current node 'u' in the shortest path towards node_start.
+    std::vector<node_t>   previous(m_nodes.size(), -1);
+    // Length of the shortest path from node_start to a node found so far.
+    std::vector<weight_t> distance(m_nodes.size(), std::numeric_limits<weight_t>::infinity());
+    // Lower bound of the length of a path from node_start to node_end through a node.
+    std::vector<weight_t> estimate(m_nodes.size(), std::numeric_limits<weight_t>::infinity());
+    std::vector<size_t>   map_node_to_queue_id(m_nodes.size(), QUEUE_ID_NONE);
+    const Point &target = m_nodes[node_end];
+    auto heuristic = [this, &target](const node_t node) { return (target - m_nodes[node]).cast<double>().norm(); };
     distance[node_start] = 0.;
+    estimate[node_start] = heuristic(node_t(node_start));
 
+    // Only the nodes reached by the search are inserted into the queue.
     auto queue = make_mutable_priority_queue<node_t>(
         [&map_node_to_queue_id](const node_t node, size_t idx) { map_node_to_queue_id[node] = idx; },
-        [&distance](const node_t node1, const node_t node2) { return distance[node1] < distance[node2]; });
-    queue.reserve(m_adjacency_list.size());
-    for (size_t i = 0; i < m_adjacency_list.size(); ++ i)
-        queue.push(node_t(i));
+        [&estimate](const node_t node1, const node_t node2) { return estimate[node1] < estimate[node2]; });
+    queue.push(node_t(node_start));
 
     while (! queue.empty()) {
-        // Get the next node with the lowest distance to node_start.
+        // Get the next node with the lowest estimate of the path length.
         node_t u = node_t(queue.top());
         queue.pop();
-        map_node_to_queue_id[u] = size_t(-1);
+        map_node_to_queue_id[u] = QUEUE_ID_VISITED;
         // Stop searching if we reached our destination.
         if (size_t(u) == node_end)
             break;
+        if (size_t(u) >= m_adjacency_list.size())
+            // No edge starts at u.
+            continue;
         // Visit each edge starting at node u.
-        for (const Neighbor& neighbor : m_adjacency_list[u])
-            if (map_node_to_queue_id[neighbor.target] != size_t(-1)) {
-                weight_t alt = distance[u] + neighbor.weight;
-                // If total distance through u is shorter than the previous
-                // distance (if any) between node_start and neighbor.target, replace it.
-                if (alt < distance[neighbor.target]) {
-                    distance[neighbor.target] = alt;
-                    previous[neighbor.target] = u;
-                    queue.update(map_node_to_queue_id[neighbor.target]);
-                }
+        for (const Neighbor& neighbor : m_adjacency_list[u]) {
+            size_t queue_id = map_node_to_queue_id[neighbor.target];
+            if (queue_id == QUEUE_ID_VISITED)
+                continue;
+            weight_t alt = distance[u] + neighbor.weight;
+            // If total distance through u is shorter than the previous
+            // distance (if any) between node_start and neighbor.target, replace it.
+            if (alt < distance[neighbor.target]) {
+                distance[neighbor.target] = alt;
+                estimate[neighbor.target] = alt + heuristic(neighbor.target);
+                previous[neighbor.target] = u;
+                if (queue_id == QUEUE_ID_NONE)
+                    queue.push(neighbor.target);
+                else
+                    queue.update(queue_id);
             }
+        }
     }
 
     // In case the end point was not reached, previous[node_end] contains -1
     // and a straight line from node_start to node_end is returned.
     Polyline polyline;
-    polyline.points.reserve(m_adjacency_list.size());
     for (node_t vertex = node_t(node_end); vertex != -1; vertex = previous[vertex])
         polyline.points.emplace_back(m_nodes[vertex]);
     polyline.points.emplace_back(m_nodes[node_start]);
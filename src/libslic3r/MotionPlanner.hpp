@@ -4,6 +4,7 @@
 #include "libslic3r.h"
 #include "BoundingBox.hpp"
 #include "ClipperUtils.hpp"
+#include "EdgeGrid.hpp"
 #include "ExPolygonCollection.hpp"
 #include "Polyline.hpp"
 #include <map>
@@ -30,22 +31,42 @@ public:
         { return m_island_bbox.contains(pt) && m_island.contains(pt); }
     bool  island_contains_b(const Point &pt) const
         { return m_island_bbox.contains(pt) && m_island.contains_b(pt); }
+    // Test whether a line connecting two points inside the island does not leave the island.
+    // Lines touching the island boundary are conservatively reported as not contained.
+    bool  island_contains(const Point &from, const Point &to);
 
 private:
     ExPolygon           m_island;
     BoundingBox         m_island_bbox;
+    // Edge grid over m_island, created on demand by island_contains(from, to). It references the contours of m_island,
+    // therefore it is only created once the MotionPlannerEnv is stored at its final place.
+    std::unique_ptr<EdgeGrid::Grid> m_island_grid;
     // Region, where the travel is allowed.
     ExPolygonCollection m_env;
+    // m_env grown by SCALED_EPSILON, created together with the graph of this environment.
+    ExPolygonCollection m_env_grown;
+    // Polygons of m_env_grown and their bounding boxes for num_grown_env_pieces().
+    Polygons                 m_env_grown_polygons;
+    std::vector<BoundingBox> m_env_grown_bboxes;
+
+    void   init_grown_env();
+    // Number of pieces of a line inside m_env_grown.
+    size_t num_grown_env_pieces(const Line &line) const;
 };
 
-// A 2D directed graph for searching a shortest path using the famous Dijkstra algorithm.
+// A 2D directed graph for searching a shortest path using the A* algorithm.
+// The edge weights are expected to be the Euclidean lengths of the edges, as the Euclidean distance to the target
+// is used as the A* heuristic.
 class MotionPlannerGraph
 {    
 public:
     // Add a directed edge into the graph.
     size_t   add_node(const Point &p) { m_nodes.emplace_back(p); return m_nodes.size() - 1; }
     void     add_edge(size_t from, size_t to, double weight);
-    size_t   find_closest_node(const Point &point) const { return point.nearest_point_index(m_nodes); }
+    // To be called after all the nodes were added, before the graph is queried.
+    void     build_node_lookup() { m_node_lookup = Slic3r::make_unique<NearestPointLookup>(m_nodes); }
+    size_t   find_closest_node(const Point &point) const 
+        { return m_node_lookup ? m_node_lookup->nearest(point) : point.nearest_point_index(m_nodes); }
 
     bool     empty() const { return m_adjacency_list.empty(); }
     Polyline shortest_path(size_t from, size_t to) const;
@@ -62,6 +83,7 @@ private:
     };
     Points                              m_nodes;
     std::vector<std::vector<Neighbor>>  m_adjacency_list;
+    std::unique_ptr<NearestPointLookup> m_node_lookup;
 };
 
 class MotionPlanner
@@ -2,6 +2,7 @@
 #include "Line.hpp"
 #include "MultiPoint.hpp"
 #include "Int128.hpp"
+#include "BoundingBox.hpp"
 #include <algorithm>
 
 namespace Slic3r {
@@ -100,6 +101,119 @@ int32_t Point::nearest_point_index(const PointConstPtrs &points) const
     return idx;
 }
 
+NearestPointLookup::NearestPointLookup(const Points &points) :
+    m_points(points), m_removed(points.size(), false), m_num_alive(points.size())
+{
+    this->build();
+}
+
+void NearestPointLookup::build()
+{
+    m_num_built = m_num_alive;
+    BoundingBox bbox;
+    for (size_t i = 0; i < m_points.size(); ++ i)
+        if (! m_removed[i])
+            bbox.merge(m_points[i]);
+    m_origin = bbox.min;
+    m_cols   = 1;
+    m_rows   = 1;
+    if (m_num_alive > 16) {
+        // About two points per cell.
+        Vec2d  size      = (bbox.max - bbox.min).cast<double>() + Vec2d(1., 1.);
+        double cell_size = std::max(1., std::sqrt(2. * size(0) * size(1) / double(m_num_alive)));
+        // Long and thin bounding boxes.
+        cell_size = std::max(cell_size, std::max(size(0), size(1)) / double(2 * m_num_alive));
+        m_cols = std::max(1, int(std::ceil(size(0) / cell_size)));
+        m_rows = std::max(1, int(std::ceil(size(1) / cell_size)));
+        m_cell_size = coord_t(std::ceil(cell_size));
+    } else
+        m_cell_size = std::max(bbox.max(0) - bbox.min(0), bbox.max(1) - bbox.min(1)) + 1;
+    // Bin the points, keep them sorted by their indices inside a cell.
+    m_cells.assign(size_t(m_cols) * size_t(m_rows) + 1, 0);
+    auto cell_of = [this](const Point &pt) {
+        int col = std::min(m_cols - 1, int((pt(0) - m_origin(0)) / m_cell_size));
+        int row = std::min(m_rows - 1, int((pt(1) - m_origin(1)) / m_cell_size));
+        return size_t(row) * size_t(m_cols) + size_t(col);
+    };
+    for (size_t i = 0; i < m_points.size(); ++ i)
+        if (! m_removed[i])
+            ++ m_cells[cell_of(m_points[i]) + 1];
+    for (size_t i = 1; i < m_cells.size(); ++ i)
+        m_cells[i] += m_cells[i - 1];
+    m_cell_points.assign(m_num_alive, 0);
+    std::vector<size_t> next(m_cells.begin(), m_cells.end() - 1);
+    for (size_t i = 0; i < m_points.size(); ++ i)
+        if (! m_removed[i])
+            m_cell_points[next[cell_of(m_points[i])] ++] = i;
+}
+
+void NearestPointLookup::remove(size_t idx)
+{
+    assert(! m_removed[idx]);
+    m_removed[idx] = true;
+    -- m_num_alive;
+    // Keep the grid dense enough, so that the search does not iterate over too many empty cells.
+    if (m_num_alive > 16 && m_num_alive * 4 < m_num_built)
+        this->build();
+}
+
+int NearestPointLookup::nearest(const Point &pt) const
+{
+    int    idx      = -1;
+    double distance = -1;
+    // Cell of pt clamped to the grid.
+    coord_t col = std::max<coord_t>(0, std::min<coord_t>(m_cols - 1, (pt(0) - m_origin(0)) / m_cell_size));
+    coord_t row = std::max<coord_t>(0, std::min<coord_t>(m_rows - 1, (pt(1) - m_origin(1)) / m_cell_size));
+    for (coord_t ring = 0;; ++ ring) {
+        // Block of cells [col - ring, col + ring] x [row - ring, row + ring] clipped by the grid.
+        coord_t col_min = std::max<coord_t>(0, col - ring);
+        coord_t col_max = std::min<coord_t>(m_cols - 1, col + ring);
+        coord_t row_min = std::max<coord_t>(0, row - ring);
+        coord_t row_max = std::min<coord_t>(m_rows - 1, row + ring);
+        for (coord_t r = row_min; r <= row_max; ++ r) {
+            bool ring_row = r == row - ring || r == row + ring;
+            for (coord_t c = col_min; c <= col_max; ++ c) {
+                if (! ring_row && c != col - ring && c != col + ring)
+                    // Inside the block visited already.
+                    continue;
+                size_t cell = size_t(r) * size_t(m_cols) + size_t(c);
+                for (size_t i = m_cells[cell]; i < m_cells[cell + 1]; ++ i) {
+                    size_t point_idx = m_cell_points[i];
+                    if (m_removed[point_idx])
+                        continue;
+                    // Same metric and the same preference as Point::nearest_point_index(): the first point at a zero distance,
+                    // otherwise the last point of the minimum distance.
+                    const Point &p = m_points[point_idx];
+                    double d = sqr<double>(pt(0) - p(0)) + sqr<double>(pt(1) - p(1));
+                    if (idx == -1 || d < distance || (d == distance && (d < EPSILON ? int(point_idx) < idx : int(point_idx) > idx))) {
+                        idx      = int(point_idx);
+                        distance = d;
+                    }
+                }
+            }
+        }
+        if (col_min == 0 && row_min == 0 && col_max == m_cols - 1 && row_max == m_rows - 1)
+            // The whole grid was searched.
+            break;
+        if (idx != -1) {
+            // Distance of pt to the cells outside of the block, ignoring the sides at the boundary of the grid.
+            double bound = std::numeric_limits<double>::max();
+            if (col - ring > 0)
+                bound = std::min(bound, double(pt(0) - (m_origin(0) + (col - ring) * m_cell_size)));
+            if (col + ring < m_cols - 1)
+                bound = std::min(bound, double(m_origin(0) + (col + ring + 1) * m_cell_size - pt(0)));
+            if (row - ring > 0)
+                bound = std::min(bound, double(pt(1) - (m_origin(1) + (row - ring) * m_cell_size)));
+            if (row + ring < m_rows - 1)
+                bound = std::min(bound, double(m_origin(1) + (row + ring + 1) * m_cell_size - pt(1)));
+            // Points outside of the block are further than bound, leave a margin for the rounding of the squared distances.
+            if (bound > 0. && bound * bound > distance * (1. + 1e-10) + 1.)
+                break;
+        }
+    }
+    return idx;
+}
+
 /* distance to the closest point of line */
 double
 Point::distance_to(const Line &line) const {
@@ -160,6 +160,39 @@ struct PointHash {
     }
 };
 
+// Repeated search for the point closest to a query point among a shrinking set of points, as done by the greedy chaining
+// algorithms (Geometry::chained_path(), ExtrusionEntityCollection::chained_path_from()). The points are binned into a regular grid,
+// which is searched ring by ring around the query point instead of scanning all the points.
+// The result is exactly the one of Point::nearest_point_index() called over the points not removed yet, kept in their original order:
+// the same squared distance in doubles, the first point at a zero distance or the last point of the minimum distance.
+class NearestPointLookup
+{
+public:
+    explicit NearestPointLookup(const Points &points);
+
+    // Index of the point closest to pt into the points passed to the constructor, -1 if all the points were removed.
+    int     nearest(const Point &pt) const;
+    void    remove(size_t idx);
+    size_t  size() const { return m_num_alive; }
+    bool    empty() const { return m_num_alive == 0; }
+
+private:
+    void    build();
+
+    Points                  m_points;
+    std::vector<char>       m_removed;
+    size_t                  m_num_alive;
+    // Grid over the points alive when the grid was last built.
+    Point                   m_origin;
+    coord_t                 m_cell_size;
+    int                     m_cols;
+    int                     m_rows;
+    size_t                  m_num_built;
+    // Indices of the points sorted by their cells, the points of cell i are m_cell_points[m_cells[i], m_cells[i + 1]).
+    std::vector<size_t>     m_cells;
+    std::vector<size_t>     m_cell_points;
+};
+
 // A generic class to search for a closest Point in a given radius.
 // It uses std::unordered_multimap to implement an efficient 2D spatial hashing.
 // The PointAccessor has to return const Point*.
@@ -16,11 +16,18 @@
 #include <libnest2d.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <exception>
 #include <limits>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
 //! macro used to mark string used at localization,
 //! return same string
 #define L(s) Slic3r::I18N::translate(s)
@@ -1444,13 +1451,44 @@ void Print::auto_assign_extruders(ModelObject* model_object) const
 void Print::process()
 {
     BOOST_LOG_TRIVIAL(info) << "Staring the slicing process." << log_memory_info();
-    for (PrintObject *obj : m_objects)
-        obj->make_perimeters();
-    this->set_status(70, L("Infilling layers"));
-    for (PrintObject *obj : m_objects)
-        obj->infill();
-    for (PrintObject *obj : m_objects)
-        obj->generate_support_material();
+    auto         time_start = std::chrono::steady_clock::now();
+    std::clock_t cpu_start  = std::clock();
+    // The object steps (slicing, perimeters, infill, support material) of an object only depend on the preceding steps
+    // of the same object, therefore the chains of object steps of all the objects run in parallel. Each step parallelizes
+    // over the layers internally, the cores left idle by the serial parts of one object's step are used by the other objects.
+    // Exceptions are caught per object: an exception escaping the parallel_for would cancel the nested layer loops
+    // of the other objects half way, leaving their steps marked as done with incomplete results.
+    std::exception_ptr  exception;
+    std::atomic<bool>   failed(false);
+    tbb::mutex          exception_mutex;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_objects.size(), 1),
+        [this, &exception, &failed, &exception_mutex](const tbb::blocked_range<size_t> &range) {
+            for (size_t idx = range.begin(); idx < range.end() && ! failed; ++ idx) {
+                PrintObject *obj = m_objects[idx];
+                try {
+                    obj->make_perimeters();
+                    this->set_status(70, L("Infilling layers"));
+                    obj->infill();
+                    obj->generate_support_material();
+                } catch (...) {
+                    tbb::mutex::scoped_lock lock(exception_mutex);
+                    if (! exception)
+                        exception = std::current_exception();
+                    failed = true;
+                }
+            }
+        });
+    if (exception)
+        std::rethrow_exception(exception);
+    {
+        double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+        // std::clock() measures the CPU time of all threads of the process, except on Windows, where it measures the wall time.
+        double cpu_time  = double(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        int    threads   = tbb::task_scheduler_init::default_num_threads();
+        BOOST_LOG_TRIVIAL(info) << "Processed " << m_objects.size() << " objects in " << wall_time << " s, CPU time " << cpu_time << " s, " <<
+            "core utilization " << int(100. * cpu_time / (std::max(wall_time, 1e-6) * threads)) << "% of " << threads << " threads";
+    }
     if (this->set_started(psSkirt)) {
         m_skirt.clear();
         for (PrintObject *obj : m_objects) {
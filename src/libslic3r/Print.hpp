@@ -149,6 +149,14 @@ public:
     const ExtrusionEntityCollection& skirt() const { return m_skirt; }
     const ExtrusionEntityCollection& brim() const { return m_brim; }
 
+    // Number of layers, for which the last make_perimeters() reused the cached perimeters (hits)
+    // or generated the perimeters from scratch (misses).
+    struct PerimetersCacheStats {
+        size_t hits   = 0;
+        size_t misses = 0;
+    };
+    const PerimetersCacheStats& perimeters_cache_stats() const { return m_perimeters_cache_stats; }
+
 protected:
     // to be called from Print only.
     friend class Print;
@@ -174,6 +182,8 @@ protected:
 
 private:
     void make_perimeters();
+    // Generate the perimeters of the layers, reusing the layers of m_perimeters_cache whose inputs did not change.
+    void make_perimeters_cached();
     void prepare_infill();
     void infill();
     void generate_support_material();
@@ -193,6 +203,8 @@ private:
     void clip_fill_surfaces();
     void tag_under_bridge();
     void discover_horizontal_shells();
+    // Discover the horizontal shells of a single region. Only the LayerRegions of region_id are accessed.
+    void discover_horizontal_shells(size_t region_id);
     void combine_infill();
     void _generate_support_material();
 
@@ -220,8 +232,56 @@ private:
     std::vector<ExPolygons> slice_volumes(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, const ModelVolume &volume) const;
     std::vector<ExPolygons> slice_volume(const std::vector<float> &z, const std::vector<t_layer_height_range> &ranges, const ModelVolume &volume) const;
-
-
+    // Returns a slicer of the volumes composed into a single mesh, transformed into the object coordinate system.
+    // Returns null if the composed mesh is empty.
+    const TriangleMeshSlicer* volumes_slicer(const std::vector<const ModelVolume*> &volumes) const;
+    // Key of the slices of the volumes in the SliceCache.
+    std::string slice_cache_key(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes) const;
+
+    // Composed mesh of a set of volumes together with its slicer and the slicer's Z index, see volumes_slicer().
+    struct VolumesSlicer {
+        VolumesSlicer(float closing_radius, float model_precision) : slicer(closing_radius, model_precision) {}
+        // Source meshes and their volume transformations.
+        std::vector<std::pair<std::shared_ptr<const TriangleMesh>, Transform3d>> volumes;
+        // Object transformation, XY shift and slicing parameters the mesh and slicer were created with.
+        Transform3d                 trafo;
+        Point                       copies_shift;
+        TriangleMesh                mesh;
+        TriangleMeshSlicer          slicer;
+    };
+    // Slicers of the volume sets sliced by slice_region(), slice_modifiers() and slice_support_volumes(),
+    // so that the meshes are not composed and indexed again for each pass. Released at the end of _slice(), after the support
+    // material is generated or when posSlice is invalidated, so that the meshes don't outlive the slicing passes.
+    // Only accessed by the background processing thread working on this object.
+    mutable std::vector<std::unique_ptr<VolumesSlicer>> m_volumes_slicers;
+
+    // Inputs and outputs of Layer::make_perimeters() for a single layer region.
+    struct LayerRegionPerimeters {
+        Surfaces                    slices;
+        ExtrusionEntityCollection   perimeters;
+        ExtrusionEntityCollection   thin_fills;
+        SurfaceCollection           fill_surfaces;
+        ExPolygons                  fill_expolygons;
+        ExPolygons                  fill_no_overlap_expolygons;
+    };
+    // Perimeters of a layer together with the inputs they were generated from. The slices of the neighbor layers
+    // are compared through the cache entries of the neighbor layers.
+    struct LayerPerimetersCacheEntry {
+        // Hash of the inputs below, to reject most of the changed layers without comparing the slices.
+        uint64_t                            inputs_hash     = 0;
+        size_t                              layer_id        = size_t(-1);
+        coordf_t                            height          = 0.;
+        bool                                has_lower_layer = false;
+        bool                                has_upper_layer = false;
+        ExPolygons                          slices;
+        std::vector<LayerRegionPerimeters>  regions;
+    };
+    // Indexed by layer index, the cache survives the invalidation of posSlice / posPerimeters, so that make_perimeters()
+    // regenerates only the layers, which changed. Only filled in if Print::reuse_perimeters() is enabled.
+    std::vector<LayerPerimetersCacheEntry>  m_perimeters_cache;
+    // Values of the configuration options read by the perimeter generator, which m_perimeters_cache was generated with.
+    std::string                             m_perimeters_cache_config;
+    PerimetersCacheStats                    m_perimeters_cache_stats;
 };
 
 struct WipeTowerData
@@ -325,6 +385,16 @@ public:
     // Returns true if the last step was finished with success.
     bool                finished() const override { return this->is_step_done(psGCodeExport); }
 
+    // Keep the perimeters of the layers to be reused after the invalidation of posSlice / posPerimeters.
+    // Only worth the memory when the same objects are processed repeatedly, as by the GUI background processing.
+    void                set_reuse_perimeters(bool reuse) { m_reuse_perimeters = reuse; }
+    bool                reuse_perimeters() const { return m_reuse_perimeters; }
+    // Store the points of the finished perimeters, infill and support with 32 bit coordinates, see ExtrusionPath::compact().
+    // Halves the memory of the toolpaths waiting for the G-code export, at the cost of decoding them at the export and in the preview.
+    // Set it before process().
+    void                set_compact_toolpaths(bool compact) { m_compact_toolpaths = compact; }
+    bool                compact_toolpaths() const { return m_compact_toolpaths; }
+
     bool                has_infinite_skirt() const;
     bool                has_skirt() const;
     float               get_wipe_tower_depth() const { return m_wipe_tower_data.depth; }
@@ -417,6 +487,11 @@ private:
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
 
+    // See set_reuse_perimeters().
+    bool                                    m_reuse_perimeters = false;
+    // See set_compact_toolpaths().
+    bool                                    m_compact_toolpaths = false;
+
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
     // Allow PrintObject to access m_mutex and m_cancel_callback.
@@ -3823,6 +3823,14 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->cli = "slice|s";
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("estimate_time", coBool);
+    def->label = L("Estimate print time");
+    def->tooltip = L("Estimate the print time of the given G-code files without slicing and write the statistics "
+                     "(total time for the normal and silent modes, time per move type and per color change) to the console in JSON format. "
+                     "The machine limits are taken from the configuration.");
+    def->cli = "estimate-time";
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("help", coBool);
     def->label = L("Help");
     def->tooltip = L("Show this help.");
@@ -3969,6 +3977,24 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->label = L("Data directory");
     def->tooltip = L("Load and store settings at the given directory. This is useful for maintaining different profiles or including configurations from a network storage.");
 
+    def = this->add("slice_cache", coString);
+    def->label = L("Slice cache directory");
+    def->tooltip = L("Store the slices of the object meshes at the given directory and reuse them when the same objects "
+                     "are sliced again with the same slicing parameters.");
+
+    def = this->add("slice_cache_size", coInt);
+    def->label = L("Slice cache size");
+    def->tooltip = L("Maximum size of the slice cache directory in megabytes. The least recently used slices are deleted "
+                     "when the limit is exceeded.");
+    def->sidetext = L("MB");
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(1024));
+
+    def = this->add("compact_toolpaths", coBool);
+    def->label = L("Compact toolpaths");
+    def->tooltip = L("Store the finished toolpaths with 32 bit coordinates until the G-code export to lower the memory used by large plates. "
+                     "The toolpaths are decoded at the G-code export, the G-code is not changed.");
+
     def = this->add("loglevel", coInt);
     def->label = L("Logging level");
     def->tooltip = L("Messages with severity lower or eqal to the loglevel will be printed out. 0:trace, 1:debug, 2:info, 3:warning, 4:error, 5:fatal");
@@ -5,9 +5,12 @@
 #include "I18N.hpp"
 #include "SupportMaterial.hpp"
 #include "Surface.hpp"
+#include "SliceCache.hpp"
 #include "Slicing.hpp"
 #include "Utils.hpp"
 
+#include <chrono>
+#include <cstring>
 #include <utility>
 #include <boost/log/trivial.hpp>
 #include <float.h>
@@ -222,17 +225,28 @@ void PrintObject::make_perimeters()
     }
 
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this](const tbb::blocked_range<size_t>& range) {
-            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
-                m_print->throw_if_canceled();
-                m_layers[layer_idx]->make_perimeters();
+    if (m_print->reuse_perimeters()) {
+        this->make_perimeters_cached();
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end, " <<
+            m_perimeters_cache_stats.hits << " layers reused, " << m_perimeters_cache_stats.misses << " layers generated";
+    } else {
+        m_perimeters_cache.clear();
+        m_perimeters_cache_config.clear();
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    m_print->throw_if_canceled();
+                    m_layers[layer_idx]->make_perimeters();
+                }
             }
-        }
-    );
-    m_print->throw_if_canceled();
-    BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
+        );
+        m_print->throw_if_canceled();
+        m_perimeters_cache_stats.hits   = 0;
+        m_perimeters_cache_stats.misses = m_layers.size();
+        BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
+    }
 
     /*
         simplify slices (both layer and region slices),
@@ -244,12 +258,21 @@ void PrintObject::make_perimeters()
     this->set_done(posPerimeters);
 }
 
+// Log the time spent by a step of PrintObject::prepare_infill(), restart the timer for the next step.
+static void log_prepare_infill_step_time(const char *step, std::chrono::steady_clock::time_point &time_start)
+{
+    auto time_end = std::chrono::steady_clock::now();
+    BOOST_LOG_TRIVIAL(debug) << "Preparing infill - " << step << " took " << std::chrono::duration<double>(time_end - time_start).count() << " s";
+    time_start = time_end;
+}
+
 void PrintObject::prepare_infill()
 {
     if (! this->set_started(posPrepareInfill))
         return;
 
     m_print->set_status(30, L("Preparing infill"));
+    auto time_start = std::chrono::steady_clock::now();
 
     // This will assign a type (top/bottom/internal) to $layerm->slices.
     // Then the classifcation of $layerm->slices is transfered onto 
@@ -257,6 +280,7 @@ void PrintObject::prepare_infill()
     // by the cummulative area of the previous $layerm->fill_surfaces.
     this->detect_surfaces_type();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("detect_surfaces_type", time_start);
     
     // Decide what surfaces are to be filled.
     // Here the S_TYPE_TOP / S_TYPE_BOTTOMBRIDGE / S_TYPE_BOTTOM infill is turned to just S_TYPE_INTERNAL if zero top / bottom infill layers are configured.
@@ -267,6 +291,7 @@ void PrintObject::prepare_infill()
             region->prepare_fill_surfaces();
             m_print->throw_if_canceled();
         }
+    log_prepare_infill_step_time("prepare_fill_surfaces", time_start);
 
     // this will detect bridges and reverse bridges
     // and rearrange top/bottom/internal surfaces
@@ -279,10 +304,12 @@ void PrintObject::prepare_infill()
     //FIXME This does not likely merge surfaces, which are supported by a material with different colors, but same properties.
     this->process_external_surfaces();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("process_external_surfaces", time_start);
 
     // Add solid fills to ensure the shell vertical thickness.
     this->discover_vertical_shells();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("discover_vertical_shells", time_start);
 
     // Debugging output.
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
@@ -303,6 +330,7 @@ void PrintObject::prepare_infill()
     //FIXME Vojtech: Is this a good place to add supporting infills below sloping perimeters?
     this->discover_horizontal_shells();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("discover_horizontal_shells", time_start);
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
     for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
@@ -322,6 +350,7 @@ void PrintObject::prepare_infill()
     // Also one wishes the perimeters to be supported by a full infill.
     this->clip_fill_surfaces();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("clip_fill_surfaces", time_start);
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
     for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
@@ -338,6 +367,7 @@ void PrintObject::prepare_infill()
     //if (this->)
     this->bridge_over_infill();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("bridge_over_infill", time_start);
     this->replaceSurfaceType(stPosInternal | stDensSolid,
         stPosInternal | stDensSolid | stModOverBridge,
         stPosInternal | stDensSolid | stModBridge);
@@ -354,15 +384,18 @@ void PrintObject::prepare_infill()
         stPosTop | stDensSolid | stModOverBridge,
         stPosBottom | stDensSolid | stModBridge);
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("replaceSurfaceType", time_start);
 
     // combine fill surfaces to honor the "infill every N layers" option
     this->combine_infill();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("combine_infill", time_start);
 
     // count the distance from the nearest top surface, to allow to use denser infill
     // if needed and if infill_dense_layers is positive.
     this->tag_under_bridge();
     m_print->throw_if_canceled();
+    log_prepare_infill_step_time("tag_under_bridge", time_start);
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
     for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
@@ -387,18 +420,29 @@ void PrintObject::infill()
     this->prepare_infill();
 
     if (this->set_started(posInfill)) {
-        BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start";
+        BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - start" << log_memory_info();
+        // The perimeters and the infill of a layer are final once the layer is filled, release their unused memory
+        // and compact their points if asked for.
+        tbb::atomic<size_t> released;
+        released = 0;
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, m_layers.size()),
-            [this](const tbb::blocked_range<size_t>& range) {
+            [this, &released](const tbb::blocked_range<size_t>& range) {
                 for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
                     m_print->throw_if_canceled();
                     m_layers[layer_idx]->make_fills();
+                    ShrinkToFitEntities shrink(m_print->compact_toolpaths());
+                    for (LayerRegion *layerm : m_layers[layer_idx]->regions()) {
+                        shrink.shrink(layerm->perimeters);
+                        shrink.shrink(layerm->thin_fills);
+                        shrink.shrink(layerm->fills);
+                    }
+                    released += shrink.released;
                 }
             }
         );
         m_print->throw_if_canceled();
-        BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - end";
+        BOOST_LOG_TRIVIAL(debug) << "Filling layers in parallel - end, " << format_memsize_MB(released) << " of unused extrusion memory released" << log_memory_info();
         /*  we could free memory now, but this would make this step not idempotent
         ### $_->fill_surfaces->clear for map @{$_->regions}, @{$object->layers};
         */
@@ -414,6 +458,10 @@ void PrintObject::generate_support_material()
             m_print->set_status(85, L("Generating support material"));    
             this->_generate_support_material();
             m_print->throw_if_canceled();
+            size_t released = 0;
+            for (SupportLayer *layer : m_support_layers)
+                released += ShrinkToFitEntities(m_print->compact_toolpaths()).shrink(layer->support_fills);
+            BOOST_LOG_TRIVIAL(debug) << "Support material generated, " << format_memsize_MB(released) << " of unused extrusion memory released" << log_memory_info();
         } else {
 #if 0
             // Printing without supports. Empty layer means some objects or object parts are levitating,
@@ -425,6 +473,8 @@ void PrintObject::generate_support_material()
         }
         this->set_done(posSupportMaterial);
     }
+    // Release the slicers of the support enforcers / blockers.
+    m_volumes_slicers.clear();
 }
 
 void PrintObject::clear_layers()
@@ -613,6 +663,7 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
         invalidated |= this->invalidate_steps({ posPerimeters, posPrepareInfill, posInfill, posSupportMaterial });
         invalidated |= m_print->invalidate_steps({ psSkirt, psBrim });
         this->m_slicing_params.valid = false;
+        this->m_volumes_slicers.clear();
     } else if (step == posSupportMaterial) {
         invalidated |= m_print->invalidate_steps({ psSkirt, psBrim });
         this->m_slicing_params.valid = false;
@@ -634,6 +685,7 @@ bool PrintObject::invalidate_all_steps()
 	// Then reset some of the depending values.
 	this->m_slicing_params.valid = false;
 	this->region_volumes.clear();
+	this->m_volumes_slicers.clear();
 	return result;
 }
 
@@ -1474,6 +1526,27 @@ void PrintObject::bridge_over_infill()
 {
     BOOST_LOG_TRIVIAL(info) << "Bridge over infill..." << log_memory_info();
 
+    if (std::all_of(this->print()->regions().begin(), this->print()->regions().end(), 
+            [](const PrintRegion *region) { return region->config().fill_density.value == 100; }))
+        // No voids to bridge over.
+        return;
+
+    // Collect the sparse internal surfaces of all regions of each layer. bridge_over_infill() does not modify
+    // the sparse infill, therefore the lower layers may be read while the layers are processed in parallel.
+    BOOST_LOG_TRIVIAL(debug) << "Bridge over infill - collecting the sparse infill in parallel - start";
+    std::vector<Polygons> lower_internal_cache(m_layers.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this, &lower_internal_cache](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                m_print->throw_if_canceled();
+                for (LayerRegion *layerm : m_layers[layer_idx]->m_regions)
+                    layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse, &lower_internal_cache[layer_idx]);
+            }
+        });
+    m_print->throw_if_canceled();
+    BOOST_LOG_TRIVIAL(debug) << "Bridge over infill - collecting the sparse infill in parallel - end";
+
     for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
         const PrintRegion &region = *m_print->regions()[region_id];
         
@@ -1490,110 +1563,109 @@ void PrintObject::bridge_over_infill()
             *this
         );
         
-        for (LayerPtrs::iterator layer_it = m_layers.begin(); layer_it != m_layers.end(); ++ layer_it) {
-            // skip first layer
-            if (layer_it == m_layers.begin())
-                continue;
-            
-            Layer* layer        = *layer_it;
-            LayerRegion* layerm = layer->m_regions[region_id];
-            
-            // extract the stInternalSolid surfaces that might be transformed into bridges
-            Polygons internal_solid;
-            layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSolid, &internal_solid);
-            
-            // check whether the lower area is deep enough for absorbing the extra flow
-            // (for obvious physical reasons but also for preventing the bridge extrudates
-            // from overflowing in 3D preview)
-            ExPolygons to_bridge;
-            {
-                Polygons to_bridge_pp = internal_solid;
-                
-                // iterate through lower layers spanned by bridge_flow
-                double bottom_z = layer->print_z - bridge_flow.height;
-                for (int i = int(layer_it - m_layers.begin()) - 1; i >= 0; --i) {
-                    const Layer* lower_layer = m_layers[i];
-                    
-                    // stop iterating if layer is lower than bottom_z
-                    if (lower_layer->print_z < bottom_z) break;
+        BOOST_LOG_TRIVIAL(debug) << "Bridge over infill for region " << region_id << " in parallel - start";
+        // skip first layer
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(1, std::max<size_t>(m_layers.size(), 1)),
+            [this, region_id, &bridge_flow, &lower_internal_cache](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    m_print->throw_if_canceled();
+                    Layer* layer        = m_layers[layer_idx];
+                    LayerRegion* layerm = layer->m_regions[region_id];
                     
-                    // iterate through regions and collect internal surfaces
-                    Polygons lower_internal;
-                    for (LayerRegion *lower_layerm : lower_layer->m_regions)
-                        lower_layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse, &lower_internal);
+                    // extract the stInternalSolid surfaces that might be transformed into bridges
+                    Polygons internal_solid;
+                    layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSolid, &internal_solid);
                     
-                    // intersect such lower internal surfaces with the candidate solid surfaces
-                    to_bridge_pp = intersection(to_bridge_pp, lower_internal);
-                }
-                
-                // there's no point in bridging too thin/short regions
-                //FIXME Vojtech: The offset2 function is not a geometric offset, 
-                // therefore it may create 1) gaps, and 2) sharp corners, which are outside the original contour.
-                // The gaps will be filled by a separate region, which makes the infill less stable and it takes longer.
-                {
-                    float min_width = float(bridge_flow.scaled_width()) * 3.f;
-                    to_bridge_pp = offset2(to_bridge_pp, -min_width, +min_width);
-                }
-                
-                if (to_bridge_pp.empty()) continue;
-                
-                // convert into ExPolygons
-                to_bridge = union_ex(to_bridge_pp);
-            }
-            
-            #ifdef SLIC3R_DEBUG
-            printf("Bridging " PRINTF_ZU " internal areas at layer " PRINTF_ZU "\n", to_bridge.size(), layer->id());
-            #endif
-            
-            // compute the remaning internal solid surfaces as difference
-            ExPolygons not_to_bridge = diff_ex(internal_solid, to_polygons(to_bridge), true);
-            to_bridge = intersection_ex(to_polygons(to_bridge), internal_solid, true);
-            // build the new collection of fill_surfaces
-            layerm->fill_surfaces.remove_type(stPosInternal | stDensSolid);
-            for (ExPolygon &ex : to_bridge)
-                layerm->fill_surfaces.surfaces.push_back(Surface(stPosInternal | stDensSolid | stModBridge, ex));
-            for (ExPolygon &ex : not_to_bridge)
-                layerm->fill_surfaces.surfaces.push_back(Surface(stPosInternal | stDensSolid, ex));            
-            /*
-            # exclude infill from the layers below if needed
-            # see discussion at https://github.com/alexrj/Slic3r/issues/240
-            # Update: do not exclude any infill. Sparse infill is able to absorb the excess material.
-            if (0) {
-                my $excess = $layerm->extruders->{infill}->bridge_flow->width - $layerm->height;
-                for (my $i = $layer_id-1; $excess >= $self->get_layer($i)->height; $i--) {
-                    Slic3r::debugf "  skipping infill below those areas at layer %d\n", $i;
-                    foreach my $lower_layerm (@{$self->get_layer($i)->regions}) {
-                        my @new_surfaces = ();
-                        # subtract the area from all types of surfaces
-                        foreach my $group (@{$lower_layerm->fill_surfaces->group}) {
-                            push @new_surfaces, map $group->[0]->clone(expolygon => $_),
-                                @{diff_ex(
-                                    [ map $_->p, @$group ],
-                                    [ map @$_, @$to_bridge ],
-                                )};
-                            push @new_surfaces, map Slic3r::Surface->new(
-                                expolygon       => $_,
-                                surface_type    => S_TYPE_INTERNALVOID,
-                            ), @{intersection_ex(
-                                [ map $_->p, @$group ],
-                                [ map @$_, @$to_bridge ],
-                            )};
+                    // check whether the lower area is deep enough for absorbing the extra flow
+                    // (for obvious physical reasons but also for preventing the bridge extrudates
+                    // from overflowing in 3D preview)
+                    ExPolygons to_bridge;
+                    {
+                        Polygons to_bridge_pp = internal_solid;
+                        
+                        // iterate through lower layers spanned by bridge_flow
+                        double bottom_z = layer->print_z - bridge_flow.height;
+                        for (int i = int(layer_idx) - 1; i >= 0; --i) {
+                            const Layer* lower_layer = m_layers[i];
+                            
+                            // stop iterating if layer is lower than bottom_z
+                            if (lower_layer->print_z < bottom_z) break;
+                            
+                            // intersect the lower internal surfaces of all regions with the candidate solid surfaces
+                            to_bridge_pp = intersection(to_bridge_pp, lower_internal_cache[i]);
+                        }
+                        
+                        // there's no point in bridging too thin/short regions
+                        //FIXME Vojtech: The offset2 function is not a geometric offset, 
+                        // therefore it may create 1) gaps, and 2) sharp corners, which are outside the original contour.
+                        // The gaps will be filled by a separate region, which makes the infill less stable and it takes longer.
+                        {
+                            float min_width = float(bridge_flow.scaled_width()) * 3.f;
+                            to_bridge_pp = offset2(to_bridge_pp, -min_width, +min_width);
                         }
-                        $lower_layerm->fill_surfaces->clear;
-                        $lower_layerm->fill_surfaces->append($_) for @new_surfaces;
+                        
+                        if (to_bridge_pp.empty()) continue;
+                        
+                        // convert into ExPolygons
+                        to_bridge = union_ex(to_bridge_pp);
                     }
                     
-                    $excess -= $self->get_layer($i)->height;
-                }
-            }
-            */
+                    #ifdef SLIC3R_DEBUG
+                    printf("Bridging " PRINTF_ZU " internal areas at layer " PRINTF_ZU "\n", to_bridge.size(), layer->id());
+                    #endif
+                    
+                    // compute the remaning internal solid surfaces as difference
+                    ExPolygons not_to_bridge = diff_ex(internal_solid, to_polygons(to_bridge), true);
+                    to_bridge = intersection_ex(to_polygons(to_bridge), internal_solid, true);
+                    // build the new collection of fill_surfaces
+                    layerm->fill_surfaces.remove_type(stPosInternal | stDensSolid);
+                    for (ExPolygon &ex : to_bridge)
+                        layerm->fill_surfaces.surfaces.push_back(Surface(stPosInternal | stDensSolid | stModBridge, ex));
+                    for (ExPolygon &ex : not_to_bridge)
+                        layerm->fill_surfaces.surfaces.push_back(Surface(stPosInternal | stDensSolid, ex));            
+                    /*
+                    # exclude infill from the layers below if needed
+                    # see discussion at https://github.com/alexrj/Slic3r/issues/240
+                    # Update: do not exclude any infill. Sparse infill is able to absorb the excess material.
+                    if (0) {
+                        my $excess = $layerm->extruders->{infill}->bridge_flow->width - $layerm->height;
+                        for (my $i = $layer_id-1; $excess >= $self->get_layer($i)->height; $i--) {
+                            Slic3r::debugf "  skipping infill below those areas at layer %d\n", $i;
+                            foreach my $lower_layerm (@{$self->get_layer($i)->regions}) {
+                                my @new_surfaces = ();
+                                # subtract the area from all types of surfaces
+                                foreach my $group (@{$lower_layerm->fill_surfaces->group}) {
+                                    push @new_surfaces, map $group->[0]->clone(expolygon => $_),
+                                        @{diff_ex(
+                                            [ map $_->p, @$group ],
+                                            [ map @$_, @$to_bridge ],
+                                        )};
+                                    push @new_surfaces, map Slic3r::Surface->new(
+                                        expolygon       => $_,
+                                        surface_type    => S_TYPE_INTERNALVOID,
+                                    ), @{intersection_ex(
+                                        [ map $_->p, @$group ],
+                                        [ map @$_, @$to_bridge ],
+                                    )};
+                                }
+                                $lower_layerm->fill_surfaces->clear;
+                                $lower_layerm->fill_surfaces->append($_) for @new_surfaces;
+                            }
+                    
+                            $excess -= $self->get_layer($i)->height;
+                        }
+                    }
+                    */
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
-            layerm->export_region_slices_to_svg_debug("7_bridge_over_infill");
-            layerm->export_region_fill_surfaces_to_svg_debug("7_bridge_over_infill");
+                    layerm->export_region_slices_to_svg_debug("7_bridge_over_infill");
+                    layerm->export_region_fill_surfaces_to_svg_debug("7_bridge_over_infill");
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
-            m_print->throw_if_canceled();
-        }
+                }
+            });
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Bridge over infill for region " << region_id << " in parallel - end";
     }
 }
 
@@ -1993,6 +2065,8 @@ void PrintObject::_slice(const std::vector<coordf_t> &layer_height_profile)
             BOOST_LOG_TRIVIAL(debug) << "Slicing modifier volumes - stealing " << region_id << " end";
         }
     }
+    // All the region and modifier volumes are sliced, release the composed meshes and their slicers.
+    m_volumes_slicers.clear();
     
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - removing top empty layers";
     while (! m_layers.empty()) {
@@ -2388,71 +2462,107 @@ std::vector<ExPolygons> PrintObject::slice_support_volumes(const ModelVolumeType
     return this->slice_volumes(zs, volumes);
 }
 
+const TriangleMeshSlicer* PrintObject::volumes_slicer(const std::vector<const ModelVolume*> &volumes) const
+{
+    const float closing_radius  = float(m_config.slice_closing_radius.value);
+    const float model_precision = float(m_config.model_precision.value);
+    // Look up the slicer in the cache.
+    for (const std::unique_ptr<VolumesSlicer> &cached : m_volumes_slicers) {
+        bool match = cached->volumes.size() == volumes.size() && cached->trafo.matrix() == m_trafo.matrix() && cached->copies_shift == m_copies_shift &&
+            cached->slicer.closing_radius == closing_radius && cached->slicer.model_precision == model_precision;
+        for (size_t i = 0; match && i < volumes.size(); ++ i)
+            match = cached->volumes[i].first == volumes[i]->mesh_ptr() && cached->volumes[i].second.matrix() == volumes[i]->get_matrix().matrix();
+        if (match)
+            return cached->mesh.empty() ? nullptr : &cached->slicer;
+    }
+
+    std::unique_ptr<VolumesSlicer> out(new VolumesSlicer(closing_radius, model_precision));
+    out->trafo        = m_trafo;
+    out->copies_shift = m_copies_shift;
+    for (const ModelVolume *volume : volumes)
+        out->volumes.emplace_back(volume->mesh_ptr(), volume->get_matrix());
+    // Compose mesh.
+    //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
+    TriangleMesh &mesh = out->mesh;
+    mesh = volumes.front()->mesh();
+    mesh.transform(volumes.front()->get_matrix(), true);
+    if (volumes.size() == 1 && mesh.repaired) {
+        //FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
+        stl_check_facets_exact(&mesh.stl);
+    }
+    for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
+        const ModelVolume &model_volume = *volumes[idx_volume];
+        TriangleMesh vol_mesh(model_volume.mesh());
+        vol_mesh.transform(model_volume.get_matrix(), true);
+        mesh.merge(vol_mesh);
+    }
+    if (mesh.stl.stats.number_of_facets > 0) {
+        mesh.transform(m_trafo, true);
+        // apply XY shift
+        mesh.translate(- unscale<float>(m_copies_shift(0)), - unscale<float>(m_copies_shift(1)), 0);
+        const Print *print = this->print();
+        auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
+        // TriangleMeshSlicer needs shared vertices, also this calls the repair() function.
+        mesh.require_shared_vertices();
+        // Build the edge maps and the Z index of the facets.
+        out->slicer.init(&mesh, callback);
+    } else
+        mesh.clear();
+    m_volumes_slicers.emplace_back(std::move(out));
+    const VolumesSlicer &cached = *m_volumes_slicers.back();
+    return cached.mesh.empty() ? nullptr : &cached.slicer;
+}
+
+// Key of the slices of the volumes at the z levels in the SliceCache: the meshes, the transformations and the slicing parameters.
+std::string PrintObject::slice_cache_key(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes) const
+{
+    SliceCache::Key key;
+    key.append(z);
+    key.append(volumes.size());
+    for (const ModelVolume *volume : volumes) {
+        const stl_file &stl = volume->mesh().stl;
+        key.append(stl.facet_start.size());
+        for (const stl_facet &facet : stl.facet_start)
+            key.append(facet.vertex, sizeof(facet.vertex));
+        key.append(volume->mesh().repaired);
+        key.append(volume->get_matrix().matrix());
+    }
+    key.append(m_trafo.matrix());
+    key.append(m_copies_shift);
+    key.append(float(m_config.slice_closing_radius.value));
+    key.append(float(m_config.model_precision.value));
+    return key.digest();
+}
+
 std::vector<ExPolygons> PrintObject::slice_volumes(const std::vector<float> &z, const std::vector<const ModelVolume*> &volumes) const
 {
     std::vector<ExPolygons> layers;
     if (! volumes.empty()) {
-        // Compose mesh.
-        //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-		TriangleMesh mesh(volumes.front()->mesh());
-        mesh.transform(volumes.front()->get_matrix(), true);
-		assert(mesh.repaired);
-		if (volumes.size() == 1 && mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-        for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
-            const ModelVolume &model_volume = *volumes[idx_volume];
-            TriangleMesh vol_mesh(model_volume.mesh());
-            vol_mesh.transform(model_volume.get_matrix(), true);
-            mesh.merge(vol_mesh);
+        std::string cache_key;
+        if (SliceCache::enabled()) {
+            cache_key = this->slice_cache_key(z, volumes);
+            if (SliceCache::load(cache_key, layers)) {
+                BOOST_LOG_TRIVIAL(debug) << "Slices of " << volumes.size() << " volumes loaded from the slice cache";
+                return layers;
+            }
         }
-        if (mesh.stl.stats.number_of_facets > 0) {
-            mesh.transform(m_trafo, true);
-            // apply XY shift
-            mesh.translate(- unscale<float>(m_copies_shift(0)), - unscale<float>(m_copies_shift(1)), 0);
+        if (const TriangleMeshSlicer *mslicer = this->volumes_slicer(volumes)) {
             // perform actual slicing
             const Print *print = this->print();
             auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
-            // TriangleMeshSlicer needs shared vertices, also this calls the repair() function.
-            mesh.require_shared_vertices();
-            TriangleMeshSlicer mslicer(float(m_config.slice_closing_radius.value), float(m_config.model_precision.value));
-            mslicer.init(&mesh, callback);
-            mslicer.slice(z, &layers, callback);
+            mslicer->slice(z, &layers, callback);
             m_print->throw_if_canceled();
         }
+        if (! cache_key.empty())
+            SliceCache::store(cache_key, layers);
     }
     return layers;
 }
 
 std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float> &z, const ModelVolume &volume) const
 {
-    std::vector<ExPolygons> layers;
-    if (! z.empty()) {
-	    // Compose mesh.
-	    //FIXME better to split the mesh into separate shells, perform slicing over each shell separately and then to use a Boolean operation to merge them.
-	    TriangleMesh mesh(volume.mesh());
-	    mesh.transform(volume.get_matrix(), true);
-		if (mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-	    if (mesh.stl.stats.number_of_facets > 0) {
-	        mesh.transform(m_trafo, true);
-	        // apply XY shift
-	        mesh.translate(- unscale<float>(m_copies_shift(0)), - unscale<float>(m_copies_shift(1)), 0);
-	        // perform actual slicing
-	        TriangleMeshSlicer mslicer(float(m_config.slice_closing_radius.value), float(m_config.model_precision.value));
-	        const Print *print = this->print();
-	        auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
-	        // TriangleMeshSlicer needs the shared vertices.
-	        mesh.require_shared_vertices();
-	        mslicer.init(&mesh, callback);
-	        mslicer.slice(z, &layers, callback);
-	        m_print->throw_if_canceled();
-	    }
-	}
-    return layers;
+    //FIXME better to split the mesh into separate shells, perform slicing over each shell separately and then to use a Boolean operation to merge them.
+    return z.empty() ? std::vector<ExPolygons>() : this->slice_volumes(z, std::vector<const ModelVolume*>{ &volume });
 }
 
 // Filter the zs not inside the ranges. The ranges are closed at the botton and open at the top, they are sorted lexicographically and non overlapping.
@@ -2593,6 +2703,213 @@ void PrintObject::_simplify_slices(double distance)
     BOOST_LOG_TRIVIAL(debug) << "Slicing objects - siplifying slices in parallel - end";
 }
 
+// Hashing and comparison of the inputs of Layer::make_perimeters(), see PrintObject::make_perimeters_cached().
+static inline void perimeters_hash_mix(uint64_t &seed, uint64_t value)
+{
+    // boost::hash_combine() extended to 64 bits.
+    seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 12) + (seed >> 4);
+}
+
+static inline void perimeters_hash_double(uint64_t &seed, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    perimeters_hash_mix(seed, bits);
+}
+
+static void perimeters_hash_polygon(uint64_t &seed, const Polygon &polygon)
+{
+    perimeters_hash_mix(seed, polygon.points.size());
+    for (const Point &pt : polygon.points) {
+        perimeters_hash_mix(seed, uint64_t(pt(0)));
+        perimeters_hash_mix(seed, uint64_t(pt(1)));
+    }
+}
+
+static void perimeters_hash_expolygon(uint64_t &seed, const ExPolygon &expolygon)
+{
+    perimeters_hash_polygon(seed, expolygon.contour);
+    perimeters_hash_mix(seed, expolygon.holes.size());
+    for (const Polygon &hole : expolygon.holes)
+        perimeters_hash_polygon(seed, hole);
+}
+
+static void perimeters_hash_expolygons(uint64_t &seed, const ExPolygons &expolygons)
+{
+    perimeters_hash_mix(seed, expolygons.size());
+    for (const ExPolygon &expolygon : expolygons)
+        perimeters_hash_expolygon(seed, expolygon);
+}
+
+// Hash of the layer id and height, of the slices of the layer and of the slices of its regions.
+// The slices of the neighbor layers are accounted for by the hashes of the neighbor layers.
+static uint64_t layer_perimeters_inputs_hash(const Layer &layer)
+{
+    uint64_t seed = 0;
+    perimeters_hash_mix(seed, layer.id());
+    perimeters_hash_double(seed, layer.height);
+    perimeters_hash_mix(seed, layer.lower_layer != nullptr);
+    perimeters_hash_mix(seed, layer.upper_layer != nullptr);
+    perimeters_hash_expolygons(seed, layer.slices.expolygons);
+    perimeters_hash_mix(seed, layer.regions().size());
+    for (const LayerRegion *layerm : layer.regions()) {
+        perimeters_hash_mix(seed, layerm->slices.surfaces.size());
+        for (const Surface &surface : layerm->slices.surfaces) {
+            perimeters_hash_mix(seed, surface.surface_type);
+            perimeters_hash_mix(seed, surface.extra_perimeters);
+            perimeters_hash_mix(seed, surface.thickness_layers);
+            perimeters_hash_mix(seed, surface.maxNbSolidLayersOnTop);
+            perimeters_hash_double(seed, surface.thickness);
+            perimeters_hash_double(seed, surface.bridge_angle);
+            perimeters_hash_expolygon(seed, surface.expolygon);
+        }
+    }
+    return seed;
+}
+
+static bool perimeters_expolygon_equal(const ExPolygon &expoly1, const ExPolygon &expoly2)
+{
+    if (expoly1.holes.size() != expoly2.holes.size() || expoly1.contour.points != expoly2.contour.points)
+        return false;
+    for (size_t i = 0; i < expoly1.holes.size(); ++ i)
+        if (expoly1.holes[i].points != expoly2.holes[i].points)
+            return false;
+    return true;
+}
+
+static bool perimeters_expolygons_equal(const ExPolygons &expolygons1, const ExPolygons &expolygons2)
+{
+    if (expolygons1.size() != expolygons2.size())
+        return false;
+    for (size_t i = 0; i < expolygons1.size(); ++ i)
+        if (! perimeters_expolygon_equal(expolygons1[i], expolygons2[i]))
+            return false;
+    return true;
+}
+
+static bool perimeters_surfaces_equal(const Surfaces &surfaces1, const Surfaces &surfaces2)
+{
+    if (surfaces1.size() != surfaces2.size())
+        return false;
+    for (size_t i = 0; i < surfaces1.size(); ++ i) {
+        const Surface &s1 = surfaces1[i];
+        const Surface &s2 = surfaces2[i];
+        if (s1.surface_type != s2.surface_type || s1.extra_perimeters != s2.extra_perimeters || 
+            s1.thickness_layers != s2.thickness_layers || s1.maxNbSolidLayersOnTop != s2.maxNbSolidLayersOnTop ||
+            s1.thickness != s2.thickness || s1.bridge_angle != s2.bridge_angle ||
+            ! perimeters_expolygon_equal(s1.expolygon, s2.expolygon))
+            return false;
+    }
+    return true;
+}
+
+// Configuration options read by Layer::make_perimeters() and by the PerimeterGenerator, including the options
+// of the flows the generator is fed with. The perimeters cache is dropped if any of them changes.
+static const t_config_option_keys perimeters_print_options  = { "brim_width", "first_layer_extrusion_width", "nozzle_diameter" };
+static const t_config_option_keys perimeters_object_options = { "extrusion_width", "seam_position", "support_material", "support_material_contact_distance_type" };
+static const t_config_option_keys perimeters_region_options = {
+    "bridge_angle", "bridge_flow_ratio", "external_perimeter_extrusion_width", "external_perimeter_speed", "external_perimeters_first",
+    "extra_perimeters", "fill_density", "gap_fill", "gap_fill_speed", "infill_overlap", "no_perimeter_unsupported_algo",
+    "only_one_perimeter_top", "overhangs", "perimeter_extruder", "perimeter_extrusion_width", "perimeter_loop", "perimeter_loop_seam",
+    "perimeter_speed", "perimeters", "solid_infill_extruder", "solid_infill_extrusion_width", "thin_walls", "thin_walls_min_width",
+    "thin_walls_overlap"
+};
+
+static void perimeters_serialize_options(std::string &out, const ConfigBase &config, const t_config_option_keys &keys)
+{
+    for (const std::string &key : keys) {
+        out += key;
+        out += '=';
+        out += config.opt_serialize(key);
+        out += '\n';
+    }
+}
+
+void PrintObject::make_perimeters_cached()
+{
+    std::string config;
+    perimeters_serialize_options(config, m_print->config(), perimeters_print_options);
+    perimeters_serialize_options(config, m_config, perimeters_object_options);
+    for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id)
+        perimeters_serialize_options(config, m_print->regions()[region_id]->config(), perimeters_region_options);
+    if (config != m_perimeters_cache_config) {
+        // None of the cached perimeters can be reused.
+        m_perimeters_cache.clear();
+        m_perimeters_cache_config = std::move(config);
+    }
+    m_perimeters_cache.resize(m_layers.size());
+
+    // 1) Find the layers, whose own inputs did not change.
+    std::vector<uint64_t>      inputs_hashes(m_layers.size(), 0);
+    std::vector<unsigned char> unchanged(m_layers.size(), false);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this, &inputs_hashes, &unchanged](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                m_print->throw_if_canceled();
+                const Layer                     &layer  = *m_layers[layer_idx];
+                const LayerPerimetersCacheEntry &cached = m_perimeters_cache[layer_idx];
+                inputs_hashes[layer_idx] = layer_perimeters_inputs_hash(layer);
+                // Compare the inputs themselves, the hash only rejects the changed layers early.
+                bool equal = cached.inputs_hash == inputs_hashes[layer_idx] && cached.layer_id == layer.id() && cached.height == layer.height &&
+                    cached.has_lower_layer == (layer.lower_layer != nullptr) && cached.has_upper_layer == (layer.upper_layer != nullptr) &&
+                    cached.regions.size() == layer.regions().size() && perimeters_expolygons_equal(cached.slices, layer.slices.expolygons);
+                for (size_t region_id = 0; equal && region_id < layer.regions().size(); ++ region_id)
+                    equal = perimeters_surfaces_equal(cached.regions[region_id].slices, layer.regions()[region_id]->slices.surfaces);
+                unchanged[layer_idx] = equal;
+            }
+        }
+    );
+
+    // 2) Reuse the perimeters of the layers, which did not change together with their neighbors, generate the others.
+    tbb::atomic<size_t> num_hits;
+    num_hits = 0;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this, &inputs_hashes, &unchanged, &num_hits](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                m_print->throw_if_canceled();
+                Layer                     &layer  = *m_layers[layer_idx];
+                LayerPerimetersCacheEntry &cached = m_perimeters_cache[layer_idx];
+                if (unchanged[layer_idx] && (layer_idx == 0 || unchanged[layer_idx - 1]) && (layer_idx + 1 == m_layers.size() || unchanged[layer_idx + 1])) {
+                    for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
+                        LayerRegion                 &layerm = *layer.regions()[region_id];
+                        const LayerRegionPerimeters &src    = cached.regions[region_id];
+                        layerm.perimeters                 = src.perimeters;
+                        layerm.thin_fills                 = src.thin_fills;
+                        layerm.fill_surfaces              = src.fill_surfaces;
+                        layerm.fill_expolygons            = src.fill_expolygons;
+                        layerm.fill_no_overlap_expolygons = src.fill_no_overlap_expolygons;
+                    }
+                    ++ num_hits;
+                } else {
+                    layer.make_perimeters();
+                    // Keep a copy of the inputs and outputs, the slices and the fill surfaces are modified by the following steps.
+                    cached.inputs_hash     = inputs_hashes[layer_idx];
+                    cached.layer_id        = layer.id();
+                    cached.height          = layer.height;
+                    cached.has_lower_layer = layer.lower_layer != nullptr;
+                    cached.has_upper_layer = layer.upper_layer != nullptr;
+                    cached.slices          = layer.slices.expolygons;
+                    cached.regions.assign(layer.regions().size(), LayerRegionPerimeters());
+                    for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
+                        const LayerRegion     &layerm = *layer.regions()[region_id];
+                        LayerRegionPerimeters &dst    = cached.regions[region_id];
+                        dst.slices                     = layerm.slices.surfaces;
+                        dst.perimeters                 = layerm.perimeters;
+                        dst.thin_fills                 = layerm.thin_fills;
+                        dst.fill_surfaces              = layerm.fill_surfaces;
+                        dst.fill_expolygons            = layerm.fill_expolygons;
+                        dst.fill_no_overlap_expolygons = layerm.fill_no_overlap_expolygons;
+                    }
+                }
+            }
+        }
+    );
+    m_perimeters_cache_stats.hits   = num_hits;
+    m_perimeters_cache_stats.misses = m_layers.size() - m_perimeters_cache_stats.hits;
+}
+
 void PrintObject::_make_perimeters()
 {
     if (! this->set_started(posPerimeters))
@@ -2711,55 +3028,90 @@ void PrintObject::clip_fill_surfaces()
             [](const PrintRegion *region) { return region->config().fill_density > 0; }))
         return;
 
+    // Collect the layer data not modified by the propagation of the internal infill below, in parallel.
+    // The propagation modifies the sparse and void internal surfaces of the layer below the layer being processed,
+    // therefore the solid surfaces of all layers are collected here, while the fill surfaces and the internal surfaces
+    // are collected before they are trimmed by the propagation.
+    struct ClipFillSurfacesCacheEntry
+    {
+        // Cummulative slices.
+        Polygons    slices;
+        // Solid surfaces to be supported.
+        Polygons    overhangs;
+        // Cummulative fill surfaces before the propagation.
+        Polygons    fill_surfaces;
+        // Internal sparse and void surfaces before the propagation.
+        Polygons    internal_surfaces;
+        // Minimum perimeter width of the layer regions.
+        float       perimeter_width;
+    };
+    BOOST_LOG_TRIVIAL(debug) << "Clipping the fill surfaces - collecting the surfaces in parallel - start";
+    std::vector<ClipFillSurfacesCacheEntry> cache(m_layers.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this, &cache](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                m_print->throw_if_canceled();
+                const Layer                &layer = *m_layers[layer_id];
+                ClipFillSurfacesCacheEntry &entry = cache[layer_id];
+                for (const ExPolygon &expoly : layer.slices.expolygons)
+                    polygons_append(entry.slices, to_polygons(expoly));
+                entry.perimeter_width = FLT_MAX;
+                for (const LayerRegion *layerm : layer.m_regions) {
+                    for (const Surface &surface : layerm->fill_surfaces.surfaces) {
+                        Polygons polygons = to_polygons(surface.expolygon);
+                        if (surface.has_fill_solid())
+                            polygons_append(entry.overhangs, polygons);
+                        if (surface.has_pos_internal() && (surface.has_fill_sparse() || surface.has_fill_void()) )
+                            polygons_append(entry.internal_surfaces, polygons);
+                        polygons_append(entry.fill_surfaces, std::move(polygons));
+                    }
+                    entry.perimeter_width = std::min(entry.perimeter_width, (float)layerm->flow(frPerimeter).scaled_width());
+                }
+            }
+        });
+    m_print->throw_if_canceled();
+    BOOST_LOG_TRIVIAL(debug) << "Clipping the fill surfaces - collecting the surfaces in parallel - end";
+
     // We only want infill under ceilings; this is almost like an
     // internal support material.
     // Proceed top-down, skipping the bottom layer.
+    // Each step depends on the internal infill propagated from the layers above, therefore the layers are processed serially.
     Polygons upper_internal;
     for (int layer_id = int(m_layers.size()) - 1; layer_id > 0; -- layer_id) {
         Layer *layer       = m_layers[layer_id];
         Layer *lower_layer = m_layers[layer_id - 1];
+        ClipFillSurfacesCacheEntry &entry       = cache[layer_id];
+        ClipFillSurfacesCacheEntry &lower_entry = cache[layer_id - 1];
         // Detect things that we need to support.
-        // Cummulative slices.
-        Polygons slices;
-        for (const ExPolygon &expoly : layer->slices.expolygons)
-            polygons_append(slices, to_polygons(expoly));
-        // Cummulative fill surfaces.
+        // Cummulative fill surfaces. The internal surfaces of this layer were modified by the previous step,
+        // except for the top most layer.
         Polygons fill_surfaces;
+        if (layer_id + 1 == int(m_layers.size()))
+            fill_surfaces = std::move(entry.fill_surfaces);
+        else
+            for (const LayerRegion *layerm : layer->m_regions)
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    polygons_append(fill_surfaces, to_polygons(surface.expolygon));
         // Solid surfaces to be supported.
-        Polygons overhangs;
-        for (const LayerRegion *layerm : layer->m_regions)
-            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
-                Polygons polygons = to_polygons(surface.expolygon);
-                if (surface.has_fill_solid())
-                    polygons_append(overhangs, polygons);
-                polygons_append(fill_surfaces, std::move(polygons));
-            }
-        Polygons lower_layer_fill_surfaces;
-        Polygons lower_layer_internal_surfaces;
-        for (const LayerRegion *layerm : lower_layer->m_regions)
-            for (const Surface &surface : layerm->fill_surfaces.surfaces) {
-                Polygons polygons = to_polygons(surface.expolygon);
-                if (surface.has_pos_internal() && (surface.has_fill_sparse() || surface.has_fill_void()) )
-                    polygons_append(lower_layer_internal_surfaces, polygons);
-                polygons_append(lower_layer_fill_surfaces, std::move(polygons));
-            }
+        Polygons overhangs = std::move(entry.overhangs);
         // We also need to support perimeters when there's at least one full unsupported loop
         {
             // Get perimeters area as the difference between slices and fill_surfaces
             // Only consider the area that is not supported by lower perimeters
-            Polygons perimeters = intersection(diff(slices, fill_surfaces), lower_layer_fill_surfaces);
+            Polygons perimeters = intersection(diff(entry.slices, fill_surfaces), lower_entry.fill_surfaces);
             // Only consider perimeter areas that are at least one extrusion width thick.
             //FIXME Offset2 eats out from both sides, while the perimeters are create outside in.
             //Should the pw not be half of the current value?
-            float pw = FLT_MAX;
-            for (const LayerRegion *layerm : layer->m_regions)
-                pw = std::min(pw, (float)layerm->flow(frPerimeter).scaled_width());
+            float pw = entry.perimeter_width;
             // Append such thick perimeters to the areas that need support
             polygons_append(overhangs, offset2(perimeters, -pw, +pw));
         }
         // Find new internal infill.
         polygons_append(overhangs, std::move(upper_internal));
-        upper_internal = intersection(overhangs, lower_layer_internal_surfaces);
+        upper_internal = intersection(overhangs, lower_entry.internal_surfaces);
+        // Release the memory of the layer data, which will not be used anymore.
+        entry = ClipFillSurfacesCacheEntry();
         // Apply new internal infill to regions.
         for (LayerRegion *layerm : lower_layer->m_regions) {
             if (layerm->region()->config().fill_density.value == 0)
@@ -2787,190 +3139,217 @@ void PrintObject::discover_horizontal_shells()
 {
     BOOST_LOG_TRIVIAL(trace) << "discover_horizontal_shells()";
     
+    // The regions are processed in parallel, a region only reads and modifies its own LayerRegions.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, this->region_volumes.size()),
+        [this](const tbb::blocked_range<size_t>& range) {
+            for (size_t region_id = range.begin(); region_id < range.end(); ++ region_id)
+                this->discover_horizontal_shells(region_id);
+        });
+    m_print->throw_if_canceled();
+
+#ifdef SLIC3R_DEBUG_SLICE_PROCESSING
     for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
-        for (size_t i = 0; i < m_layers.size(); ++ i) {
-            m_print->throw_if_canceled();
-            LayerRegion             *layerm = m_layers[i]->regions()[region_id];
-            const PrintRegionConfig &region_config = layerm->region()->config();
-            if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
-                (i % region_config.solid_infill_every_layers) == 0) {
-                // Insert a solid internal layer. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
-                SurfaceType type = (region_config.fill_density == 100) ? (stPosInternal | stDensSolid) : (stPosInternal | stDensSolid | stModBridge);
-                for (Surface &surface : layerm->fill_surfaces.surfaces)
-                    if (surface.surface_type == (stPosInternal | stDensSparse))
-                        surface.surface_type = type;
-            }
+        for (const Layer *layer : m_layers) {
+            const LayerRegion *layerm = layer->m_regions[region_id];
+            layerm->export_region_slices_to_svg_debug("5_discover_horizontal_shells");
+            layerm->export_region_fill_surfaces_to_svg_debug("5_discover_horizontal_shells");
+        } // for each layer
+    } // for each region
+#endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
+}
 
-            // If ensure_vertical_shell_thickness, then the rest has already been performed by discover_vertical_shells().
-            if (region_config.ensure_vertical_shell_thickness.value)
+void PrintObject::discover_horizontal_shells(size_t region_id)
+{
+    const PrintRegionConfig &region_config = m_print->get_region(region_id)->config();
+
+    // Insert a solid internal layer every solid_infill_every_layers. Mark stInternal surfaces as stInternalSolid or stInternalBridge.
+    auto apply_solid_infill_every_layers = [this, region_id, &region_config](size_t i) {
+        if (region_config.solid_infill_every_layers.value > 0 && region_config.fill_density.value > 0 &&
+            (i % region_config.solid_infill_every_layers) == 0) {
+            SurfaceType type = (region_config.fill_density == 100) ? (stPosInternal | stDensSolid) : (stPosInternal | stDensSolid | stModBridge);
+            for (Surface &surface : m_layers[i]->regions()[region_id]->fill_surfaces.surfaces)
+                if (surface.surface_type == (stPosInternal | stDensSparse))
+                    surface.surface_type = type;
+        }
+    };
+
+    if (region_config.ensure_vertical_shell_thickness.value) {
+        // The shells have already been added by discover_vertical_shells(). Only the solid infill every N layers is applied here,
+        // which modifies a single layer, therefore the layers are processed in parallel.
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &apply_solid_infill_every_layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    m_print->throw_if_canceled();
+                    apply_solid_infill_every_layers(i);
+                }
+            });
+        return;
+    }
+
+    // The shells are propagated from a layer to its neighbors, each step reads the neighbor surfaces modified by the previous steps,
+    // therefore the layers of a region are processed serially.
+    for (size_t i = 0; i < m_layers.size(); ++ i) {
+        m_print->throw_if_canceled();
+        LayerRegion *layerm = m_layers[i]->regions()[region_id];
+        apply_solid_infill_every_layers(i);
+
+        for (size_t idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
+            m_print->throw_if_canceled();
+            SurfaceType type = (idx_surface_type == 0) ? (stPosTop | stDensSolid) : 
+                ( (idx_surface_type == 1) ? (stPosBottom | stDensSolid) : (stPosBottom | stDensSolid |stModBridge));
+            // Find slices of current type for current layer.
+            // Use slices instead of fill_surfaces, because they also include the perimeter area,
+            // which needs to be propagated in shells; we need to grow slices like we did for
+            // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
+            // not work in some situations, as there won't be any grown region in the perimeter 
+            // area (this was seen in a model where the top layer had one extra perimeter, thus
+            // its fill_surfaces were thinner than the lower layer's infill), however it's the best
+            // solution so far. Growing the external slices by external_infill_margin will put
+            // too much solid infill inside nearly-vertical slopes.
+
+            // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
+            // (not covered by a layer above / below).
+            // This does not contain the areas covered by perimeters!
+            Polygons solid;
+            for (const Surface &surface : layerm->slices.surfaces)
+                if (surface.surface_type == type)
+                    polygons_append(solid, to_polygons(surface.expolygon));
+            // Infill areas (slices without the perimeters).
+            for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == type)
+                    polygons_append(solid, to_polygons(surface.expolygon));
+            if (solid.empty())
                 continue;
+//                Slic3r::debugf "Layer %d has %s surfaces\n", $i, ($type == S_TYPE_TOP) ? 'top' : 'bottom';
             
-            for (size_t idx_surface_type = 0; idx_surface_type < 3; ++ idx_surface_type) {
-                m_print->throw_if_canceled();
-                SurfaceType type = (idx_surface_type == 0) ? (stPosTop | stDensSolid) : 
-                    ( (idx_surface_type == 1) ? (stPosBottom | stDensSolid) : (stPosBottom | stDensSolid |stModBridge));
-                // Find slices of current type for current layer.
-                // Use slices instead of fill_surfaces, because they also include the perimeter area,
-                // which needs to be propagated in shells; we need to grow slices like we did for
-                // fill_surfaces though. Using both ungrown slices and grown fill_surfaces will
-                // not work in some situations, as there won't be any grown region in the perimeter 
-                // area (this was seen in a model where the top layer had one extra perimeter, thus
-                // its fill_surfaces were thinner than the lower layer's infill), however it's the best
-                // solution so far. Growing the external slices by external_infill_margin will put
-                // too much solid infill inside nearly-vertical slopes.
-
-                // Surfaces including the area of perimeters. Everything, that is visible from the top / bottom
-                // (not covered by a layer above / below).
-                // This does not contain the areas covered by perimeters!
-                Polygons solid;
-                for (const Surface &surface : layerm->slices.surfaces)
-                    if (surface.surface_type == type)
-                        polygons_append(solid, to_polygons(surface.expolygon));
-                // Infill areas (slices without the perimeters).
-                for (const Surface &surface : layerm->fill_surfaces.surfaces)
-                    if (surface.surface_type == type)
-                        polygons_append(solid, to_polygons(surface.expolygon));
-                if (solid.empty())
+            size_t solid_layers = ((type & stPosTop) == stPosTop) ? region_config.top_solid_layers.value : region_config.bottom_solid_layers.value;                
+            for (int n = ((type & stPosTop) == stPosTop) ? (i - 1) : (i + 1); std::abs(n - (int)i) < solid_layers; ((type & stPosTop) == stPosTop) ? (--n) : (++n)) {
+                if (n < 0 || n >= int(m_layers.size()))
                     continue;
-//                Slic3r::debugf "Layer %d has %s surfaces\n", $i, ($type == S_TYPE_TOP) ? 'top' : 'bottom';
+//                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;                  
+                // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
+                LayerRegion *neighbor_layerm = m_layers[n]->regions()[region_id];
                 
-                size_t solid_layers = ((type & stPosTop) == stPosTop) ? region_config.top_solid_layers.value : region_config.bottom_solid_layers.value;                
-                for (int n = ((type & stPosTop) == stPosTop) ? (i - 1) : (i + 1); std::abs(n - (int)i) < solid_layers; ((type & stPosTop) == stPosTop) ? (--n) : (++n)) {
-                    if (n < 0 || n >= int(m_layers.size()))
+                // find intersection between neighbor and current layer's surfaces
+                // intersections have contours and holes
+                // we update $solid so that we limit the next neighbor layer to the areas that were
+                // found on this one - in other words, solid shells on one layer (for a given external surface)
+                // are always a subset of the shells found on the previous shell layer
+                // this approach allows for DWIM in hollow sloping vases, where we want bottom
+                // shells to be generated in the base but not in the walls (where there are many
+                // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
+                // upper perimeter as an obstacle and shell will not be propagated to more upper layers
+                //FIXME How does it work for S_TYPE_INTERNALBRIDGE? This is set for sparse infill. Likely this does not work.
+                Polygons new_internal_solid;
+                {
+                    Polygons internal;
+                    for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
+                        if (surface.has_pos_internal() &&(surface.has_fill_sparse() || surface.has_fill_solid()))
+                            polygons_append(internal, to_polygons(surface.expolygon));
+                    new_internal_solid = intersection(solid, internal, true);
+                }
+                if (new_internal_solid.empty()) {
+                    // No internal solid needed on this layer. In order to decide whether to continue
+                    // searching on the next neighbor (thus enforcing the configured number of solid
+                    // layers, use different strategies according to configured infill density:
+                    if (region_config.fill_density.value == 0) {
+                        // If user expects the object to be void (for example a hollow sloping vase),
+                        // don't continue the search. In this case, we only generate the external solid
+                        // shell if the object would otherwise show a hole (gap between perimeters of 
+                        // the two layers), and internal solid shells are a subset of the shells found 
+                        // on each previous layer.
+                        goto EXTERNAL;
+                    } else {
+                        // If we have internal infill, we can generate internal solid shells freely.
                         continue;
-//                    Slic3r::debugf "  looking for neighbors on layer %d...\n", $n;                  
-                    // Reference to the lower layer of a TOP surface, or an upper layer of a BOTTOM surface.
-                    LayerRegion *neighbor_layerm = m_layers[n]->regions()[region_id];
-                    
-                    // find intersection between neighbor and current layer's surfaces
-                    // intersections have contours and holes
-                    // we update $solid so that we limit the next neighbor layer to the areas that were
-                    // found on this one - in other words, solid shells on one layer (for a given external surface)
-                    // are always a subset of the shells found on the previous shell layer
-                    // this approach allows for DWIM in hollow sloping vases, where we want bottom
-                    // shells to be generated in the base but not in the walls (where there are many
-                    // narrow bottom surfaces): reassigning $solid will consider the 'shadow' of the 
-                    // upper perimeter as an obstacle and shell will not be propagated to more upper layers
-                    //FIXME How does it work for S_TYPE_INTERNALBRIDGE? This is set for sparse infill. Likely this does not work.
-                    Polygons new_internal_solid;
-                    {
+                    }
+                }
+                
+                if (region_config.fill_density.value == 0) {
+                    // if we're printing a hollow object we discard any solid shell thinner
+                    // than a perimeter width, since it's probably just crossing a sloping wall
+                    // and it's not wanted in a hollow print even if it would make sense when
+                    // obeying the solid shell count option strictly (DWIM!)
+                    float margin = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width());
+                    Polygons too_narrow = diff(
+                        new_internal_solid, 
+                        offset2(new_internal_solid, -margin, +margin, jtMiter, 5), 
+                        true);
+                    // Trim the regularized region by the original region.
+                    if (! too_narrow.empty())
+                        new_internal_solid = solid = diff(new_internal_solid, too_narrow);
+                }
+
+                // make sure the new internal solid is wide enough, as it might get collapsed
+                // when spacing is added in Fill.pm
+                {
+                    //FIXME Vojtech: Disable this and you will be sorry.
+                    // https://github.com/prusa3d/PrusaSlicer/issues/26 bottom
+                    float margin = 3.f * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
+                    // we use a higher miterLimit here to handle areas with acute angles
+                    // in those cases, the default miterLimit would cut the corner and we'd
+                    // get a triangle in $too_narrow; if we grow it below then the shell
+                    // would have a different shape from the external surface and we'd still
+                    // have the same angle, so the next shell would be grown even more and so on.
+                    Polygons too_narrow = diff(
+                        new_internal_solid,
+                        offset2(new_internal_solid, -margin, +margin, ClipperLib::jtMiter, 5),
+                        true);
+                    if (! too_narrow.empty()) {
+                        // grow the collapsing parts and add the extra area to  the neighbor layer 
+                        // as well as to our original surfaces so that we support this 
+                        // additional area in the next shell too
+                        // make sure our grown surfaces don't exceed the fill area
                         Polygons internal;
                         for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
-                            if (surface.has_pos_internal() &&(surface.has_fill_sparse() || surface.has_fill_solid()))
+                            if (surface.has_pos_internal() && !surface.has_mod_bridge())
                                 polygons_append(internal, to_polygons(surface.expolygon));
-                        new_internal_solid = intersection(solid, internal, true);
-                    }
-                    if (new_internal_solid.empty()) {
-                        // No internal solid needed on this layer. In order to decide whether to continue
-                        // searching on the next neighbor (thus enforcing the configured number of solid
-                        // layers, use different strategies according to configured infill density:
-                        if (region_config.fill_density.value == 0) {
-                            // If user expects the object to be void (for example a hollow sloping vase),
-                            // don't continue the search. In this case, we only generate the external solid
-                            // shell if the object would otherwise show a hole (gap between perimeters of 
-                            // the two layers), and internal solid shells are a subset of the shells found 
-                            // on each previous layer.
-                            goto EXTERNAL;
-                        } else {
-                            // If we have internal infill, we can generate internal solid shells freely.
-                            continue;
-                        }
+                        polygons_append(new_internal_solid, 
+                            intersection(
+                                offset(too_narrow, +margin),
+                                // Discard bridges as they are grown for anchoring and we can't
+                                // remove such anchors. (This may happen when a bridge is being 
+                                // anchored onto a wall where little space remains after the bridge
+                                // is grown, and that little space is an internal solid shell so 
+                                // it triggers this too_narrow logic.)
+                                internal));
+                        solid = new_internal_solid;
                     }
-                    
-                    if (region_config.fill_density.value == 0) {
-                        // if we're printing a hollow object we discard any solid shell thinner
-                        // than a perimeter width, since it's probably just crossing a sloping wall
-                        // and it's not wanted in a hollow print even if it would make sense when
-                        // obeying the solid shell count option strictly (DWIM!)
-                        float margin = float(neighbor_layerm->flow(frExternalPerimeter).scaled_width());
-                        Polygons too_narrow = diff(
-                            new_internal_solid, 
-                            offset2(new_internal_solid, -margin, +margin, jtMiter, 5), 
-                            true);
-                        // Trim the regularized region by the original region.
-                        if (! too_narrow.empty())
-                            new_internal_solid = solid = diff(new_internal_solid, too_narrow);
-                    }
-
-                    // make sure the new internal solid is wide enough, as it might get collapsed
-                    // when spacing is added in Fill.pm
-                    {
-                        //FIXME Vojtech: Disable this and you will be sorry.
-                        // https://github.com/prusa3d/PrusaSlicer/issues/26 bottom
-                        float margin = 3.f * layerm->flow(frSolidInfill).scaled_width(); // require at least this size
-                        // we use a higher miterLimit here to handle areas with acute angles
-                        // in those cases, the default miterLimit would cut the corner and we'd
-                        // get a triangle in $too_narrow; if we grow it below then the shell
-                        // would have a different shape from the external surface and we'd still
-                        // have the same angle, so the next shell would be grown even more and so on.
-                        Polygons too_narrow = diff(
-                            new_internal_solid,
-                            offset2(new_internal_solid, -margin, +margin, ClipperLib::jtMiter, 5),
-                            true);
-                        if (! too_narrow.empty()) {
-                            // grow the collapsing parts and add the extra area to  the neighbor layer 
-                            // as well as to our original surfaces so that we support this 
-                            // additional area in the next shell too
-                            // make sure our grown surfaces don't exceed the fill area
-                            Polygons internal;
-                            for (const Surface &surface : neighbor_layerm->fill_surfaces.surfaces)
-                                if (surface.has_pos_internal() && !surface.has_mod_bridge())
-                                    polygons_append(internal, to_polygons(surface.expolygon));
-                            polygons_append(new_internal_solid, 
-                                intersection(
-                                    offset(too_narrow, +margin),
-                                    // Discard bridges as they are grown for anchoring and we can't
-                                    // remove such anchors. (This may happen when a bridge is being 
-                                    // anchored onto a wall where little space remains after the bridge
-                                    // is grown, and that little space is an internal solid shell so 
-                                    // it triggers this too_narrow logic.)
-                                    internal));
-                            solid = new_internal_solid;
-                        }
-                    }
-                    
-                    // internal-solid are the union of the existing internal-solid surfaces
-                    // and new ones
-                    SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
-                    polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stPosInternal | stDensSolid)));
-                    ExPolygons internal_solid = union_ex(new_internal_solid, false);
-                    // assign new internal-solid surfaces to layer
-                    neighbor_layerm->fill_surfaces.set(internal_solid, stPosInternal | stDensSolid);
-                    // subtract intersections from layer surfaces to get resulting internal surfaces
-                    Polygons polygons_internal = to_polygons(std::move(internal_solid));
-                    ExPolygons internal = diff_ex(
-                        to_polygons(backup.filter_by_type(stPosInternal | stDensSparse)),
-                        polygons_internal,
-                        true);
-                    // assign resulting internal surfaces to layer
-                    neighbor_layerm->fill_surfaces.append(internal, stPosInternal | stDensSparse);
-                    polygons_append(polygons_internal, to_polygons(std::move(internal)));
-                    // assign top and bottom surfaces to layer
-                    SurfaceType surface_types_solid[] = { stPosTop | stDensSolid, stPosBottom | stDensSolid, stPosBottom | stDensSolid | stModBridge };
-                    backup.keep_types(surface_types_solid, 3);
-                    //backup.keep_types_flag(stPosTop | stPosBottom);
-                    std::vector<SurfacesPtr> top_bottom_groups;
-                    backup.group(&top_bottom_groups);
-                    for (SurfacesPtr &group : top_bottom_groups)
-                        neighbor_layerm->fill_surfaces.append(
-                            diff_ex(to_polygons(group), polygons_internal),
-                            // Use an existing surface as a template, it carries the bridge angle etc.
-                            *group.front());
                 }
-        EXTERNAL:;
-            } // foreach type (stTop, stBottom, stBottomBridge)
-        } // for each layer
-    } // for each region
-
-#ifdef SLIC3R_DEBUG_SLICE_PROCESSING
-    for (size_t region_id = 0; region_id < this->region_volumes.size(); ++ region_id) {
-        for (const Layer *layer : m_layers) {
-            const LayerRegion *layerm = layer->m_regions[region_id];
-            layerm->export_region_slices_to_svg_debug("5_discover_horizontal_shells");
-            layerm->export_region_fill_surfaces_to_svg_debug("5_discover_horizontal_shells");
-        } // for each layer
-    } // for each region
-#endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
+                
+                // internal-solid are the union of the existing internal-solid surfaces
+                // and new ones
+                SurfaceCollection backup = std::move(neighbor_layerm->fill_surfaces);
+                polygons_append(new_internal_solid, to_polygons(backup.filter_by_type(stPosInternal | stDensSolid)));
+                ExPolygons internal_solid = union_ex(new_internal_solid, false);
+                // assign new internal-solid surfaces to layer
+                neighbor_layerm->fill_surfaces.set(internal_solid, stPosInternal | stDensSolid);
+                // subtract intersections from layer surfaces to get resulting internal surfaces
+                Polygons polygons_internal = to_polygons(std::move(internal_solid));
+                ExPolygons internal = diff_ex(
+                    to_polygons(backup.filter_by_type(stPosInternal | stDensSparse)),
+                    polygons_internal,
+                    true);
+                // assign resulting internal surfaces to layer
+                neighbor_layerm->fill_surfaces.append(internal, stPosInternal | stDensSparse);
+                polygons_append(polygons_internal, to_polygons(std::move(internal)));
+                // assign top and bottom surfaces to layer
+                SurfaceType surface_types_solid[] = { stPosTop | stDensSolid, stPosBottom | stDensSolid, stPosBottom | stDensSolid | stModBridge };
+                backup.keep_types(surface_types_solid, 3);
+                //backup.keep_types_flag(stPosTop | stPosBottom);
+                std::vector<SurfacesPtr> top_bottom_groups;
+                backup.group(&top_bottom_groups);
+                for (SurfacesPtr &group : top_bottom_groups)
+                    neighbor_layerm->fill_surfaces.append(
+                        diff_ex(to_polygons(group), polygons_internal),
+                        // Use an existing surface as a template, it carries the bridge angle etc.
+                        *group.front());
+            }
+    EXTERNAL:;
+        } // foreach type (stTop, stBottom, stBottomBridge)
+    } // for each layer
 }
 
 // combine fill surfaces across layers to honor the "infill every N layers" option
@@ -3016,74 +3395,83 @@ void PrintObject::combine_infill()
             combine[m_layers.size() - 1] = num_layers;
         }
         
-        // loop through layers to which we have assigned layers to combine
-        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx) {
-            m_print->throw_if_canceled();
-            size_t num_layers = combine[layer_idx];
-            if (num_layers <= 1)
-                continue;
-            // Get all the LayerRegion objects to be combined.
-            std::vector<LayerRegion*> layerms;
-            layerms.reserve(num_layers);
-            for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
-                layerms.emplace_back(m_layers[i]->regions()[region_id]);
-            // We need to perform a multi-layer intersection, so let's split it in pairs.
-            // Initialize the intersection with the candidates of the lowest layer.
-            ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
-            // Start looping from the second layer and intersect the current intersection with it.
-            for (size_t i = 1; i < layerms.size(); ++ i)
-                intersection = intersection_ex(
-                    to_polygons(intersection),
-                    to_polygons(layerms[i]->fill_surfaces.filter_by_type(stPosInternal | stDensSparse)),
-                    false);
-            double area_threshold = layerms.front()->infill_area_threshold();
-            if (! intersection.empty() && area_threshold > 0.)
-                intersection.erase(std::remove_if(intersection.begin(), intersection.end(), 
-                    [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }), 
-                    intersection.end());
-            if (intersection.empty())
-                continue;
-//            Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
-//                scalar(@$intersection),
-//                ($type == S_TYPE_INTERNAL ? 'internal' : 'internal-solid'),
-//                $layer_idx-($every-1), $layer_idx;
-            // intersection now contains the regions that can be combined across the full amount of layers,
-            // so let's remove those areas from all layers.
-            Polygons intersection_with_clearance;
-            intersection_with_clearance.reserve(intersection.size());
-            //TODO: check if that 'hack' isn't counter-productive : the overlap is done at perimetergenerator (so before this)
-            // and the not-overlap area is stored in the LayerRegion object
-            float clearance_offset = 
-                0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
-             // Because fill areas for rectilinear and honeycomb are grown 
-             // later to overlap perimeters, we need to counteract that too.
-                ((region->config().fill_pattern == ipRectilinear   ||
-                  region->config().fill_pattern == ipGrid          ||
-                  region->config().fill_pattern == ipLine          ||
-                  region->config().fill_pattern == ipHoneycomb) ? 1.5f : 0.5f) * 
-                    layerms.back()->flow(frSolidInfill).scaled_width();
-            for (ExPolygon &expoly : intersection)
-                polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
-            for (LayerRegion *layerm : layerms) {
-                Polygons internal = to_polygons(layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
-                layerm->fill_surfaces.remove_type(stPosInternal | stDensSparse);
-                layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance, false), stPosInternal | stDensSparse);
-                if (layerm == layerms.back()) {
-                    // Apply surfaces back with adjusted depth to the uppermost layer.
-                    Surface templ(stPosInternal | stDensSparse, ExPolygon());
-                    templ.thickness = 0.;
-                    for (LayerRegion *layerm2 : layerms)
-                        templ.thickness += layerm2->layer()->height;
-                    templ.thickness_layers = (unsigned short)layerms.size();
-                    layerm->fill_surfaces.append(intersection, templ);
-                } else {
-                    // Save void surfaces.
-                    layerm->fill_surfaces.append(
-                        intersection_ex(internal, intersection_with_clearance, false),
-                        stPosInternal | stDensVoid);
+        // The layers to which we have assigned layers to combine. The groups of combined layers do not overlap,
+        // therefore they are processed in parallel.
+        std::vector<size_t> combined_layers;
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+            if (combine[layer_idx] > 1)
+                combined_layers.emplace_back(layer_idx);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, combined_layers.size()),
+            [this, region_id, region, &combine, &combined_layers](const tbb::blocked_range<size_t>& range) {
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                    m_print->throw_if_canceled();
+                    size_t layer_idx  = combined_layers[idx];
+                    size_t num_layers = combine[layer_idx];
+                    // Get all the LayerRegion objects to be combined.
+                    std::vector<LayerRegion*> layerms;
+                    layerms.reserve(num_layers);
+                    for (size_t i = layer_idx + 1 - num_layers; i <= layer_idx; ++ i)
+                        layerms.emplace_back(m_layers[i]->regions()[region_id]);
+                    // We need to perform a multi-layer intersection, so let's split it in pairs.
+                    // Initialize the intersection with the candidates of the lowest layer.
+                    ExPolygons intersection = to_expolygons(layerms.front()->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
+                    // Start looping from the second layer and intersect the current intersection with it.
+                    for (size_t i = 1; i < layerms.size(); ++ i)
+                        intersection = intersection_ex(
+                            to_polygons(intersection),
+                            to_polygons(layerms[i]->fill_surfaces.filter_by_type(stPosInternal | stDensSparse)),
+                            false);
+                    double area_threshold = layerms.front()->infill_area_threshold();
+                    if (! intersection.empty() && area_threshold > 0.)
+                        intersection.erase(std::remove_if(intersection.begin(), intersection.end(), 
+                            [area_threshold](const ExPolygon &expoly) { return expoly.area() <= area_threshold; }), 
+                            intersection.end());
+                    if (intersection.empty())
+                        continue;
+//                    Slic3r::debugf "  combining %d %s regions from layers %d-%d\n",
+//                        scalar(@$intersection),
+//                        ($type == S_TYPE_INTERNAL ? 'internal' : 'internal-solid'),
+//                        $layer_idx-($every-1), $layer_idx;
+                    // intersection now contains the regions that can be combined across the full amount of layers,
+                    // so let's remove those areas from all layers.
+                    Polygons intersection_with_clearance;
+                    intersection_with_clearance.reserve(intersection.size());
+                    //TODO: check if that 'hack' isn't counter-productive : the overlap is done at perimetergenerator (so before this)
+                    // and the not-overlap area is stored in the LayerRegion object
+                    float clearance_offset = 
+                        0.5f * layerms.back()->flow(frPerimeter).scaled_width() +
+                     // Because fill areas for rectilinear and honeycomb are grown 
+                     // later to overlap perimeters, we need to counteract that too.
+                        ((region->config().fill_pattern == ipRectilinear   ||
+                          region->config().fill_pattern == ipGrid          ||
+                          region->config().fill_pattern == ipLine          ||
+                          region->config().fill_pattern == ipHoneycomb) ? 1.5f : 0.5f) * 
+                            layerms.back()->flow(frSolidInfill).scaled_width();
+                    for (ExPolygon &expoly : intersection)
+                        polygons_append(intersection_with_clearance, offset(expoly, clearance_offset));
+                    for (LayerRegion *layerm : layerms) {
+                        Polygons internal = to_polygons(layerm->fill_surfaces.filter_by_type(stPosInternal | stDensSparse));
+                        layerm->fill_surfaces.remove_type(stPosInternal | stDensSparse);
+                        layerm->fill_surfaces.append(diff_ex(internal, intersection_with_clearance, false), stPosInternal | stDensSparse);
+                        if (layerm == layerms.back()) {
+                            // Apply surfaces back with adjusted depth to the uppermost layer.
+                            Surface templ(stPosInternal | stDensSparse, ExPolygon());
+                            templ.thickness = 0.;
+                            for (LayerRegion *layerm2 : layerms)
+                                templ.thickness += layerm2->layer()->height;
+                            templ.thickness_layers = (unsigned short)layerms.size();
+                            layerm->fill_surfaces.append(intersection, templ);
+                        } else {
+                            // Save void surfaces.
+                            layerm->fill_surfaces.append(
+                                intersection_ex(internal, intersection_with_clearance, false),
+                                stPosInternal | stDensVoid);
+                        }
+                    }
                 }
-            }
-        }
+            });
+        m_print->throw_if_canceled();
     }
 }
 
@@ -3,6 +3,8 @@
 
 #include <Eigen/Geometry>
 #include <memory>
+#include <limits>
+#include <vector>
 
 // #define SLIC3R_SLA_NEEDS_WINDTREE
 
@@ -141,6 +143,19 @@ public:
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
 
+    // Casting a bundle of rays on the mesh. The rays traverse the AABB tree
+    // together, which is cheaper than casting them one by one. The results
+    // are the same as the ones of query_ray_hit() for the individual rays.
+    std::vector<hit_result> query_ray_hits(const std::vector<Vec3d> &sources,
+                                           const std::vector<Vec3d> &dirs) const;
+
+    // Check if any ray of the bundle hits the mesh closer than max_distance.
+    // The traversal stops at the first such hit without searching for the
+    // closest one.
+    bool any_ray_hit(const std::vector<Vec3d> &sources,
+                     const std::vector<Vec3d> &dirs,
+                     double max_distance = std::numeric_limits<double>::infinity()) const;
+
     class si_result {
         double m_value;
         int m_fidx;
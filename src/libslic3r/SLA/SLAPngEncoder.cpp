@@ -0,0 +1,398 @@
+#include "SLAPngEncoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <miniz.h>
+
+namespace Slic3r { namespace sla {
+
+namespace {
+
+// A run of equal bytes of the image data.
+struct Run {
+    std::uint8_t value;
+    size_t length;
+};
+
+// Split the data into the runs of equal bytes. Long runs are compared eight
+// bytes at a time.
+void find_runs(const std::uint8_t *data, size_t len, std::vector<Run>& runs)
+{
+    size_t i = 0;
+    while(i < len) {
+        const std::uint8_t value = data[i];
+        const std::uint64_t pattern = 0x0101010101010101ULL * value;
+        size_t j = i + 1;
+        for(std::uint64_t word; j + 8 <= len; j += 8) {
+            std::memcpy(&word, data + j, 8);
+            if(word != pattern) break;
+        }
+        while(j < len && data[j] == value) ++j;
+        runs.push_back({value, j - i});
+        i = j;
+    }
+}
+
+// Append a run, merging it with the last run of the same value.
+void append_run(std::vector<Run>& runs, const Run& run)
+{
+    if(!runs.empty() && runs.back().value == run.value)
+        runs.back().length += run.length;
+    else
+        runs.emplace_back(run);
+}
+
+const std::uint32_t ADLER_BASE = 65521;
+
+// Update the Adler-32 checksum with a run of equal bytes in constant time.
+std::uint32_t adler32_run(std::uint32_t adler, std::uint8_t value, size_t len)
+{
+    std::uint64_t a = adler & 0xffff, b = adler >> 16;
+    std::uint64_t n = len % ADLER_BASE;
+    // The sum of a + value * k for k = 1..len, with n (n + 1) / 2
+    // calculated by the multiplication with the inverse of two.
+    std::uint64_t tri = n * ((len + 1) % ADLER_BASE) % ADLER_BASE
+                        * ((ADLER_BASE + 1) / 2) % ADLER_BASE;
+    b = (b + n * a + tri * value) % ADLER_BASE;
+    a = (a + n * value) % ADLER_BASE;
+    return std::uint32_t((b << 16) | a);
+}
+
+// Deflate symbols of the match lengths 3..258: the symbol, the number of
+// the extra bits and the base length.
+struct LengthCode { std::uint16_t symbol, extra_bits, base; };
+
+const std::array<LengthCode, 259>& length_codes()
+{
+    static const std::array<LengthCode, 259> codes = []() {
+        static const std::uint16_t base[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const std::uint16_t extra[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        std::array<LengthCode, 259> out;
+        for(unsigned len = 3, code = 0; len <= 258; ++len) {
+            while(code < 28 && len >= base[code + 1]) ++code;
+            out[len] = { std::uint16_t(257 + code), extra[code], base[code] };
+        }
+        return out;
+    }();
+    return codes;
+}
+
+const unsigned NUM_LITLEN_SYMBOLS = 286;
+const unsigned END_OF_BLOCK = 256;
+
+// The deflate stream as a sequence of symbols, a symbol of a match length
+// being stored with its extra bits value in the upper half. All matches
+// are of the distance 1.
+class Tokens {
+public:
+    std::vector<std::uint32_t> symbols;
+    std::vector<std::uint32_t> freq;
+
+    Tokens() : freq(NUM_LITLEN_SYMBOLS, 0) {}
+
+    void literal(std::uint8_t value, size_t count = 1) {
+        symbols.insert(symbols.end(), count, value);
+        freq[value] += std::uint32_t(count);
+    }
+
+    void match(unsigned len) {
+        const LengthCode& lc = length_codes()[len];
+        symbols.emplace_back(lc.symbol | ((len - lc.base) << 16));
+        ++freq[lc.symbol];
+    }
+
+    void run(const Run& r) {
+        if(r.length < 4) {
+            literal(r.value, r.length);
+            return;
+        }
+        literal(r.value);
+        for(size_t rest = r.length - 1; rest > 0;) {
+            // Split the run into the matches of 3 to 258 bytes.
+            size_t len = std::min<size_t>(rest, 258);
+            if(rest - len > 0 && rest - len < 3) len = rest - 3;
+            match(unsigned(len));
+            rest -= len;
+        }
+    }
+
+    void end() {
+        symbols.emplace_back(END_OF_BLOCK);
+        ++freq[END_OF_BLOCK];
+    }
+};
+
+// Code lengths of a length limited Huffman code (see
+// tdefl_optimize_huffman_table() of miniz).
+std::vector<std::uint8_t> huffman_code_lengths(
+    const std::vector<std::uint32_t>& freq, unsigned max_len)
+{
+    std::vector<std::uint8_t> lengths(freq.size(), 0);
+
+    std::vector<std::pair<std::uint32_t, unsigned>> syms;
+    for(unsigned i = 0; i < freq.size(); ++i)
+        if(freq[i] > 0) syms.emplace_back(freq[i], i);
+    if(syms.empty()) return lengths;
+    if(syms.size() == 1) {
+        lengths[syms.front().second] = 1;
+        return lengths;
+    }
+    std::sort(syms.begin(), syms.end());
+
+    // In-place calculation of the minimum redundancy code of the ascending
+    // weights by Moffat and Katajainen.
+    const int n = int(syms.size());
+    std::vector<std::uint32_t> A(syms.size());
+    for(int i = 0; i < n; ++i) A[i] = syms[i].first;
+    A[0] += A[1];
+    int root = 0, leaf = 2;
+    for(int next = 1; next < n - 1; ++next) {
+        if(leaf >= n || A[root] < A[leaf]) {
+            A[next] = A[root]; A[root++] = std::uint32_t(next);
+        } else A[next] = A[leaf++];
+        if(leaf >= n || (root < next && A[root] < A[leaf])) {
+            A[next] += A[root]; A[root++] = std::uint32_t(next);
+        } else A[next] += A[leaf++];
+    }
+    A[n - 2] = 0;
+    for(int next = n - 3; next >= 0; --next) A[next] = A[A[next]] + 1;
+    int avbl = 1, used = 0, dpth = 0;
+    root = n - 2;
+    int next = n - 1;
+    while(avbl > 0) {
+        while(root >= 0 && int(A[root]) == dpth) { ++used; --root; }
+        while(avbl > used) { A[next--] = std::uint32_t(dpth); --avbl; }
+        avbl = 2 * used; ++dpth; used = 0;
+    }
+
+    // Limit the code lengths, keeping the code complete.
+    std::vector<unsigned> num_codes(size_t(n) + 1, 0);
+    for(int i = 0; i < n; ++i) ++num_codes[A[i]];
+    num_codes.resize(std::max<size_t>(num_codes.size(), max_len + 1), 0);
+    for(size_t i = max_len + 1; i < num_codes.size(); ++i) {
+        num_codes[max_len] += num_codes[i];
+        num_codes[i] = 0;
+    }
+    std::uint32_t total = 0;
+    for(unsigned i = max_len; i > 0; --i)
+        total += std::uint32_t(num_codes[i]) << (max_len - i);
+    while(total != (1u << max_len)) {
+        --num_codes[max_len];
+        for(unsigned i = max_len - 1; i > 0; --i)
+            if(num_codes[i] > 0) {
+                --num_codes[i];
+                num_codes[i + 1] += 2;
+                break;
+            }
+        --total;
+    }
+
+    // The least frequent symbols get the longest codes.
+    int j = 0;
+    for(unsigned len = max_len; len > 0; --len)
+        for(unsigned k = 0; k < num_codes[len]; ++k)
+            lengths[syms[size_t(j++)].second] = std::uint8_t(len);
+
+    return lengths;
+}
+
+// Canonical Huffman codes of the given code lengths.
+std::vector<std::uint16_t> huffman_codes(const std::vector<std::uint8_t>& lengths)
+{
+    unsigned bl_count[16] = {0}, next_code[16] = {0};
+    for(std::uint8_t l : lengths) if(l > 0) ++bl_count[l];
+    for(unsigned bits = 1, code = 0; bits < 16; ++bits) {
+        code = (code + bl_count[bits - 1]) << 1;
+        next_code[bits] = code;
+    }
+    std::vector<std::uint16_t> codes(lengths.size(), 0);
+    for(size_t i = 0; i < lengths.size(); ++i)
+        if(lengths[i] > 0) codes[i] = std::uint16_t(next_code[lengths[i]]++);
+    return codes;
+}
+
+class BitWriter {
+    std::vector<std::uint8_t>& m_out;
+    std::uint32_t m_bits = 0;
+    unsigned m_nbits = 0;
+
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& out): m_out(out) {}
+
+    // Up to 16 bits, the least significant bit first.
+    void put(std::uint32_t value, unsigned nbits) {
+        m_bits |= value << m_nbits;
+        m_nbits += nbits;
+        for(; m_nbits >= 8; m_nbits -= 8, m_bits >>= 8)
+            m_out.emplace_back(std::uint8_t(m_bits));
+    }
+
+    // Huffman codes are stored starting with the most significant bit.
+    void put_code(std::uint32_t code, unsigned nbits) {
+        std::uint32_t reversed = 0;
+        for(unsigned i = 0; i < nbits; ++i, code >>= 1)
+            reversed = (reversed << 1) | (code & 1);
+        put(reversed, nbits);
+    }
+
+    void align() { if(m_nbits > 0) put(0, 8 - m_nbits); }
+};
+
+// Write the tokens as a single final deflate block with dynamic Huffman codes.
+void write_deflate_block(const Tokens& tokens, std::vector<std::uint8_t>& out)
+{
+    std::vector<std::uint8_t> lit_lengths = huffman_code_lengths(tokens.freq, 15);
+    std::vector<std::uint16_t> lit_codes = huffman_codes(lit_lengths);
+    // A single distance code of one bit, allowed even if there is no match.
+    const std::uint8_t dist_length = 1;
+    const std::uint16_t dist_code = 0;
+
+    unsigned hlit = NUM_LITLEN_SYMBOLS;
+    while(hlit > 257 && lit_lengths[hlit - 1] == 0) --hlit;
+
+    // Run length encoding of the code lengths into the code length symbols
+    // 0..15, 16 (repeat previous), 17 (3..10 zeros), 18 (11..138 zeros).
+    std::vector<std::uint8_t> all_lengths(lit_lengths.begin(), lit_lengths.begin() + hlit);
+    all_lengths.emplace_back(dist_length);
+    std::vector<std::pair<std::uint8_t, std::uint8_t>> cl_symbols; // symbol, extra bits value
+    std::vector<std::uint32_t> cl_freq(19, 0);
+    auto cl_emit = [&cl_symbols, &cl_freq](unsigned sym, unsigned extra) {
+        cl_symbols.emplace_back(std::uint8_t(sym), std::uint8_t(extra));
+        ++cl_freq[sym];
+    };
+    for(size_t i = 0; i < all_lengths.size();) {
+        const std::uint8_t len = all_lengths[i];
+        size_t run = 1;
+        while(i + run < all_lengths.size() && all_lengths[i + run] == len) ++run;
+        i += run;
+        if(len == 0) {
+            for(; run >= 11; run -= std::min<size_t>(run, 138))
+                cl_emit(18, unsigned(std::min<size_t>(run, 138) - 11));
+            if(run >= 3) { cl_emit(17, unsigned(run - 3)); run = 0; }
+        } else {
+            cl_emit(len, 0); --run;
+            for(; run >= 3; run -= std::min<size_t>(run, 6))
+                cl_emit(16, unsigned(std::min<size_t>(run, 6) - 3));
+        }
+        for(; run > 0; --run) cl_emit(len, 0);
+    }
+    std::vector<std::uint8_t> cl_lengths = huffman_code_lengths(cl_freq, 7);
+    std::vector<std::uint16_t> cl_codes = huffman_codes(cl_lengths);
+    static const std::uint8_t cl_order[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    unsigned hclen = 19;
+    while(hclen > 4 && cl_lengths[cl_order[hclen - 1]] == 0) --hclen;
+
+    BitWriter bits(out);
+    bits.put(1, 1);                         // final block
+    bits.put(2, 2);                         // dynamic Huffman codes
+    bits.put(hlit - 257, 5);
+    bits.put(0, 5);                         // one distance code
+    bits.put(hclen - 4, 4);
+    for(unsigned i = 0; i < hclen; ++i) bits.put(cl_lengths[cl_order[i]], 3);
+    static const unsigned cl_extra_bits[3] = { 2, 3, 7 };
+    for(const auto& s : cl_symbols) {
+        bits.put_code(cl_codes[s.first], cl_lengths[s.first]);
+        if(s.first >= 16) bits.put(s.second, cl_extra_bits[s.first - 16]);
+    }
+
+    for(std::uint32_t token : tokens.symbols) {
+        const unsigned sym = token & 0xffff;
+        bits.put_code(lit_codes[sym], lit_lengths[sym]);
+        if(sym > END_OF_BLOCK) {
+            // Length symbols 265..284 have 1 to 5 extra bits, four symbols each.
+            unsigned extra_bits = sym < 265 || sym == 285 ? 0 : (sym - 261) / 4;
+            if(extra_bits > 0) bits.put(token >> 16, extra_bits);
+            bits.put_code(dist_code, dist_length);
+        }
+    }
+    bits.align();
+}
+
+void put_uint32_be(std::vector<std::uint8_t>& out, std::uint32_t v)
+{
+    for(int shift = 24; shift >= 0; shift -= 8)
+        out.emplace_back(std::uint8_t(v >> shift));
+}
+
+void put_png_chunk(std::vector<std::uint8_t>& out, const char *type,
+                   const std::uint8_t *data, size_t len)
+{
+    put_uint32_be(out, std::uint32_t(len));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if(len > 0) out.insert(out.end(), data, data + len);
+    put_uint32_be(out, std::uint32_t(mz_crc32(MZ_CRC32_INIT, out.data() + start, len + 4)));
+}
+
+} // namespace
+
+std::vector<std::uint8_t> encode_png_gray8(unsigned width,
+                                           unsigned height,
+                                           unsigned band_begin,
+                                           unsigned band_end,
+                                           const std::uint8_t *band)
+{
+    assert(band_begin <= band_end && band_end <= height);
+    const size_t stride = size_t(width) + 1;
+
+    // Runs of the band, each chunk of rows is scanned by a separate task.
+    const size_t chunk_rows = 128;
+    const size_t band_rows = band_end - band_begin;
+    std::vector<std::vector<Run>> chunk_runs((band_rows + chunk_rows - 1) / chunk_rows);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunk_runs.size()),
+        [band, band_rows, stride, chunk_rows, &chunk_runs](const tbb::blocked_range<size_t>& range) {
+            for(size_t i = range.begin(); i < range.end(); ++i) {
+                size_t row_end = std::min(band_rows, (i + 1) * chunk_rows);
+                find_runs(band + i * chunk_rows * stride,
+                          (row_end - i * chunk_rows) * stride, chunk_runs[i]);
+            }
+        });
+
+    // The black rows are a single run of zeros including the filter types.
+    std::vector<Run> runs;
+    if(band_begin > 0) runs.push_back({0, band_begin * stride});
+    for(const std::vector<Run>& chunk : chunk_runs)
+        for(const Run& run : chunk) append_run(runs, run);
+    chunk_runs.clear();
+    if(height > band_end) append_run(runs, {0, (height - band_end) * stride});
+
+    Tokens tokens;
+    std::uint32_t adler = MZ_ADLER32_INIT;
+    for(const Run& run : runs) {
+        tokens.run(run);
+        adler = adler32_run(adler, run.value, run.length);
+    }
+    tokens.end();
+
+    // zlib stream with the default compression level header
+    std::vector<std::uint8_t> z = { 0x78, 0x9c };
+    write_deflate_block(tokens, z);
+    put_uint32_be(z, adler);
+
+    std::vector<std::uint8_t> out = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a };
+    out.reserve(out.size() + z.size() + 57);
+    std::vector<std::uint8_t> ihdr;
+    put_uint32_be(ihdr, width);
+    put_uint32_be(ihdr, height);
+    // 8 bit grayscale, deflate, no interlacing
+    ihdr.insert(ihdr.end(), { 0x08, 0x00, 0x00, 0x00, 0x00 });
+    put_png_chunk(out, "IHDR", ihdr.data(), ihdr.size());
+    put_png_chunk(out, "IDAT", z.data(), z.size());
+    put_png_chunk(out, "IEND", nullptr, 0);
+    return out;
+}
+
+} // namespace sla
+} // namespace Slic3r
@@ -0,0 +1,33 @@
+#ifndef SLAPNGENCODER_HPP
+#define SLAPNGENCODER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Slic3r { namespace sla {
+
+/**
+ * @brief Encode an 8 bit grayscale image into PNG.
+ *
+ * The encoder is specialized for the SLA layer rasters, which are mostly
+ * black and white with thin anti-aliased edges: the image data is split into
+ * runs of equal bytes, which are encoded as the literal and the copies of
+ * the previous byte, compressed by a Huffman code built for the layer. Large
+ * images are scanned for the runs in parallel, the result does not depend on
+ * the number of threads.
+ *
+ * Only the band of rows [band_begin, band_end) is passed in as the PNG
+ * scanlines, each row being the filter type byte (zero, no filter) followed
+ * by the pixels. The rows above and below the band are black.
+ */
+std::vector<std::uint8_t> encode_png_gray8(unsigned width,
+                                           unsigned height,
+                                           unsigned band_begin,
+                                           unsigned band_end,
+                                           const std::uint8_t *band);
+
+} // namespace sla
+} // namespace Slic3r
+
+#endif // SLAPNGENCODER_HPP
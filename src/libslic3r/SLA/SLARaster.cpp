@@ -2,8 +2,13 @@
 #define SLARASTER_CPP
 
 #include <functional>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
 
 #include "SLARaster.hpp"
+#include "SLAPngEncoder.hpp"
 #include "libslic3r/ExPolygon.hpp"
 #include <libnest2d/backends/clipper/clipper_polygon.hpp>
 
@@ -19,9 +24,6 @@
 #include <agg/agg_rasterizer_scanline_aa.h>
 #include <agg/agg_path_storage.h>
 
-// Experimental minz image write:
-#include <miniz.h>
-
 namespace Slic3r {
 
 inline const Polygon& contour(const ExPolygon& p) { return p.contour; }
@@ -32,6 +34,12 @@ inline const ClipperLib::Paths& holes(const ClipperLib::Polygon& p) { return p.H
 
 namespace sla {
 
+// The raster is stored sparsely: only the band of rows touched by the drawn
+// polygons is allocated, the rows above and below the band are black. This
+// saves clearing and compressing the empty parts of the display, which are
+// the majority of a typical layer. Each row of the band is prefixed with the
+// PNG filter type byte (zero), so that the band is directly the PNG scanline
+// data.
 class Raster::Impl {
 public:
     using TPixelRenderer = agg::pixfmt_gray8; // agg::pixfmt_rgb24;
@@ -39,7 +47,7 @@ public:
     using TPixel = TPixelRenderer::color_type;
     using TRawBuffer = agg::rendering_buffer;
 
-    using TBuffer = std::vector<TPixelRenderer::pixel_type>;
+    using TBuffer = std::vector<TPixelRenderer::value_type>;
 
     using TRendererAA = agg::renderer_scanline_aa_solid<TRawRenderer>;
 
@@ -52,7 +60,10 @@ private:
     Raster::Resolution m_resolution;
 //    Raster::PixelDim m_pxdim;
     Raster::PixelDim m_pxdim_scaled;    // used for scaled coordinate polygons
+    // Rows [m_band_begin, m_band_end) of the raster, prefixed by the PNG
+    // filter type.
     TBuffer m_buf;
+    unsigned m_band_begin = 0, m_band_end = 0;
     TRawBuffer m_rbuf;
     TPixelRenderer m_pixfmt;
     TRawRenderer m_raw_renderer;
@@ -70,6 +81,42 @@ private:
         path.flip_x(0, m_resolution.width_px);
     }
 
+    inline size_t stride() const { return size_t(m_resolution.width_px) + 1; }
+
+    // Extend the allocated band of rows to contain the rows [begin, end).
+    void extend_band(unsigned begin, unsigned end) {
+        if(m_band_begin < m_band_end) {
+            begin = std::min(begin, m_band_begin);
+            end = std::max(end, m_band_end);
+            if(begin == m_band_begin && end == m_band_end) return;
+        }
+
+        // Zero is black and the PNG filter type None.
+        TBuffer buf(size_t(end - begin) * stride(), 0);
+        if(m_band_begin < m_band_end)
+            std::copy(m_buf.begin(), m_buf.end(),
+                      buf.begin() + ptrdiff_t((m_band_begin - begin) * stride()));
+
+        m_buf = std::move(buf);
+        m_band_begin = begin;
+        m_band_end = end;
+        m_rbuf.attach(m_buf.data() + 1, m_resolution.width_px,
+                      end - begin, int(stride()));
+        m_raw_renderer.reset_clipping(true);
+    }
+
+    static void add_y_range(const agg::path_storage& path,
+                            double& ymin, double& ymax)
+    {
+        for(unsigned i = 0; i < path.total_vertices(); ++i) {
+            double x, y;
+            if(agg::is_vertex(path.vertex(i, &x, &y))) {
+                ymin = std::min(ymin, y);
+                ymax = std::max(ymax, y);
+            }
+        }
+    }
+
 public:
 
     inline Impl(const Raster::Resolution& res, const Raster::PixelDim &pd,
@@ -77,10 +124,6 @@ public:
         m_resolution(res), 
 //        m_pxdim(pd), 
         m_pxdim_scaled(SCALING_FACTOR / pd.w_mm, SCALING_FACTOR / pd.h_mm),
-        m_buf(res.pixels()),
-        m_rbuf(reinterpret_cast<TPixelRenderer::value_type*>(m_buf.data()),
-              res.width_px, res.height_px,
-              int(res.width_px*TPixelRenderer::num_components)),
         m_pixfmt(m_rbuf),
         m_raw_renderer(m_pixfmt),
         m_renderer(m_raw_renderer),
@@ -90,8 +133,6 @@ public:
         
         if(gamma > 0) m_gammafn = agg::gamma_power(gamma);
         else m_gammafn = agg::gamma_threshold(0.5);
-        
-        clear();
     }
     
     inline Impl(const Raster::Resolution& res, 
@@ -113,28 +154,63 @@ public:
         
         ras.gamma(m_gammafn);
 
-        auto&& path = to_path(contour(poly));
-        
-        if(m_mirror[X]) flipx(path);
-        if(m_mirror[Y]) flipy(path);
-
-        ras.add_path(path);
+        std::vector<agg::path_storage> paths;
+        paths.reserve(holes(poly).size() + 1);
+        paths.emplace_back(to_path(contour(poly)));
+        for(auto& h : holes(poly)) paths.emplace_back(to_path(h));
+
+        double ymin = std::numeric_limits<double>::max();
+        double ymax = std::numeric_limits<double>::lowest();
+        for(agg::path_storage& path : paths) {
+            if(m_mirror[X]) flipx(path);
+            if(m_mirror[Y]) flipy(path);
+            add_y_range(path, ymin, ymax);
+        }
 
-        for(auto& h : holes(poly)) {
-            auto&& holepath = to_path(h);
-            if(m_mirror[X]) flipx(holepath);
-            if(m_mirror[Y]) flipy(holepath);
-            ras.add_path(holepath);
+        // The polygon only covers the rows between its lowest and highest
+        // vertex, one more row is allocated for the rounding to the subpixel
+        // grid.
+        double ybegin = std::max(0., std::floor(ymin));
+        double yend = std::min(double(m_resolution.height_px),
+                               std::floor(ymax) + 2.);
+        if(ybegin >= yend) return;
+        extend_band(unsigned(ybegin), unsigned(yend));
+
+        // Shifting by whole pixels keeps the subpixel coverage intact.
+        for(agg::path_storage& path : paths) {
+            path.translate_all_paths(0., -double(m_band_begin));
+            ras.add_path(path);
         }
 
         agg::render_scanlines(ras, scanlines, m_renderer);
     }
 
     inline void clear() {
-        m_raw_renderer.clear(ColorBlack);
+        TBuffer().swap(m_buf);
+        m_band_begin = m_band_end = 0;
     }
 
-    inline TBuffer& buffer()  { return m_buf; }
+    // Number of the black rows above and below the band.
+    inline unsigned rows_above() const { return m_band_begin; }
+    inline unsigned rows_below() const {
+        return m_band_begin < m_band_end ?
+                    m_resolution.height_px - m_band_end :
+                    m_resolution.height_px;
+    }
+    // PNG scanlines of the band.
+    inline const TBuffer& band() const { return m_buf; }
+
+    // Copy the pixels (without the PNG filter type) of the whole image.
+    std::vector<std::uint8_t> pixels() const {
+        std::vector<std::uint8_t> out(m_resolution.pixels(), 0);
+        for(unsigned r = m_band_begin; r < m_band_end; ++r)
+            std::copy(m_buf.begin() + ptrdiff_t((r - m_band_begin) * stride() + 1),
+                      m_buf.begin() + ptrdiff_t((r - m_band_begin + 1) * stride()),
+                      out.begin() + ptrdiff_t(size_t(r) * m_resolution.width_px));
+        return out;
+    }
+
+    std::vector<std::uint8_t> png() const;
     
     inline Format format() const { return m_fmt; }
 
@@ -178,6 +254,13 @@ private:
 
 };
 
+std::vector<std::uint8_t> Raster::Impl::png() const
+{
+    return encode_png_gray8(m_resolution.width_px, m_resolution.height_px,
+                            rows_above(), m_resolution.height_px - rows_below(),
+                            m_buf.data());
+}
+
 const Raster::Impl::TPixel Raster::Impl::ColorWhite = Raster::Impl::TPixel(255);
 const Raster::Impl::TPixel Raster::Impl::ColorBlack = Raster::Impl::TPixel(0);
 
@@ -242,19 +325,9 @@ void Raster::save(std::ostream& stream, Format fmt)
 
     switch(fmt) {
     case Format::PNG: {
-        auto& b = m_impl->buffer();
-        size_t out_len = 0;
-        void * rawdata = tdefl_write_image_to_png_file_in_memory(
-                    b.data(),
-                    int(resolution().width_px),
-                    int(resolution().height_px), 1, &out_len);
-
-        if(rawdata == nullptr) break;
-
-        stream.write(static_cast<const char*>(rawdata),
-                     std::streamsize(out_len));
-
-        MZ_FREE(rawdata);
+        std::vector<std::uint8_t> data = m_impl->png();
+        stream.write(reinterpret_cast<const char*>(data.data()),
+                     std::streamsize(data.size()));
 
         break;
     }
@@ -264,9 +337,9 @@ void Raster::save(std::ostream& stream, Format fmt)
                << m_impl->resolution().height_px << " "
                << "255 ";
 
-        auto sz = m_impl->buffer().size()*sizeof(Impl::TBuffer::value_type);
-        stream.write(reinterpret_cast<const char*>(m_impl->buffer().data()),
-                     std::streamsize(sz));
+        std::vector<std::uint8_t> pixels = m_impl->pixels();
+        stream.write(reinterpret_cast<const char*>(pixels.data()),
+                     std::streamsize(pixels.size()));
     }
     }
 }
@@ -280,21 +353,11 @@ RawBytes Raster::save(Format fmt)
 {
     assert(m_impl);
 
-    std::vector<std::uint8_t> data; size_t s = 0;
+    std::vector<std::uint8_t> data;
 
     switch(fmt) {
     case Format::PNG: {
-        void *rawdata = tdefl_write_image_to_png_file_in_memory(
-                    m_impl->buffer().data(),
-                    int(resolution().width_px),
-                    int(resolution().height_px), 1, &s);
-
-        if(rawdata == nullptr) break;
-        auto ptr = static_cast<std::uint8_t*>(rawdata);
-        
-        data.reserve(s); std::copy(ptr, ptr + s, std::back_inserter(data));
-        
-        MZ_FREE(rawdata);
+        data = m_impl->png();
         break;
     }
     case Format::RAW: {
@@ -302,14 +365,10 @@ RawBytes Raster::save(Format fmt)
                 std::to_string(m_impl->resolution().width_px) + " " +
                 std::to_string(m_impl->resolution().height_px) + " " + "255 ";
 
-        auto sz = m_impl->buffer().size()*sizeof(Impl::TBuffer::value_type);
-        s = sz + header.size();
-        
-        data.reserve(s);
-        
-        auto buff = reinterpret_cast<std::uint8_t*>(m_impl->buffer().data());
+        std::vector<std::uint8_t> pixels = m_impl->pixels();
+        data.reserve(header.size() + pixels.size());
         std::copy(header.begin(), header.end(), std::back_inserter(data));
-        std::copy(buff, buff+sz, std::back_inserter(data));
+        std::copy(pixels.begin(), pixels.end(), std::back_inserter(data));
         
         break;
     }
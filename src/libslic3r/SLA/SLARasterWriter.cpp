@@ -5,6 +5,8 @@
 
 #include <boost/log/trivial.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/nowide/fstream.hpp>
 
 namespace Slic3r { namespace sla {
 
@@ -87,6 +89,77 @@ SLARasterWriter::SLARasterWriter(const SLAPrinterConfig &cfg,
     m_gamma = cfg.gamma_correction.getFloat();
 }
 
+SLARasterWriter::~SLARasterWriter()
+{
+    close_spool();
+}
+
+bool SLARasterWriter::start_spooling()
+{
+    if(m_spool) return true;
+
+    boost::system::error_code ec;
+    boost::filesystem::path path = boost::filesystem::temp_directory_path(ec);
+    if(!ec) path /= boost::filesystem::unique_path(
+                ".sla_layers.%%%%-%%%%-%%%%-%%%%", ec);
+    if(ec) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to create a temporary file for "
+                                      "the layer rasters: " << ec.message();
+        return false;
+    }
+
+    std::unique_ptr<boost::nowide::fstream> spool(new boost::nowide::fstream(
+        path.string().c_str(), std::ios::in | std::ios::out |
+                               std::ios::binary | std::ios::trunc));
+    if(!spool->is_open()) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to create a temporary file for "
+                                      "the layer rasters: " << path.string();
+        return false;
+    }
+
+    m_spool_path = path.string();
+    m_spool = std::move(spool);
+    m_spool_end = 0;
+    m_spool_failed = false;
+    return true;
+}
+
+void SLARasterWriter::spool_layer(unsigned lyr_id)
+{
+    assert(lyr_id < m_layers_rst.size());
+    Layer& lyr = m_layers_rst[lyr_id];
+    if(!m_spool || m_spool_failed || lyr.rawbytes.size() == 0) return;
+
+    m_spool->seekp(m_spool_end);
+    m_spool->write(reinterpret_cast<const char*>(lyr.rawbytes.data()),
+                   std::streamsize(lyr.rawbytes.size()));
+    if(!m_spool->good()) {
+        // Most likely the disk is full. The layers spooled so far are still
+        // readable, keep this and the following layers in memory.
+        BOOST_LOG_TRIVIAL(error) << "Failed to write the layer rasters to "
+                                 << m_spool_path
+                                 << ", keeping them in memory";
+        m_spool->clear();
+        m_spool_failed = true;
+        return;
+    }
+
+    lyr.spool_offset = m_spool_end;
+    lyr.spool_size = lyr.rawbytes.size();
+    m_spool_end += std::streamoff(lyr.spool_size);
+    lyr.rawbytes = RawBytes();
+}
+
+void SLARasterWriter::close_spool()
+{
+    m_spool.reset();
+    if(!m_spool_path.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(m_spool_path, ec);
+        m_spool_path.clear();
+    }
+}
+
 void SLARasterWriter::save(const std::string &fpath, const std::string &prjname)
 {
     try {
@@ -99,17 +172,37 @@ void SLARasterWriter::save(const std::string &fpath, const std::string &prjname)
         
         zipper << createIniContent(project);
         
+        // Buffer for a layer read back from the spool file.
+        std::vector<std::uint8_t> spooled;
+        if(m_spool) m_spool->flush();
+
         for(unsigned i = 0; i < m_layers_rst.size(); i++)
         {
-            if(m_layers_rst[i].rawbytes.size() > 0) {
+            Layer& lyr = m_layers_rst[i];
+            const std::uint8_t *data = lyr.rawbytes.data();
+            size_t size = lyr.rawbytes.size();
+
+            if(lyr.spool_size > 0) {
+                spooled.resize(lyr.spool_size);
+                m_spool->seekg(lyr.spool_offset);
+                m_spool->read(reinterpret_cast<char*>(spooled.data()),
+                              std::streamsize(lyr.spool_size));
+                if(!m_spool->good()) {
+                    m_spool->clear();
+                    throw std::runtime_error(
+                        "Failed to read the layer rasters from " + m_spool_path);
+                }
+                data = spooled.data();
+                size = spooled.size();
+            }
+
+            if(size > 0) {
                 char lyrnum[6];
                 std::sprintf(lyrnum, "%.5d", i);
                 auto zfilename = project + lyrnum + ".png";
                 
                 // Add binary entry to the zipper
-                zipper.add_entry(zfilename,
-                                 m_layers_rst[i].rawbytes.data(),
-                                 m_layers_rst[i].rawbytes.size());
+                zipper.add_entry(zfilename, data, size);
             }
         }
         
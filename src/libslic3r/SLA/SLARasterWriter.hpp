@@ -6,6 +6,7 @@
 #include <sstream>
 #include <vector>
 #include <array>
+#include <memory>
 
 #include "libslic3r/PrintConfig.hpp"
 
@@ -20,6 +21,9 @@ namespace Slic3r { namespace sla {
 // each layer can be written and compressed independently (in parallel).
 // At the end when all layers where written, the save method can be used to 
 // write out the result into a zipped archive.
+// In the streaming mode (see start_spooling()) the compressed layers are moved
+// to a temporary file in the order of the layers as soon as they are finished,
+// so that only the layers being rasterized are held in memory.
 class SLARasterWriter
 {
 public:
@@ -45,6 +49,9 @@ private:
     struct Layer {
         Raster raster;
         RawBytes rawbytes;
+        // Position of the compressed bytes in the spool file, if spooled.
+        std::streamoff spool_offset = 0;
+        size_t spool_size = 0;
 
         Layer() = default;
         Layer(const Layer&) = delete; // The image is big, do not copy by accident
@@ -57,9 +64,11 @@ private:
         // Layer(Layer&& m) = default;
         // Layer& operator=(Layer&&) = default;
         Layer(Layer &&m):
-            raster(std::move(m.raster)), rawbytes(std::move(m.rawbytes)) {}
+            raster(std::move(m.raster)), rawbytes(std::move(m.rawbytes)),
+            spool_offset(m.spool_offset), spool_size(m.spool_size) {}
         Layer& operator=(Layer &&m) {
             raster = std::move(m.raster); rawbytes = std::move(m.rawbytes);
+            spool_offset = m.spool_offset; spool_size = m.spool_size;
             return *this;
         }
     };
@@ -67,6 +76,12 @@ private:
     // We will save the compressed PNG data into RawBytes type buffers in 
     // parallel. Later we can write every layer to the disk sequentially.
     std::vector<Layer> m_layers_rst;
+    // Temporary file the compressed layers are moved to in the streaming mode.
+    std::string m_spool_path;
+    std::unique_ptr<std::iostream> m_spool;
+    std::streamoff m_spool_end = 0;
+    // Set if writing into the spool file failed, the following layers are kept in memory.
+    bool m_spool_failed = false;
     Raster::Resolution m_res;
     Raster::PixelDim m_pxdim;
     double m_exp_time_s = .0, m_exp_time_first_s = .0;
@@ -86,11 +101,14 @@ private:
     static void flpXY(ClipperLib::Polygon& poly);
     static void flpXY(ExPolygon& poly);
 
+    void close_spool();
+
 public:
 
     SLARasterWriter(const SLAPrinterConfig& cfg, 
                     const SLAMaterialConfig& mcfg, 
                     double layer_height);
+    ~SLARasterWriter();
 
     SLARasterWriter(const SLARasterWriter& ) = delete;
     SLARasterWriter& operator=(const SLARasterWriter&) = delete;
@@ -103,6 +121,10 @@ public:
     // SLARasterWriter& operator=(SLARasterWriter&&) = default;
     SLARasterWriter(SLARasterWriter&& m):
         m_layers_rst(std::move(m.m_layers_rst)),
+        m_spool_path(std::move(m.m_spool_path)),
+        m_spool(std::move(m.m_spool)),
+        m_spool_end(m.m_spool_end),
+        m_spool_failed(m.m_spool_failed),
         m_res(m.m_res),
         m_pxdim(m.m_pxdim),
         m_exp_time_s(m.m_exp_time_s),
@@ -115,7 +137,10 @@ public:
         m_cnt_fade_layers(m.m_cnt_fade_layers),
         m_cnt_slow_layers(m.m_cnt_slow_layers),
         m_cnt_fast_layers(m.m_cnt_fast_layers)
-    {}
+    {
+        // The spool file is owned by the new instance now.
+        m.m_spool_path.clear();
+    }
 
     // /////////////////////////////////////////////////////////////////////////
 
@@ -156,6 +181,17 @@ public:
         }
     }
 
+    // Switch to the streaming mode: the layers passed to spool_layer() are
+    // moved from the memory to a temporary file, which is deleted with the
+    // writer. Returns false if the file could not be created, then the layers
+    // are kept in memory.
+    bool start_spooling();
+
+    // Move the compressed layer to the spool file. To be called after
+    // finish_layer(lyr_id) in the order of the layers and from a single thread
+    // at a time. Does nothing if not in the streaming mode.
+    void spool_layer(unsigned lyr_id);
+
     void save(const std::string& fpath, const std::string& prjname = "");
 
     void set_statistics(const std::vector<double> statistics);
@@ -85,7 +85,15 @@ using Portion = std::tuple<double, double>;
 
 // Set this to true to enable full parallelism in this module.
 // Only the well tested parts will be concurrent if this is set to false.
-const constexpr bool USE_FULL_CONCURRENCY = false;
+// The concurrent steps store their results per element and apply them in the
+// index order, the generated tree does not depend on the number of threads.
+// The optimizers used by these steps are seeded per call with
+// GeneticOptimizer::seed(), which seeds the RNG of the calling thread. Their
+// objective functions (pinhead_mesh_intersect(), bridge_mesh_intersect())
+// must not spawn nested parallel tasks: a thread waiting for the nested tasks
+// could pick up the task of another element, which would reseed its RNG in
+// the middle of the optimization.
+const constexpr bool USE_FULL_CONCURRENCY = true;
 
 template<bool> struct _ccr {};
 
@@ -1135,6 +1143,8 @@ class SLASupportTree::Algorithm {
     // point was inside the model, an "invalid" hit_result will be returned
     // with a zero distance value instead of a NAN. This way the result can
     // be used safely for comparison with other distances.
+    // Called by optimizer objectives running in parallel, it must not spawn
+    // parallel tasks itself (see USE_FULL_CONCURRENCY).
     EigenMesh3D::hit_result pinhead_mesh_intersect(
             const Vec3d& s,
             const Vec3d& dir,
@@ -1170,9 +1180,6 @@ class SLASupportTree::Algorithm {
         auto& m = m_mesh;
         using HitResult = EigenMesh3D::hit_result;
 
-        // Hit results
-        std::array<HitResult, SAMPLES> hits;
-
         // We have to address the case when the direction vector v (same as
         // dir) is coincident with one of the world axes. In this case two of
         // its components will be completely zero and one is 1.0. Our method
@@ -1194,12 +1201,10 @@ class SLASupportTree::Algorithm {
         // Now a and b vectors are perpendicular to v and to each other.
         // Together they define the plane where we have to iterate with the
         // given angles in the 'phis' vector
-        ccr_par::enumerate(phis.begin(), phis.end(),
-                           [&hits, &m, sd, r_pin, r_back, s, a, b, c]
-                           (double phi, size_t i)
-        {
-            double sinphi = std::sin(phi);
-            double cosphi = std::cos(phi);
+        std::vector<Vec3d> pins(SAMPLES), sources(SAMPLES), dirs(SAMPLES);
+        for(size_t i = 0; i < phis.size(); ++i) {
+            double sinphi = std::sin(phis[i]);
+            double cosphi = std::cos(phis[i]);
 
             // Let's have a safety coefficient for the radiuses.
             double rpscos = (sd + r_pin) * cosphi;
@@ -1223,8 +1228,19 @@ class SLASupportTree::Algorithm {
                     c(Z) + rpbcos * a(Z) + rpbsin * b(Z));
 
             Vec3d n = (p - ps).normalized();
-            auto q = m.query_ray_hit(ps + sd*n, n);
+            pins[i] = ps;
+            sources[i] = ps + sd*n;
+            dirs[i] = n;
+        }
+
+        // Hit results, all the rays are cast at once.
+        std::vector<HitResult> hits = m.query_ray_hits(sources, dirs);
 
+        // The rays starting inside the model are re-cast from the outside.
+        std::vector<size_t> recast;
+        std::vector<Vec3d> recast_sources, recast_dirs;
+        for(size_t i = 0; i < hits.size(); ++i) {
+            HitResult& q = hits[i];
             if(q.is_inside()) { // the hit is inside the model
                 if(q.distance() > r_pin + sd)  {
                     // If we are inside the model and the hit distance is bigger
@@ -1234,36 +1250,36 @@ class SLASupportTree::Algorithm {
                     // zero hit distance to these cases which will enforce the
                     // function return value to be an invalid ray with zero hit
                     // distance. (see min_element at the end)
-                    hits[i] = HitResult(0.0);
+                    q = HitResult(0.0);
                 }
                 else {
                     // re-cast the ray from the outside of the object.
                     // The starting point has an offset of 2*safety_distance
                     // because the original ray has also had an offset
-                    auto q2 = m.query_ray_hit(ps + (q.distance() + 2*sd)*n, n);
-                    hits[i] = q2;
+                    recast.emplace_back(i);
+                    recast_sources.emplace_back(
+                        pins[i] + (q.distance() + 2*sd)*dirs[i]);
+                    recast_dirs.emplace_back(dirs[i]);
                 }
-            } else hits[i] = q;
-        });
+            }
+        }
+
+        if(!recast.empty()) {
+            std::vector<HitResult> recast_hits =
+                m.query_ray_hits(recast_sources, recast_dirs);
+            for(size_t k = 0; k < recast.size(); ++k)
+                hits[recast[k]] = recast_hits[k];
+        }
 
         auto mit = std::min_element(hits.begin(), hits.end());
 
         return *mit;
     }
 
-    // Checking bridge (pillar and stick as well) intersection with the model.
-    // If the function is used for headless sticks, the ins_check parameter
-    // have to be true as the beginning of the stick might be inside the model
-    // geometry.
-    // The return value is the hit result from the ray casting. If the starting
-    // point was inside the model, an "invalid" hit_result will be returned
-    // with a zero distance value instead of a NAN. This way the result can
-    // be used safely for comparison with other distances.
-    EigenMesh3D::hit_result bridge_mesh_intersect(
-            const Vec3d& s,
-            const Vec3d& dir,
-            double r,
-            bool ins_check = false)
+    // Points on the circle of the bridge (pillar, stick) cross section at s,
+    // enlarged by the safety distance. The rays checking the collisions of
+    // the bridge with the model are cast from these points along the bridge.
+    std::vector<Vec3d> bridge_circle(const Vec3d& s, const Vec3d& dir, double r)
     {
         static const size_t SAMPLES = 8;
 
@@ -1287,20 +1303,10 @@ class SLASupportTree::Algorithm {
             b = a.cross(dir);
         }
 
-        // circle portions
-        std::array<double, SAMPLES> phis;
-        for(size_t i = 0; i < phis.size(); ++i) phis[i] = i*2*PI/phis.size();
-
-        auto& m = m_mesh;
-        using HitResult = EigenMesh3D::hit_result;
-
-        // Hit results
-        std::array<HitResult, SAMPLES> hits;
-        
-        ccr_par::enumerate(phis.begin(), phis.end(),
-                           [&m, a, b, sd, dir, r, s, ins_check, &hits]
-                           (double phi, size_t i)
-        {
+        std::vector<Vec3d> circle(SAMPLES);
+        for(size_t i = 0; i < SAMPLES; ++i) {
+            // circle portions
+            double phi = i*2*PI/SAMPLES;
             double sinphi = std::sin(phi);
             double cosphi = std::cos(phi);
 
@@ -1309,29 +1315,90 @@ class SLASupportTree::Algorithm {
             double rsin = (sd + r) * sinphi;
 
             // Point on the circle on the pin sphere
-            Vec3d p (s(X) + rcos * a(X) + rsin * b(X),
-                     s(Y) + rcos * a(Y) + rsin * b(Y),
-                     s(Z) + rcos * a(Z) + rsin * b(Z));
+            circle[i] = Vec3d(s(X) + rcos * a(X) + rsin * b(X),
+                              s(Y) + rcos * a(Y) + rsin * b(Y),
+                              s(Z) + rcos * a(Z) + rsin * b(Z));
+        }
 
-            auto hr = m.query_ray_hit(p + sd*dir, dir);
+        return circle;
+    }
+
+    // Checking bridge (pillar and stick as well) intersection with the model.
+    // If the function is used for headless sticks, the ins_check parameter
+    // have to be true as the beginning of the stick might be inside the model
+    // geometry.
+    // The return value is the hit result from the ray casting. If the starting
+    // point was inside the model, an "invalid" hit_result will be returned
+    // with a zero distance value instead of a NAN. This way the result can
+    // be used safely for comparison with other distances.
+    // Called by optimizer objectives running in parallel, it must not spawn
+    // parallel tasks itself (see USE_FULL_CONCURRENCY).
+    EigenMesh3D::hit_result bridge_mesh_intersect(
+            const Vec3d& s,
+            const Vec3d& dir,
+            double r,
+            bool ins_check = false)
+    {
+        const double& sd = m_cfg.safety_distance_mm;
+        auto& m = m_mesh;
+        using HitResult = EigenMesh3D::hit_result;
 
-            if(ins_check && hr.is_inside()) {
-                if(hr.distance() > 2 * r + sd) hits[i] = HitResult(0.0);
+        std::vector<Vec3d> circle = bridge_circle(s, dir, r);
+        std::vector<Vec3d> sources, dirs(circle.size(), dir);
+        sources.reserve(circle.size());
+        for(const Vec3d& p : circle) sources.emplace_back(p + sd*dir);
+
+        // Hit results, all the rays are cast at once.
+        std::vector<HitResult> hits = m.query_ray_hits(sources, dirs);
+
+        if(ins_check) {
+            std::vector<size_t> recast;
+            std::vector<Vec3d> recast_sources;
+            for(size_t i = 0; i < hits.size(); ++i) {
+                HitResult& hr = hits[i];
+                if(!hr.is_inside()) continue;
+                if(hr.distance() > 2 * r + sd) hr = HitResult(0.0);
                 else {
                     // re-cast the ray from the outside of the object
-                    auto hr2 =
-                           m.query_ray_hit(p + (hr.distance() + 2*sd)*dir, dir);
-
-                    hits[i] = hr2;
+                    recast.emplace_back(i);
+                    recast_sources.emplace_back(
+                        circle[i] + (hr.distance() + 2*sd)*dir);
                 }
-            } else hits[i] = hr;
-        });
+            }
+
+            if(!recast.empty()) {
+                dirs.resize(recast.size());
+                std::vector<HitResult> recast_hits =
+                    m.query_ray_hits(recast_sources, dirs);
+                for(size_t k = 0; k < recast.size(); ++k)
+                    hits[recast[k]] = recast_hits[k];
+            }
+        }
 
         auto mit = std::min_element(hits.begin(), hits.end());
 
         return *mit;
     }
 
+    // Check if the bridge collides with the model closer than dist, which
+    // is the same as bridge_mesh_intersect(s, dir, r) < dist. The ray
+    // casting stops at the first collision found, it is cheaper than
+    // searching for the closest one.
+    bool bridge_mesh_collides(const Vec3d& s,
+                              const Vec3d& dir,
+                              double r,
+                              double dist = std::numeric_limits<double>::infinity())
+    {
+        const double& sd = m_cfg.safety_distance_mm;
+
+        std::vector<Vec3d> sources = bridge_circle(s, dir, r);
+        for(Vec3d& p : sources) p += sd*dir;
+
+        return m_mesh.any_ray_hit(sources,
+                                  std::vector<Vec3d>(sources.size(), dir),
+                                  dist);
+    }
+
     // Helper function for interconnecting two pillars with zig-zag bridges.
     bool interconnect(const Pillar& pillar, const Pillar& nextpillar)
     {
@@ -1399,9 +1466,10 @@ class SLASupportTree::Algorithm {
 
         // TODO: This is a workaround to not have a faulty last bridge
         while(ej(Z) >= eupper(Z) /*endz*/) {
-            if(bridge_mesh_intersect(sj,
+            if(!bridge_mesh_collides(sj,
                                      dirv(sj, ej),
-                                     pillar.r) >= bridge_distance)
+                                     pillar.r,
+                                     bridge_distance))
             {
                 m_result.add_bridge(sj, ej, pillar.r);
                 was_connected = true;
@@ -1412,9 +1480,10 @@ class SLASupportTree::Algorithm {
                 Vec3d sjback(ej(X), ej(Y), sj(Z));
                 Vec3d ejback(sj(X), sj(Y), ej(Z));
                 if(sjback(Z) <= slower(Z) && ejback(Z) >= eupper(Z) &&
-                   bridge_mesh_intersect(sjback,
+                   !bridge_mesh_collides(sjback,
                                          dirv(sjback, ejback),
-                                         pillar.r) >= bridge_distance)
+                                         pillar.r,
+                                         bridge_distance))
                 {
                     // need to check collision for the cross stick
                     m_result.add_bridge(sjback, ejback, pillar.r);
@@ -1470,11 +1539,10 @@ class SLASupportTree::Algorithm {
                 bridgestart(Z) -= zdiff;
                 touchjp(Z) = Zdown;
 
-                double t = bridge_mesh_intersect(headjp, {0,0,-1}, r);
-
                 // We can't insert a pillar under the source head to connect
                 // with the nearby pillar's starting junction
-                if(t < zdiff) return false;
+                if(bridge_mesh_collides(headjp, {0,0,-1}, r, zdiff))
+                    return false;
             }
 
             if(Zdown <= nearjp_u(Z) && Zdown >= nearjp_l(Z) && D < max_len)
@@ -1488,11 +1556,10 @@ class SLASupportTree::Algorithm {
         double minz = m_result.ground_level + 2 * m_cfg.head_width_mm;
         if(bridgeend(Z) < minz) return false;
 
-        double t = bridge_mesh_intersect(bridgestart,
-                                         dirv(bridgestart, bridgeend), r);
-
         // Cannot insert the bridge. (further search might not worth the hassle)
-        if(t < distance(bridgestart, bridgeend)) return false;
+        if(bridge_mesh_collides(bridgestart, dirv(bridgestart, bridgeend), r,
+                                distance(bridgestart, bridgeend)))
+            return false;
 
         // A partial pillar is needed under the starting head.
         if(zdiff > 0) {
@@ -1605,7 +1672,7 @@ class SLASupportTree::Algorithm {
             };
 
             // We have to check if the bridge is feasible.
-            if (bridge_mesh_intersect(jp, dir, radius) < (endp - jp).norm())
+            if (bridge_mesh_collides(jp, dir, radius, (endp - jp).norm()))
                 abort_in_shame();
             else {
                 // If the new endpoint is below ground, do not make a pillar
@@ -1613,8 +1680,8 @@ class SLASupportTree::Algorithm {
                     endp = endp - SQR2 * (gndlvl - endp(Z)) * dir; // back off
                 else {
                     
-                    auto hit = bridge_mesh_intersect(endp, DOWN, radius);
-                    if (!std::isinf(hit.distance())) abort_in_shame();
+                    if (bridge_mesh_collides(endp, DOWN, radius))
+                        abort_in_shame();
 
                     Pillar &plr = m_result.add_pillar(endp, pgnd, radius);
 
@@ -1717,14 +1784,14 @@ public:
         using libnest2d::opt::GeneticOptimizer;
         using libnest2d::opt::StopCriteria;
         
-        ccr::Mutex mutex;
-        auto addfn = [&mutex](PtIndices &container, unsigned val) {
-            std::lock_guard<ccr::Mutex> lk(mutex);
-            container.emplace_back(val);
-        };
+        // The verdicts are stored per filtered point and collected in index
+        // order afterwards, so that the result does not depend on the order
+        // in which the points were processed.
+        enum Verdict : char { vtDiscard, vtHeadless, vtHead };
+        std::vector<Verdict> verdicts(filtered_indices.size(), vtDiscard);
         
         ccr::enumerate(filtered_indices.begin(), filtered_indices.end(),
-                       [this, &nmls, addfn](unsigned fidx, size_t i)
+                       [this, &nmls, &verdicts](unsigned fidx, size_t i)
         {
             m_thr();
             
@@ -1816,20 +1883,28 @@ public:
                 if (t.distance() > w) {
                     // Check distance from ground, we might have zero elevation.
                     if (hp(Z) + w * nn(Z) < m_result.ground_level) {
-                        addfn(m_iheadless, fidx);
+                        verdicts[i] = vtHeadless;
                     } else {
                         // mark the point for needing a head.
-                        addfn(m_iheads, fidx);
+                        verdicts[i] = vtHead;
                     }
                 } else if (polar >= 3 * PI / 4) {
                     // Headless supports do not tilt like the headed ones
                     // so the normal should point almost to the ground.
-                    addfn(m_iheadless, fidx);
+                    verdicts[i] = vtHeadless;
                 }
             }
         });
 
         m_thr();
+
+        for(size_t i = 0; i < filtered_indices.size(); ++i) {
+            switch(verdicts[i]) {
+            case vtHeadless: m_iheadless.emplace_back(filtered_indices[i]); break;
+            case vtHead:     m_iheads.emplace_back(filtered_indices[i]); break;
+            case vtDiscard:  break;
+            }
+        }
     }
 
     // Pinhead creation: based on the filtering results, the Head objects
@@ -1869,19 +1944,29 @@ public:
         // pillars and which shall be connected to the model surface (or
         // search a suitable path around the surface that leads to the
         // ground -- TODO)
-        for(unsigned i : m_iheads) {
+        // The collision checks are independent of each other, the heads are
+        // classified in index order once all of them are done.
+        std::vector<EigenMesh3D::hit_result> hits(m_iheads.size());
+
+        ccr::enumerate(m_iheads.begin(), m_iheads.end(),
+                       [this, &hits](unsigned i, size_t n)
+        {
             m_thr();
 
-            auto& head = m_result.head(i);
-            Vec3d n(0, 0, -1);
-            double r = head.r_back_mm;
-            Vec3d headjp = head.junction_point();
+            const Head& head = m_result.head(i);
+            Vec3d dirdown(0, 0, -1);
 
             // collision check
-            auto hit = bridge_mesh_intersect(headjp, n, r);
+            hits[n] = bridge_mesh_intersect(head.junction_point(), dirdown,
+                                            head.r_back_mm);
+        });
+
+        for(size_t n = 0; n < m_iheads.size(); ++n) {
+            unsigned i = m_iheads[n];
+            const EigenMesh3D::hit_result& hit = hits[n];
 
             if(std::isinf(hit.distance())) ground_head_indices.emplace_back(i);
-            else if(m_cfg.ground_facing_only)  head.invalidate();
+            else if(m_cfg.ground_facing_only)  m_result.head(i).invalidate();
             else m_iheads_onmodel.emplace_back(std::make_pair(i, hit));
         }
 
@@ -2014,28 +2099,35 @@ public:
             this->create_ground_pillar(endp, dir, head.r_back_mm);
         };
 
-        std::vector<unsigned> modelpillars;
-        ccr::Mutex mutex;
+        // The way of a head to the ground or to the model surface if it
+        // cannot be connected to a nearby pillar.
+        struct Route {
+            enum Type { rtFailed, rtGround, rtModel } type = rtFailed;
+            Vec3d dir = Vec3d::Zero();  // bridge direction to the ground
+            double length = 0;          // bridge length to the ground
+            Vec3d endp = Vec3d::Zero(); // pillar end on the model surface
+            Contour3D tail;             // the flipped pinhead on the model
+        };
+
+        // Whether a head can be connected to a nearby pillar depends on the
+        // heads routed before, the nearby pillars are searched sequentially.
+        // The routes in case there is no such pillar do not depend on the
+        // other heads, these are calculated in parallel beforehand.
+        std::vector<Route> routes(m_iheads_onmodel.size());
 
         // TODO: connect these to the ground pillars if possible
         ccr::enumerate(m_iheads_onmodel.begin(), m_iheads_onmodel.end(),
-                       [this, routedown, &modelpillars, &mutex]
+                       [this, &routes]
                        (const std::pair<unsigned, EigenMesh3D::hit_result> &el,
-                        size_t)
+                        size_t n)
         {
             m_thr();
-            unsigned idx = el.first;
             EigenMesh3D::hit_result hit = el.second;
+            Route& route = routes[n];
 
-            auto& head = m_result.head(idx);
+            const Head& head = m_result.head(el.first);
             Vec3d hjp = head.junction_point();
 
-            // /////////////////////////////////////////////////////////////////
-            // Search nearby pillar
-            // /////////////////////////////////////////////////////////////////
-
-            if(search_pillar_and_connect(head)) { head.transform(); return; }
-
             // /////////////////////////////////////////////////////////////////
             // Try straight path
             // /////////////////////////////////////////////////////////////////
@@ -2044,19 +2136,22 @@ public:
             // a route to the ground.
 
             double t = bridge_mesh_intersect(hjp, head.dir, head.r_back_mm);
-            double d = 0, tdown = 0;
+            double d = 0;
+            bool collides_down = true;
             Vec3d dirdown(0.0, 0.0, -1.0);
 
             t = std::min(t, m_cfg.max_bridge_length_mm);
 
-            while(d < t && !std::isinf(tdown = bridge_mesh_intersect(
-                                           hjp + d*head.dir,
-                                           dirdown, head.r_back_mm))) {
+            while(d < t && (collides_down = bridge_mesh_collides(
+                                hjp + d*head.dir,
+                                dirdown, head.r_back_mm))) {
                 d += head.r_back_mm;
             }
 
-            if(std::isinf(tdown)) { // we heave found a route to the ground
-                routedown(head, head.dir, d); return;
+            if(!collides_down) { // we heave found a route to the ground
+                route.type = Route::rtGround;
+                route.dir = head.dir; route.length = d;
+                return;
             }
 
             // /////////////////////////////////////////////////////////////////
@@ -2110,15 +2205,17 @@ public:
 
             t = std::min(t, m_cfg.max_bridge_length_mm);
 
-            while(d < t && !std::isinf(tdown = bridge_mesh_intersect(
-                                           hjp + d*bridgedir,
-                                           dirdown,
-                                           head.r_back_mm))) {
+            while(d < t && (collides_down = bridge_mesh_collides(
+                                hjp + d*bridgedir,
+                                dirdown,
+                                head.r_back_mm))) {
                 d += head.r_back_mm;
             }
 
-            if(std::isinf(tdown)) { // we heave found a route to the ground
-                routedown(head, bridgedir, d); return;
+            if(!collides_down) { // we heave found a route to the ground
+                route.type = Route::rtGround;
+                route.dir = bridgedir; route.length = d;
+                return;
             }
 
             // /////////////////////////////////////////////////////////////////
@@ -2140,12 +2237,6 @@ public:
                 Vec3d hitp = std::abs(hitdiff) < 2*head.r_back_mm?
                                 center_hit.position() : hit.position();
 
-                head.transform();
-
-                Pillar& pill = m_result.add_pillar(unsigned(head.id),
-                                                   endp,
-                                                   head.r_back_mm);
-
                 Vec3d taildir = endp - hitp;
                 double dist = distance(endp, hitp) + m_cfg.head_penetration_mm;
                 double w = dist - 2 * head.r_pin_mm - head.r_back_mm;
@@ -2158,20 +2249,52 @@ public:
                               hitp);
 
                 tailhead.transform();
-                pill.base = tailhead.mesh;
+
+                route.type = Route::rtModel;
+                route.endp = endp;
+                route.tail = std::move(tailhead.mesh);
+            }
+        });
+
+        std::vector<unsigned> modelpillars;
+
+        for(size_t n = 0; n < routes.size(); ++n) {
+            m_thr();
+            unsigned idx = m_iheads_onmodel[n].first;
+            Route& route = routes[n];
+
+            auto& head = m_result.head(idx);
+
+            // /////////////////////////////////////////////////////////////////
+            // Search nearby pillar
+            // /////////////////////////////////////////////////////////////////
+
+            if(search_pillar_and_connect(head)) { head.transform(); continue; }
+
+            switch(route.type) {
+            case Route::rtGround:
+                routedown(head, route.dir, route.length);
+                break;
+            case Route::rtModel: {
+                head.transform();
+
+                Pillar& pill = m_result.add_pillar(unsigned(head.id),
+                                                   route.endp,
+                                                   head.r_back_mm);
+                pill.base = std::move(route.tail);
 
                 // Experimental: add the pillar to the index for cascading
-                std::lock_guard<ccr::Mutex> lk(mutex);
                 modelpillars.emplace_back(unsigned(pill.id));
-                return;
+                break;
             }
-
-            // We have failed to route this head.
-            BOOST_LOG_TRIVIAL(warning)
-                    << "Failed to route model facing support point."
-                    << " ID: " << idx;
-            head.invalidate();
-        });
+            case Route::rtFailed:
+                // We have failed to route this head.
+                BOOST_LOG_TRIVIAL(warning)
+                        << "Failed to route model facing support point."
+                        << " ID: " << idx;
+                head.invalidate();
+            }
+        }
 
         for(auto pillid : modelpillars) {
             auto& pillar = m_result.pillar(pillid);
@@ -2345,11 +2468,12 @@ public:
                     spts[n] = s;
                     
                     // Check the path vertically down                    
-                    auto hr = bridge_mesh_intersect(s, {0, 0, -1}, pillar().r);
+                    bool collides = bridge_mesh_collides(s, {0, 0, -1},
+                                                         pillar().r);
                     Vec3d gndsp{s(X), s(Y), gnd};
                     
                     // If the path is clear, check for pillar base collisions
-                    canplace[n] = std::isinf(hr.distance()) &&
+                    canplace[n] = !collides &&
                                   std::sqrt(m_mesh.squared_distance(gndsp)) >
                                       min_dist;
                 }
@@ -18,6 +18,7 @@
 #pragma warning(disable: 4267)
 #endif
 #include <igl/ray_mesh_intersect.h>
+#include <igl/raytri.c> // intersect_triangle1() for the ray bundles
 #include <igl/point_mesh_squared_distance.h>
 #include <igl/remove_duplicate_vertices.h>
 #include <igl/signed_distance.h>
@@ -231,22 +232,151 @@ EigenMesh3D &EigenMesh3D::operator=(const EigenMesh3D &other)
     m_aabb.reset(new AABBImpl(*other.m_aabb)); return *this;
 }
 
+namespace {
+
+// A ray of a bundle cast on the AABB tree by EigenMesh3D::query_ray_hits()
+// and EigenMesh3D::any_ray_hit().
+struct BundleRay {
+    Vec3d source, dir, inv_dir;
+    bool  sign[3];
+    float t;            // the closest hit found so far
+    double max_t;       // hits are searched for in the interval (0, max_t)
+    int   face_id = -1;
+
+    BundleRay(const Vec3d &s, const Vec3d &d, double maxt):
+        source(s), dir(d), inv_dir(1./d(X), 1./d(Y), 1./d(Z)),
+        t(std::numeric_limits<float>::infinity()), max_t(maxt)
+    {
+        for(int i = 0; i < 3; ++i) sign[i] = inv_dir(i) < 0;
+    }
+
+    // Same as igl::ray_box_intersect() for the interval [0, max_t), with
+    // the inverse direction calculated only once per ray.
+    bool hits_box(const Eigen::AlignedBox<double, 3> &box) const
+    {
+        const Eigen::Vector3d &lo = box.min(), &hi = box.max();
+
+        double tmin = ((sign[X] ? hi : lo)(X) - source(X)) * inv_dir(X);
+        double tmax = ((sign[X] ? lo : hi)(X) - source(X)) * inv_dir(X);
+        double tymin = ((sign[Y] ? hi : lo)(Y) - source(Y)) * inv_dir(Y);
+        double tymax = ((sign[Y] ? lo : hi)(Y) - source(Y)) * inv_dir(Y);
+        if(tmin > tymax || tymin > tmax) return false;
+        if(tymin > tmin) tmin = tymin;
+        if(tymax < tmax) tmax = tymax;
+
+        double tzmin = ((sign[Z] ? hi : lo)(Z) - source(Z)) * inv_dir(Z);
+        double tzmax = ((sign[Z] ? lo : hi)(Z) - source(Z)) * inv_dir(Z);
+        if(tmin > tzmax || tzmin > tmax) return false;
+        if(tzmin > tmin) tmin = tzmin;
+        if(tzmax < tmax) tmax = tzmax;
+
+        return tmin < max_t && tmax > 0.;
+    }
+
+    // Same as igl::ray_mesh_intersect() for a single triangle. Returns true
+    // if the triangle is hit closer than any triangle tested before.
+    bool hits_triangle(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F,
+                       int fid)
+    {
+        Vec3d v0 = V.row(F(fid, 0)), v1 = V.row(F(fid, 1)),
+              v2 = V.row(F(fid, 2));
+        double tt, u, v;
+        if(!intersect_triangle1(source.data(), dir.data(), v0.data(),
+                                v1.data(), v2.data(), &tt, &u, &v) ||
+           !(tt > 0) || !(double(float(tt)) < max_t))
+            return false;
+
+        t = float(tt); max_t = double(t); face_id = fid;
+        return true;
+    }
+};
+
+using AABBTree = igl::AABB<Eigen::MatrixXd, 3>;
+
+// Depth first traversal of the AABB tree by the rays of the bundle listed in
+// active[begin, end). The rays which hit the box of the node are appended to
+// the active list for the traversal of the children. For each ray, the boxes
+// and triangles are tested in the same order as igl::AABB::intersect_ray()
+// does. In the any_hit mode, returns true on the first hit found.
+bool intersect_bundle(const AABBTree &node,
+                      const Eigen::MatrixXd &V,
+                      const Eigen::MatrixXi &F,
+                      std::vector<BundleRay> &rays,
+                      std::vector<unsigned> &active,
+                      size_t begin,
+                      bool any_hit)
+{
+    size_t end = active.size();
+    for(size_t i = begin; i < end; ++i)
+        if(rays[active[i]].hits_box(node.m_box)) active.emplace_back(active[i]);
+
+    bool done = false;
+    if(node.is_leaf()) {
+        for(size_t i = end; i < active.size() && !done; ++i)
+            done = rays[active[i]].hits_triangle(V, F, node.m_primitive) &&
+                   any_hit;
+    } else if(active.size() > end) {
+        done = intersect_bundle(*node.m_left, V, F, rays, active, end, any_hit) ||
+               intersect_bundle(*node.m_right, V, F, rays, active, end, any_hit);
+    }
+
+    active.resize(end);
+    return done;
+}
+
+}
+
 EigenMesh3D::hit_result
 EigenMesh3D::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
 {
-    igl::Hit hit;
-    hit.t = std::numeric_limits<float>::infinity();
-    m_aabb->intersect_ray(m_V, m_F, s, dir, hit);
+    return query_ray_hits({s}, {dir}).front();
+}
+
+std::vector<EigenMesh3D::hit_result>
+EigenMesh3D::query_ray_hits(const std::vector<Vec3d> &sources,
+                            const std::vector<Vec3d> &dirs) const
+{
+    assert(sources.size() == dirs.size());
+
+    std::vector<BundleRay> rays;
+    rays.reserve(sources.size());
+    std::vector<unsigned> active;
+    for(size_t i = 0; i < sources.size(); ++i) {
+        rays.emplace_back(sources[i], dirs[i],
+                          std::numeric_limits<double>::infinity());
+        active.emplace_back(unsigned(i));
+    }
 
-    hit_result ret(*this);
-    ret.m_t = double(hit.t);
-    ret.m_dir = dir;
-    ret.m_source = s;
-    if(!std::isinf(hit.t) && !std::isnan(hit.t)) ret.m_face_id = hit.id;
+    intersect_bundle(*m_aabb, m_V, m_F, rays, active, 0, false);
+
+    std::vector<hit_result> ret(rays.size(), hit_result(*this));
+    for(size_t i = 0; i < rays.size(); ++i) {
+        ret[i].m_t = double(rays[i].t);
+        ret[i].m_dir = dirs[i];
+        ret[i].m_source = sources[i];
+        if(!std::isinf(rays[i].t)) ret[i].m_face_id = rays[i].face_id;
+    }
 
     return ret;
 }
 
+bool EigenMesh3D::any_ray_hit(const std::vector<Vec3d> &sources,
+                              const std::vector<Vec3d> &dirs,
+                              double max_distance) const
+{
+    assert(sources.size() == dirs.size());
+
+    std::vector<BundleRay> rays;
+    rays.reserve(sources.size());
+    std::vector<unsigned> active;
+    for(size_t i = 0; i < sources.size(); ++i) {
+        rays.emplace_back(sources[i], dirs[i], max_distance);
+        active.emplace_back(unsigned(i));
+    }
+
+    return intersect_bundle(*m_aabb, m_V, m_F, rays, active, 0, true);
+}
+
 #ifdef SLIC3R_SLA_NEEDS_WINDTREE
 EigenMesh3D::si_result EigenMesh3D::signed_distance(const Vec3d &p) const {
     double sign = 0; double sqdst = 0; int i = 0;  Vec3d c;
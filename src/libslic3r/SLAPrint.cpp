@@ -10,6 +10,8 @@
 #include <numeric>
 
 #include <tbb/parallel_for.h>
+#include <tbb/pipeline.h>
+#include <tbb/task_scheduler_init.h>
 #include <boost/filesystem/path.hpp>
 #include <boost/log/trivial.hpp>
 
@@ -448,7 +450,7 @@ SLAPrint::ApplyStatus SLAPrint::apply(const Model &model, DynamicPrintConfig con
     }
     
     if(m_objects.empty()) {
-        m_printer.release();
+        m_printer.reset();
         m_printer_input.clear();
         m_print_statistics.clear();
     }
@@ -1431,8 +1433,34 @@ void SLAPrint::process()
         // Sequential version (for testing)
         // for(unsigned l = 0; l < lvlcnt; ++l) process_level(l);
 
+        // The compressed layers are streamed into a temporary file in the
+        // order of the layers, as soon as all the layers below are finished.
+        // The number of layers rasterized ahead is limited to keep the memory
+        // use bounded.
+        printer.start_spooling();
+        const size_t max_layers_in_flight = 2 * size_t(
+            std::max(1, tbb::task_scheduler_init::default_num_threads()));
+        unsigned next_level = 0;
+
         // Print all the layers in parallel
-        tbb::parallel_for<unsigned, decltype(lvlfn)>(0, lvlcnt, lvlfn);
+        tbb::parallel_pipeline(max_layers_in_flight,
+            tbb::make_filter<void, unsigned>(tbb::filter::serial_in_order,
+                [this, &next_level, lvlcnt](tbb::flow_control &fc) -> unsigned {
+                    if(next_level == lvlcnt || canceled()) {
+                        fc.stop();
+                        return 0;
+                    }
+                    return next_level++;
+                }) &
+            tbb::make_filter<unsigned, unsigned>(tbb::filter::parallel,
+                [&lvlfn](unsigned level_id) -> unsigned {
+                    lvlfn(level_id);
+                    return level_id;
+                }) &
+            tbb::make_filter<unsigned, void>(tbb::filter::serial_in_order,
+                [&printer](unsigned level_id) {
+                    printer.spool_layer(level_id);
+                }));
 
         // Set statistics values to the printer
         m_printer->set_statistics(
@@ -0,0 +1,227 @@
+#include "SliceCache.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+
+// The points of a polygon are stored as a single binary block.
+namespace cereal {
+	template<class Archive> void save(Archive &archive, const Slic3r::Polygon &polygon) {
+		uint64_t num_points = polygon.points.size();
+		archive(num_points);
+		archive.saveBinary((const char*)polygon.points.data(), num_points * sizeof(Slic3r::Point));
+	}
+	template<class Archive> void load(Archive &archive, Slic3r::Polygon &polygon) {
+		uint64_t num_points = 0;
+		archive(num_points);
+		polygon.points.assign(size_t(num_points), Slic3r::Point());
+		archive.loadBinary((char*)polygon.points.data(), num_points * sizeof(Slic3r::Point));
+	}
+	template<class Archive> void serialize(Archive &archive, Slic3r::ExPolygon &expolygon) { archive(expolygon.contour, expolygon.holes); }
+}
+
+namespace Slic3r {
+
+// Bump the version if the file format or the output of the slicer changes.
+static const uint32_t SLICE_CACHE_VERSION = 1;
+static const char    *SLICE_CACHE_EXTENSION = ".slices";
+
+static std::mutex               g_slice_cache_mutex;
+// Following are guarded by g_slice_cache_mutex.
+static boost::filesystem::path  g_slice_cache_dir;
+static size_t                   g_slice_cache_max_size  = 0;
+// Estimate of the total size of the cache files, refreshed when the cache is trimmed.
+static size_t                   g_slice_cache_size      = 0;
+
+static std::atomic<size_t>      g_slice_cache_hits(0);
+static std::atomic<size_t>      g_slice_cache_misses(0);
+
+// Delete the least recently used files until the cache fits into 90% of its size limit.
+// To be called with g_slice_cache_mutex locked.
+static void slice_cache_trim()
+{
+    namespace fs = boost::filesystem;
+    struct CacheFile {
+        fs::path    path;
+        size_t      size;
+        std::time_t last_used;
+    };
+    std::vector<CacheFile> files;
+    size_t                 total_size = 0;
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(g_slice_cache_dir, ec), end; ! ec && it != end; it.increment(ec))
+        if (it->path().extension() == SLICE_CACHE_EXTENSION) {
+            boost::system::error_code ec2;
+            CacheFile file { it->path(), size_t(fs::file_size(it->path(), ec2)), fs::last_write_time(it->path(), ec2) };
+            if (! ec2) {
+                total_size += file.size;
+                files.emplace_back(std::move(file));
+            }
+        }
+    std::sort(files.begin(), files.end(), [](const CacheFile &f1, const CacheFile &f2) { return f1.last_used < f2.last_used; });
+    size_t num_deleted = 0;
+    for (const CacheFile &file : files) {
+        if (total_size <= g_slice_cache_max_size / 10 * 9)
+            break;
+        if (fs::remove(file.path, ec)) {
+            total_size -= file.size;
+            ++ num_deleted;
+        }
+    }
+    g_slice_cache_size = total_size;
+    BOOST_LOG_TRIVIAL(debug) << "Slice cache trimmed, " << num_deleted << " files deleted, " << format_memsize_MB(total_size) << " kept";
+}
+
+void SliceCache::set_directory(const std::string &dir, size_t max_size_bytes)
+{
+    std::lock_guard<std::mutex> lock(g_slice_cache_mutex);
+    g_slice_cache_dir.clear();
+    g_slice_cache_max_size = max_size_bytes;
+    g_slice_cache_size     = 0;
+    if (dir.empty())
+        return;
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(dir, ec);
+    if (! boost::filesystem::is_directory(dir, ec)) {
+        BOOST_LOG_TRIVIAL(error) << "Slice cache directory " << dir << " could not be created, the slice cache is disabled";
+        return;
+    }
+    g_slice_cache_dir = dir;
+    // Calculate the size of the cache, trim it to the new limit.
+    slice_cache_trim();
+}
+
+bool SliceCache::enabled()
+{
+    std::lock_guard<std::mutex> lock(g_slice_cache_mutex);
+    return ! g_slice_cache_dir.empty();
+}
+
+static boost::filesystem::path slice_cache_file(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(g_slice_cache_mutex);
+    return g_slice_cache_dir.empty() ? boost::filesystem::path() : g_slice_cache_dir / (key + SLICE_CACHE_EXTENSION);
+}
+
+bool SliceCache::load(const std::string &key, std::vector<ExPolygons> &slices)
+{
+    boost::filesystem::path path = slice_cache_file(key);
+    if (path.empty())
+        return false;
+    bool loaded = false;
+    {
+        boost::nowide::ifstream ifs(path.string(), std::ios::in | std::ios::binary);
+        if (ifs.good()) {
+            try {
+                cereal::BinaryInputArchive archive(ifs);
+                uint32_t version = 0;
+                archive(version);
+                if (version == SLICE_CACHE_VERSION) {
+                    archive(slices);
+                    loaded = true;
+                }
+            } catch (const std::exception &ex) {
+                BOOST_LOG_TRIVIAL(error) << "Failed to load slice cache file " << path.string() << ": " << ex.what();
+            }
+        }
+    }
+    boost::system::error_code ec;
+    if (loaded) {
+        // Mark the file as recently used for slice_cache_trim().
+        boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+        ++ g_slice_cache_hits;
+    } else {
+        // Delete a corrupted file or a file of an old version.
+        boost::filesystem::remove(path, ec);
+        slices.clear();
+        ++ g_slice_cache_misses;
+    }
+    return loaded;
+}
+
+void SliceCache::store(const std::string &key, const std::vector<ExPolygons> &slices)
+{
+    namespace fs = boost::filesystem;
+    fs::path path = slice_cache_file(key);
+    if (path.empty())
+        return;
+    // Write into a temporary file first, so that another process sharing the cache directory never reads an incomplete file.
+    boost::system::error_code ec;
+    fs::path path_tmp = path.parent_path() / fs::unique_path("%%%%-%%%%-%%%%-%%%%.tmp", ec);
+    if (ec)
+        return;
+    bool written = false;
+    {
+        boost::nowide::ofstream ofs(path_tmp.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (ofs.good()) {
+            try {
+                cereal::BinaryOutputArchive archive(ofs);
+                archive(SLICE_CACHE_VERSION, slices);
+            } catch (const std::exception &ex) {
+                BOOST_LOG_TRIVIAL(error) << "Failed to write slice cache file " << path_tmp.string() << ": " << ex.what();
+            }
+            ofs.close();
+            written = ! ofs.fail();
+        }
+    }
+    size_t file_size = written ? size_t(fs::file_size(path_tmp, ec)) : 0;
+    if (! written || ec || rename_file(path_tmp.string(), path.string()) != 0) {
+        fs::remove(path_tmp, ec);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_slice_cache_mutex);
+    g_slice_cache_size += file_size;
+    if (g_slice_cache_size > g_slice_cache_max_size)
+        slice_cache_trim();
+}
+
+size_t SliceCache::hits()
+{
+    return g_slice_cache_hits;
+}
+
+size_t SliceCache::misses()
+{
+    return g_slice_cache_misses;
+}
+
+SliceCache::Key::Key() :
+    // FNV-1a offset basis and the same with the 32 bit halves swapped.
+    m_hash1(0xcbf29ce484222325ULL), m_hash2(0x84222325cbf29ce4ULL)
+{
+    this->append(SLICE_CACHE_VERSION);
+}
+
+void SliceCache::Key::append(const void *data, size_t size)
+{
+    // Two independent 64 bit hashes: FNV-1a and a rotate-multiply hash with the golden ratio constant.
+    const unsigned char *p  = (const unsigned char*)data;
+    uint64_t             h1 = m_hash1;
+    uint64_t             h2 = m_hash2;
+    for (size_t i = 0; i < size; ++ i) {
+        h1 = (h1 ^ p[i]) * 0x100000001b3ULL;
+        h2 = (((h2 << 5) | (h2 >> 59)) ^ p[i]) * 0x9e3779b97f4a7c15ULL;
+    }
+    m_hash1 = h1;
+    m_hash2 = h2;
+}
+
+std::string SliceCache::Key::digest() const
+{
+    char buf[40];
+    sprintf(buf, "%016llx%016llx", (unsigned long long)m_hash1, (unsigned long long)m_hash2);
+    return buf;
+}
+
+} // namespace Slic3r
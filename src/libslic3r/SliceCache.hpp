@@ -0,0 +1,53 @@
+#ifndef slic3r_SliceCache_hpp_
+#define slic3r_SliceCache_hpp_
+
+#include <string>
+#include <vector>
+
+#include "libslic3r.h"
+#include "ExPolygon.hpp"
+
+namespace Slic3r {
+
+// Persistent cache of the mesh slices, shared by all the PrintObjects of the process.
+// The slices of a set of volumes at a set of Z levels are stored into a directory as a single file per query,
+// named by a hash of the query (the meshes, their transformations, the slicing parameters and the Z levels).
+// The cache is disabled until a directory is assigned by set_directory().
+// If the total size of the cache files exceeds the limit, the least recently used files are deleted.
+// The methods may be called from multiple threads.
+class SliceCache
+{
+public:
+    // Enable the cache at the given directory, the directory is created if it does not exist.
+    // An empty path disables the cache.
+    static void set_directory(const std::string &dir, size_t max_size_bytes);
+    static bool enabled();
+
+    // Returns true and fills in the slices if the key was found in the cache.
+    static bool load(const std::string &key, std::vector<ExPolygons> &slices);
+    static void store(const std::string &key, const std::vector<ExPolygons> &slices);
+
+    // Number of load() calls, which found / did not find the slices in the cache.
+    static size_t hits();
+    static size_t misses();
+
+    // Builder of the cache key from the inputs of the slicing.
+    class Key
+    {
+    public:
+        Key();
+        void        append(const void *data, size_t size);
+        template<typename T> void append(const T &value) { this->append(&value, sizeof(T)); }
+        template<typename T> void append(const std::vector<T> &values) { this->append(values.size()); this->append(values.data(), values.size() * sizeof(T)); }
+        // 128 bit hash as 32 hexadecimal digits.
+        std::string digest() const;
+
+    private:
+        uint64_t    m_hash1;
+        uint64_t    m_hash2;
+    };
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_SliceCache_hpp_ */
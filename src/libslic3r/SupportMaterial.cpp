@@ -783,7 +783,7 @@ namespace SupportMaterialInternal {
     static inline bool has_bridging_perimeters(const ExtrusionLoop &loop)
     {
         for (const ExtrusionPath &ep : loop.paths)
-            if (ep.role() == erOverhangPerimeter && ! ep.polyline.empty())
+            if (ep.role() == erOverhangPerimeter && ! ep.empty())
                 return ep.size() >= (ep.is_closed() ? 3 : 2);
             return false;
     }
@@ -832,14 +832,16 @@ namespace SupportMaterialInternal {
     {
         assert(expansion_scaled >= 0.f);
         for (const ExtrusionPath &ep : loop.paths)
-            if (ep.role() == erOverhangPerimeter && ! ep.polyline.empty()) {
+            if (ep.role() == erOverhangPerimeter && ! ep.empty()) {
                 float exp = 0.5f * (float)scale_(ep.width) + expansion_scaled;
+                Polyline decoded;
+                const Polyline &polyline = ep.decoded_polyline(decoded);
                 if (ep.is_closed()) {
                     if (ep.size() >= 3) {
                         // This is a complete loop.
                         // Add the outer contour first.
                         Polygon poly;
-                        poly.points = ep.polyline.points;
+                        poly.points = polyline.points;
                         poly.points.pop_back();
                         if (poly.area() < 0)
                             poly.reverse();
@@ -850,7 +852,7 @@ namespace SupportMaterialInternal {
                     }
                 } else if (ep.size() >= 2) {
                     // Offset the polyline.
-                    polygons_append(out, offset(ep.polyline, exp, SUPPORT_SURFACES_OFFSET_PARAMETERS));
+                    polygons_append(out, offset(polyline, exp, SUPPORT_SURFACES_OFFSET_PARAMETERS));
                 }
             }
     }
@@ -1433,152 +1435,97 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
     if (! top_contacts.empty()) 
     {
         // There is some support to be built, if there are non-empty top surfaces detected.
-        // Sum of unsupported contact areas above the current layer.print_z.
-        Polygons  projection;
-        // Last top contact layer visited when collecting the projection of contact areas.
-        int       contact_idx = int(top_contacts.size()) - 1;
-        for (int layer_id = int(object.total_layer_count()) - 2; layer_id >= 0; -- layer_id) {
-            BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
-            const Layer &layer = *object.get_layer(layer_id);
-            // Collect projections of all contact areas above or at the same level as this top surface.
-            for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx) {
-                Polygons polygons_new;
-                // Contact surfaces are expanded away from the object, trimmed by the object.
-                // Use a slight positive offset to overlap the touching regions.
+        // Projections of the contact areas of the top contact layers, calculated in parallel.
+        std::vector<Polygons> contact_projections(top_contacts.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, top_contacts.size()),
+            [&top_contacts, &contact_projections](const tbb::blocked_range<size_t>& range) {
+                for (size_t contact_idx = range.begin(); contact_idx < range.end(); ++ contact_idx) {
+                    Polygons polygons_new;
+                    // Contact surfaces are expanded away from the object, trimmed by the object.
+                    // Use a slight positive offset to overlap the touching regions.
 #if 0
-                // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->contact_polygons, SCALED_EPSILON));
+                    // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
+                    polygons_append(polygons_new, offset(*top_contacts[contact_idx]->contact_polygons, SCALED_EPSILON));
 #else
-                // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
-                // than the grid cells.
-                polygons_append(polygons_new, std::move(*top_contacts[contact_idx]->contact_polygons));
+                    // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
+                    // than the grid cells.
+                    polygons_append(polygons_new, std::move(*top_contacts[contact_idx]->contact_polygons));
 #endif
-                // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
-                // Use a slight positive offset to overlap the touching regions.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->overhang_polygons, double(SCALED_EPSILON)));
-                polygons_append(projection, union_(polygons_new));
-            }
-            if (projection.empty())
-                continue;
-            Polygons projection_raw = union_(projection);
+                    // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
+                    // Use a slight positive offset to overlap the touching regions.
+                    polygons_append(polygons_new, offset(*top_contacts[contact_idx]->overhang_polygons, double(SCALED_EPSILON)));
+                    contact_projections[contact_idx] = union_(polygons_new);
+                }
+            });
 
-            tbb::task_group task_group;
-            if (! m_object_config->support_material_buildplate_only)
-                // Find the bottom contact layers above the top surfaces of this layer.
-                task_group.run([this, &object, &top_contacts, contact_idx, &layer, layer_id, &layer_storage, &layer_support_areas, &bottom_contacts, &projection_raw] {
-                    Polygons top = collect_region_slices_by_type(layer, stPosTop| stDensSolid);
-        #ifdef SLIC3R_DEBUG
-                    {
-                        BoundingBox bbox = get_extents(projection_raw);
-                        bbox.merge(get_extents(top));
-                        ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                        svg.draw(union_ex(top, false), "blue", 0.5f);
-                        svg.draw(union_ex(projection_raw, true), "red", 0.5f);
-                        svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
-                        svg.draw(layer.slices.expolygons, "green", 0.5f);
+        // The projection of the contact areas is swept top-down over the object layers. The projection at a layer depends
+        // on the projection at the layer above, therefore the sweep itself is serial. The object layers are processed
+        // in windows of a fixed number of layers, the sweep over a window is preceded by a parallel collection of the object
+        // surfaces of the window and followed by a parallel detection of the bottom contact layers of the window.
+        // The result is the same as if the object layers were processed one by one.
+        struct SweepLayer
+        {
+            // Object slices slightly expanded, trimming the projection.
+            Polygons    trimming;
+            // Top surfaces of the object layer.
+            Polygons    top;
+            // Projection of the contact areas above this layer, not trimmed by this layer yet.
+            Polygons    projection_raw;
+            // Index of the last top contact layer above this layer.
+            int         contact_idx;
+            // Bottom contact layer over the top surfaces of this object layer.
+            bool        has_bottom_contact = false;
+            coordf_t    print_z;
+            coordf_t    height;
+            coordf_t    height_block;
+            Polygons    polygons;
+            // Area of the bottom contact layer trimming the support areas of the object layers above.
+            Polygons    touching;
+        };
+        // Number of object layers per window, limiting the memory held by the SweepLayer records.
+        static const int sweep_window = 64;
+        const bool find_bottom_contacts = ! m_object_config->support_material_buildplate_only;
+        std::vector<SweepLayer> sweep(sweep_window);
+        // For each object layer, the bottom contact layers of the current window trimming its support areas, in the order of the sweep.
+        std::vector<std::vector<int>> trimmed_by(object.total_layer_count());
+        // Object layers with a non-empty trimmed_by list.
+        std::vector<int>              trimmed_layers;
+        // Sum of unsupported contact areas above the current layer.print_z.
+        Polygons  projection;
+        // Last top contact layer visited when collecting the projection of contact areas.
+        int       contact_idx = int(top_contacts.size()) - 1;
+        for (int window_top = int(object.total_layer_count()) - 2; window_top >= 0; window_top -= sweep_window) {
+            int window_bottom = std::max(0, window_top - sweep_window + 1);
+            for (SweepLayer &sweep_layer : sweep)
+                sweep_layer = SweepLayer();
+
+            // 1) Collect the trimming polygons and the top surfaces of the window in parallel.
+            tbb::parallel_for(tbb::blocked_range<int>(window_bottom, window_top + 1),
+                [&object, &sweep, window_top, find_bottom_contacts](const tbb::blocked_range<int>& range) {
+                    for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                        const Layer &layer       = *object.get_layer(layer_id);
+                        SweepLayer  &sweep_layer = sweep[window_top - layer_id];
+                        // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
+            //            Polygons trimming = union_(to_polygons(layer.slices.expolygons), touching, true);
+                        sweep_layer.trimming = offset(layer.slices.expolygons, double(SCALED_EPSILON));
+                        if (find_bottom_contacts)
+                            sweep_layer.top = collect_region_slices_by_type(layer, stPosTop| stDensSolid);
                     }
-        #endif /* SLIC3R_DEBUG */
-
-                    // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
-                    // top surfaces above layer.print_z falls onto this top surface. 
-                    // Touching are the contact surfaces supported exclusively by this top surfaces.
-                    // Don't use a safety offset as it has been applied during insertion of polygons.
-                    if (! top.empty()) {
-                        Polygons touching = intersection(top, projection_raw, false);
-                        if (! touching.empty()) {
-                            // Allocate a new bottom contact layer.
-                            MyLayer &layer_new = layer_allocate(layer_storage, sltBottomContact);
-                            bottom_contacts.push_back(&layer_new);
-                            // Grow top surfaces so that interface and support generation are generated
-                            // with some spacing from object - it looks we don't need the actual
-                            // top shapes so this can be done here
-                            //FIXME calculate layer height based on the actual thickness of the layer:
-                            // If the layer is extruded with no bridging flow, support just the normal extrusions.
-                            layer_new.height = m_slicing_params.soluble_interface ?
-                                // Align the interface layer with the object's layer height.
-                                object.layers()[layer_id + 1]->height :
-                                // Place a bridge flow interface layer over the top surface.
-                                //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
-                                // According to Jindrich the bottom surfaces work well.
-                                //FIXME test the bridging flow instead?
-                                m_support_material_interface_flow.nozzle_diameter;
-                            layer_new.height_block = ((m_object_config->support_material_contact_distance_type == zdPlane) ? object.layers()[layer_id + 1]->height : layer_new.height);
-                            layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
-                                (layer.print_z + layer_new.height_block + this->m_slicing_params.gap_object_support);
-                            layer_new.bottom_z = layer.print_z;
-                            layer_new.idx_object_layer_below = layer_id;
-                            layer_new.bridging = ! m_slicing_params.soluble_interface;
-                            //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
-                            //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
-                            layer_new.polygons = offset(touching, double(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
-                            if (! m_slicing_params.soluble_interface) {
-                                // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
-                                // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
-                                for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
-                                    top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
-                                    ++ top_idx) {
-                                    if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
-                                        // A top layer has been found, which is close to the new bottom layer.
-                                        coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
-                                        assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
-                                        if (diff > 0.) {
-                                            // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
-                                            assert(diff < layer_new.height + EPSILON);
-                                            assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        } else {
-                                            // The top contact layer is above this layer. One may either make this layer thicker or thinner.
-                                            // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
-                                            // By making the layer thinner, one adds one more discrete layer.
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        }
-                                        break;
-                                    }
-                                }
-                            }
-
-                #ifdef SLIC3R_DEBUG
-                            Slic3r::SVG::export_expolygons(
-                                debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
-                                union_ex(layer_new.polygons, false));
-                #endif /* SLIC3R_DEBUG */
-                            // Trim the already created base layers above the current layer intersecting with the new bottom contacts layer.
-                            //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
-                            touching = offset(touching, double(SCALED_EPSILON));
-                            for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
-                                const Layer &layer_above = *object.layers()[layer_id_above];
-                                if (layer_above.print_z > layer_new.print_z - EPSILON)
-                                    break; 
-                                if (! layer_support_areas[layer_id_above].empty()) {
-#ifdef SLIC3R_DEBUG
-                                    {
-                                        BoundingBox bbox = get_extents(touching);
-                                        bbox.merge(get_extents(layer_support_areas[layer_id_above]));
-                                        ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
-                                        svg.draw(union_ex(touching, false), "blue", 0.5f);
-                                        svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
-                                        svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
-                                    }
-#endif /* SLIC3R_DEBUG */
-                                    layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
-#ifdef SLIC3R_DEBUG
-                                    Slic3r::SVG::export_expolygons(
-                                        debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
-                                        union_ex(layer_support_areas[layer_id_above], false));
-#endif /* SLIC3R_DEBUG */
-                                }
-                            }
-                        }
-                    } // ! top.empty()
                 });
 
-            Polygons &layer_support_area = layer_support_areas[layer_id];
-            task_group.run([this, &projection, &projection_raw, &layer, &layer_support_area, layer_id] {
-                // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
-    //            Polygons trimming = union_(to_polygons(layer.slices.expolygons), touching, true);
-                Polygons trimming = offset(layer.slices.expolygons, double(SCALED_EPSILON));
+            // 2) Sweep the projection over the window.
+            for (int layer_id = window_top; layer_id >= window_bottom; -- layer_id) {
+                BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
+                const Layer &layer       = *object.get_layer(layer_id);
+                SweepLayer  &sweep_layer = sweep[window_top - layer_id];
+                // Collect projections of all contact areas above or at the same level as this top surface.
+                for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx)
+                    polygons_append(projection, std::move(contact_projections[contact_idx]));
+                sweep_layer.contact_idx = contact_idx;
+                if (projection.empty())
+                    continue;
+                Polygons projection_raw = union_(projection);
+                const Polygons &trimming = sweep_layer.trimming;
                 projection = diff(projection_raw, trimming, false);
     #ifdef SLIC3R_DEBUG
                 {
@@ -1590,6 +1537,9 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
                     svg.draw_outline(union_ex(projection, true), "red", "blue", scale_(0.1f));
                 }
     #endif /* SLIC3R_DEBUG */
+                if (! sweep_layer.top.empty())
+                    // Keep the projection for the detection of the bottom contact layers.
+                    sweep_layer.projection_raw = std::move(projection_raw);
                 remove_sticks(projection);
                 remove_degenerate(projection);
         #ifdef SLIC3R_DEBUG
@@ -1605,6 +1555,7 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
                     // Grid spacing.
                     m_object_config->support_material_spacing.value + m_support_material_flow.spacing(),
                     Geometry::deg2rad(m_object_config->support_material_angle.value));
+                Polygons &layer_support_area = layer_support_areas[layer_id];
                 tbb::task_group task_group_inner;
                 // 1) Cache the slice of a support volume. The support volume is expanded by 1/2 of support material flow spacing
                 // to allow a placement of suppot zig-zag snake along the grid lines.
@@ -1636,8 +1587,156 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
                 });
                 task_group_inner.wait();
                 projection = std::move(projection_new);
-            });
-            task_group.wait();
+            }
+
+            if (! find_bottom_contacts)
+                continue;
+
+            // 3) Find the bottom contact layers above the top surfaces of the window layers in parallel.
+            tbb::parallel_for(tbb::blocked_range<int>(window_bottom, window_top + 1),
+                [this, &object, &top_contacts, &sweep, window_top](const tbb::blocked_range<int>& range) {
+                    for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                        const Layer &layer       = *object.get_layer(layer_id);
+                        SweepLayer  &sweep_layer = sweep[window_top - layer_id];
+                        const Polygons &top            = sweep_layer.top;
+                        const Polygons &projection_raw = sweep_layer.projection_raw;
+                        if (top.empty() || projection_raw.empty())
+                            continue;
+        #ifdef SLIC3R_DEBUG
+                        {
+                            BoundingBox bbox = get_extents(projection_raw);
+                            bbox.merge(get_extents(top));
+                            ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
+                            svg.draw(union_ex(top, false), "blue", 0.5f);
+                            svg.draw(union_ex(projection_raw, true), "red", 0.5f);
+                            svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
+                            svg.draw(layer.slices.expolygons, "green", 0.5f);
+                        }
+        #endif /* SLIC3R_DEBUG */
+                        // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
+                        // top surfaces above layer.print_z falls onto this top surface. 
+                        // Touching are the contact surfaces supported exclusively by this top surfaces.
+                        // Don't use a safety offset as it has been applied during insertion of polygons.
+                        Polygons touching = intersection(top, projection_raw, false);
+                        if (touching.empty())
+                            continue;
+                        sweep_layer.has_bottom_contact = true;
+                        // Grow top surfaces so that interface and support generation are generated
+                        // with some spacing from object - it looks we don't need the actual
+                        // top shapes so this can be done here
+                        //FIXME calculate layer height based on the actual thickness of the layer:
+                        // If the layer is extruded with no bridging flow, support just the normal extrusions.
+                        sweep_layer.height = m_slicing_params.soluble_interface ?
+                            // Align the interface layer with the object's layer height.
+                            object.layers()[layer_id + 1]->height :
+                            // Place a bridge flow interface layer over the top surface.
+                            //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
+                            // According to Jindrich the bottom surfaces work well.
+                            //FIXME test the bridging flow instead?
+                            m_support_material_interface_flow.nozzle_diameter;
+                        sweep_layer.height_block = ((m_object_config->support_material_contact_distance_type == zdPlane) ? object.layers()[layer_id + 1]->height : sweep_layer.height);
+                        sweep_layer.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
+                            (layer.print_z + sweep_layer.height_block + this->m_slicing_params.gap_object_support);
+                        //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
+                        //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
+                        sweep_layer.polygons = offset(touching, double(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
+                        if (! m_slicing_params.soluble_interface) {
+                            // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
+                            // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
+                            for (size_t top_idx = size_t(std::max<int>(0, sweep_layer.contact_idx)); 
+                                top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < sweep_layer.print_z + this->m_support_layer_height_min + EPSILON; 
+                                ++ top_idx) {
+                                if (top_contacts[top_idx]->print_z > sweep_layer.print_z - this->m_support_layer_height_min - EPSILON) {
+                                    // A top layer has been found, which is close to the new bottom layer.
+                                    coordf_t diff = sweep_layer.print_z - top_contacts[top_idx]->print_z;
+                                    assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
+                                    if (diff > 0.) {
+                                        // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
+                                        assert(diff < sweep_layer.height + EPSILON);
+                                        assert(sweep_layer.height - diff >= m_support_layer_height_min - EPSILON);
+                                        sweep_layer.print_z  = top_contacts[top_idx]->print_z;
+                                        sweep_layer.height  -= diff;
+                                    } else {
+                                        // The top contact layer is above this layer. One may either make this layer thicker or thinner.
+                                        // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
+                                        // By making the layer thinner, one adds one more discrete layer.
+                                        sweep_layer.print_z  = top_contacts[top_idx]->print_z;
+                                        sweep_layer.height  -= diff;
+                                    }
+                                    break;
+                                }
+                            }
+                        }
+                        sweep_layer.touching = offset(touching, double(SCALED_EPSILON));
+                    }
+                });
+
+            // 4) Allocate the bottom contact layers in the order of the sweep, trim the already created base layers above
+            // the current layer intersecting with the new bottom contacts layer.
+            //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
+            // The support areas trimmed by multiple bottom contact layers are trimmed in the order of the sweep,
+            // the support areas of different object layers are trimmed in parallel.
+            for (int layer_id = window_top; layer_id >= window_bottom; -- layer_id) {
+                SweepLayer &sweep_layer = sweep[window_top - layer_id];
+                if (! sweep_layer.has_bottom_contact)
+                    continue;
+                const Layer &layer   = *object.get_layer(layer_id);
+                MyLayer &layer_new = layer_allocate(layer_storage, sltBottomContact);
+                bottom_contacts.push_back(&layer_new);
+                layer_new.height       = sweep_layer.height;
+                layer_new.height_block = sweep_layer.height_block;
+                layer_new.print_z      = sweep_layer.print_z;
+                layer_new.bottom_z     = layer.print_z;
+                layer_new.idx_object_layer_below = layer_id;
+                layer_new.bridging     = ! m_slicing_params.soluble_interface;
+                layer_new.polygons     = std::move(sweep_layer.polygons);
+    #ifdef SLIC3R_DEBUG
+                Slic3r::SVG::export_expolygons(
+                    debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
+                    union_ex(layer_new.polygons, false));
+    #endif /* SLIC3R_DEBUG */
+                for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
+                    const Layer &layer_above = *object.layers()[layer_id_above];
+                    if (layer_above.print_z > layer_new.print_z - EPSILON)
+                        break; 
+                    if (trimmed_by[layer_id_above].empty())
+                        trimmed_layers.emplace_back(layer_id_above);
+                    trimmed_by[layer_id_above].emplace_back(layer_id);
+                }
+            }
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, trimmed_layers.size()),
+                [&object, &sweep, &trimmed_by, &trimmed_layers, &layer_support_areas, window_top](const tbb::blocked_range<size_t>& range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i) {
+                        int layer_id_above = trimmed_layers[i];
+                        for (int layer_id : trimmed_by[layer_id_above]) {
+                            // Skip the support areas which are empty or which were trimmed empty already.
+                            if (layer_support_areas[layer_id_above].empty())
+                                break;
+                            const Polygons &touching = sweep[window_top - layer_id].touching;
+#ifdef SLIC3R_DEBUG
+                            const Layer &layer       = *object.layers()[layer_id];
+                            const Layer &layer_above = *object.layers()[layer_id_above];
+                            {
+                                BoundingBox bbox = get_extents(touching);
+                                bbox.merge(get_extents(layer_support_areas[layer_id_above]));
+                                ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
+                                svg.draw(union_ex(touching, false), "blue", 0.5f);
+                                svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
+                                svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
+                            }
+#endif /* SLIC3R_DEBUG */
+                            layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
+#ifdef SLIC3R_DEBUG
+                            Slic3r::SVG::export_expolygons(
+                                debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
+                                union_ex(layer_support_areas[layer_id_above], false));
+#endif /* SLIC3R_DEBUG */
+                        }
+                    }
+                });
+            for (int layer_id_above : trimmed_layers)
+                trimmed_by[layer_id_above].clear();
+            trimmed_layers.clear();
         }
         std::reverse(bottom_contacts.begin(), bottom_contacts.end());
 //        trim_support_layers_by_object(object, bottom_contacts, 0., 0., m_gap_xy);
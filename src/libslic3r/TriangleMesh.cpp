@@ -13,6 +13,8 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <chrono>
+#include <numeric>
 #include <math.h>
 #include <type_traits>
 
@@ -726,6 +728,51 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
         if ((i & 0x0ffff) == 0)
             throw_on_cancel();
     }
+
+    this->build_z_index(throw_on_cancel);
+}
+
+void TriangleMeshSlicer::build_z_index(throw_on_cancel_callback_type throw_on_cancel)
+{
+    m_facets_short.clear();
+    m_facets_tall.clear();
+    m_facets_short_height = 0.;
+    const size_t num_facets = this->mesh->stl.stats.number_of_facets;
+    std::vector<FacetZSpan> spans(num_facets);
+    for (size_t facet_idx = 0; facet_idx < num_facets; ++ facet_idx) {
+        const stl_facet &facet = this->mesh->stl.facet_start[facet_idx];
+        FacetZSpan      &span  = spans[facet_idx];
+        span.min_z     = fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2)));
+        span.max_z     = fmaxf(facet.vertex[0](2), fmaxf(facet.vertex[1](2), facet.vertex[2](2)));
+        span.facet_idx = uint32_t(facet_idx);
+    }
+    throw_on_cancel();
+    if (! spans.empty()) {
+        // Split the facets into the short and tall ones at the 99th percentile of the facet heights.
+        // A range of layers is then intersected with the short facets found by a binary search over min_z,
+        // and with a short list of the tall facets.
+        std::vector<double> heights(num_facets);
+        for (size_t i = 0; i < num_facets; ++ i)
+            heights[i] = double(spans[i].max_z) - double(spans[i].min_z);
+        auto it_threshold = heights.begin() + (num_facets * 99) / 100;
+        std::nth_element(heights.begin(), it_threshold, heights.end());
+        const double threshold = *it_threshold;
+        m_facets_short.reserve(num_facets);
+        for (const FacetZSpan &span : spans) {
+            double height = double(span.max_z) - double(span.min_z);
+            if (height > threshold)
+                m_facets_tall.emplace_back(span);
+            else {
+                m_facets_short.emplace_back(span);
+                m_facets_short_height = std::max(m_facets_short_height, height);
+            }
+        }
+        auto sort_by_min_z = [](const FacetZSpan &l, const FacetZSpan &r) { return l.min_z < r.min_z || (l.min_z == r.min_z && l.facet_idx < r.facet_idx); };
+        std::sort(m_facets_short.begin(), m_facets_short.end(), sort_by_min_z);
+        std::sort(m_facets_tall.begin(), m_facets_tall.end(), sort_by_min_z);
+    }
+    m_z_index_valid = true;
+    throw_on_cancel();
 }
 
 
@@ -734,10 +781,88 @@ void TriangleMeshSlicer::set_up_direction(const Vec3f& up)
 {
     m_quaternion.setFromTwoVectors(up, Vec3f::UnitZ());
     m_use_quaternion = true;
+    // The Z index was built for the unrotated mesh. Rather than rebuilding it for each new direction, fall back to slicing all the facets.
+    m_z_index_valid = false;
 }
 
 
 
+// Hash map from an edge or vertex ID to the intersection lines starting at that edge or vertex.
+// Lines sharing the same ID are chained in the order of the input lines.
+// The storage is kept allocated to be reused for indexing the lines of the next layer.
+class IntersectionLinesIndex
+{
+public:
+    void build(const IntersectionLines &lines, int IntersectionLine::*id)
+    {
+        size_t num_lines = 0;
+        for (const IntersectionLine &line : lines)
+            if (! line.skip() && line.*id != -1)
+                ++ num_lines;
+        // Keep the load factor below 0.5.
+        size_t num_slots = 16;
+        while (num_slots < 2 * num_lines)
+            num_slots <<= 1;
+        m_mask = num_slots - 1;
+        m_slots.assign(num_slots, Slot());
+        m_next.assign(lines.size(), -1);
+        for (size_t line_idx = 0; line_idx < lines.size(); ++ line_idx) {
+            const IntersectionLine &line = lines[line_idx];
+            if (line.skip() || line.*id == -1)
+                continue;
+            Slot &slot = m_slots[this->find_slot(line.*id)];
+            if (slot.id == -1) {
+                slot.id    = line.*id;
+                slot.first = int(line_idx);
+            } else
+                m_next[slot.last] = int(line_idx);
+            slot.last = int(line_idx);
+        }
+    }
+
+    // Find the first not yet consumed line starting at the given ID, return null if there is none.
+    // The consumed lines at the start of the chain are dropped from the index.
+    IntersectionLine* find_unskipped(IntersectionLines &lines, int id)
+    {
+        Slot &slot = m_slots[this->find_slot(id)];
+        if (slot.id == -1)
+            return nullptr;
+        while (slot.first != -1 && lines[slot.first].skip())
+            slot.first = m_next[slot.first];
+        return (slot.first == -1) ? nullptr : &lines[slot.first];
+    }
+
+private:
+    struct Slot {
+        Slot() : id(-1), first(-1), last(-1) {}
+        // Edge or vertex ID, -1 for an empty slot.
+        int id;
+        // First and last line of the chain of lines sharing this ID.
+        int first;
+        int last;
+    };
+
+    // Linear probing, returns either the slot with the given ID or the empty slot to store the ID into.
+    size_t find_slot(int id) const
+    {
+        size_t idx = (uint32_t(id) * 2654435761u) & m_mask;
+        while (m_slots[idx].id != -1 && m_slots[idx].id != id)
+            idx = (idx + 1) & m_mask;
+        return idx;
+    }
+
+    std::vector<Slot>   m_slots;
+    // Next line sharing the same ID, indexed by the line index.
+    std::vector<int>    m_next;
+    size_t              m_mask = 0;
+};
+
+struct TriangleMeshSlicer::MakeLoopsWorkspace
+{
+    IntersectionLinesIndex by_edge_a_id;
+    IntersectionLinesIndex by_a_id;
+};
+
 void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons>* layers, throw_on_cancel_callback_type throw_on_cancel) const
 {
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::slice";
@@ -771,19 +896,10 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons
     
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_slice_do";
     std::vector<IntersectionLines> lines(z.size());
-    {
-        boost::mutex lines_mutex;
-        tbb::parallel_for(
-            tbb::blocked_range<int>(0,this->mesh->stl.stats.number_of_facets),
-            [&lines, &lines_mutex, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
-                for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
-                    if ((facet_idx & 0x0ffff) == 0)
-                        throw_on_cancel();
-                    this->_slice_do(facet_idx, &lines, &lines_mutex, z);
-                }
-            }
-        );
-    }
+    if (m_z_index_valid)
+        this->slice_by_z_index(z, lines, throw_on_cancel);
+    else
+        this->slice_by_facet_slabs(z, lines, throw_on_cancel);
     throw_on_cancel();
 
     // v_scaled_shared could be freed here
@@ -791,16 +907,33 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons
     // build loops
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_make_loops_do";
     layers->resize(z.size());
+    // Time spent chaining the lines of each layer, in seconds.
+    std::vector<double> layer_times(z.size(), 0.);
     tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, z.size()),
-        [&lines, &layers, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+        tbb::blocked_range<size_t>(0, z.size(), 1),
+        [&lines, &layers, &layer_times, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+            // The lookup tables are reused by all the layers of this task.
+            MakeLoopsWorkspace workspace;
             for (size_t line_idx = range.begin(); line_idx < range.end(); ++ line_idx) {
-                if ((line_idx & 0x0ffff) == 0)
-                    throw_on_cancel();
-                this->make_loops(lines[line_idx], &(*layers)[line_idx]);
+                throw_on_cancel();
+                auto time_start = std::chrono::steady_clock::now();
+                this->make_loops(lines[line_idx], &(*layers)[line_idx], &workspace);
+#ifndef SLIC3R_DEBUG
+                // Release the lines early.
+                IntersectionLines().swap(lines[line_idx]);
+#endif /* SLIC3R_DEBUG */
+                layer_times[line_idx] = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
             }
         }
     );
+    if (! layer_times.empty()) {
+        size_t idx_max = std::max_element(layer_times.begin(), layer_times.end()) - layer_times.begin();
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::_make_loops_do - " << z.size() << " layers, total " << 
+            std::accumulate(layer_times.begin(), layer_times.end(), 0.) << "s, slowest layer " << idx_max << 
+            " at z=" << z[idx_max] << " took " << layer_times[idx_max] << "s";
+        for (size_t i = 0; i < z.size(); ++ i)
+            BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::_make_loops_do - layer " << i << " at z=" << z[i] << " took " << layer_times[i] << "s";
+    }
     BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::slice finished";
 
 #ifdef SLIC3R_DEBUG
@@ -837,8 +970,112 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<Polygons
 #endif
 }
 
-void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
-    const std::vector<float> &z) const
+void TriangleMeshSlicer::slice_by_z_index(const std::vector<float> &z, std::vector<IntersectionLines> &lines, throw_on_cancel_callback_type throw_on_cancel) const
+{
+    // Each task slices a continuous range of layers, therefore it is the only one writing into the line buckets of its layers.
+    // Only the facets touching the range of layers are visited: The short facets are found by a binary search over their min_z,
+    // the tall facets are filtered by their Z span.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, z.size()),
+        [&lines, &z, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+            const float  z_min = z[range.begin()];
+            const float  z_max = z[range.end() - 1];
+            // A short facet touching z_min must start above z_min - m_facets_short_height.
+            const double z_min_short = double(z_min) - m_facets_short_height;
+            auto it_begin = std::lower_bound(m_facets_short.begin(), m_facets_short.end(), z_min_short, 
+                [](const FacetZSpan &span, double z) { return double(span.min_z) < z; });
+            // The facets are visited twice. The first pass counts the facets spanning each layer, which bounds the number of lines
+            // of the layer, as a plane cuts a facet into at most one line. The line buckets are then allocated once
+            // instead of being regrown while the second pass slices the facets into them.
+            const auto it_z_begin = z.begin() + range.begin();
+            const auto it_z_end   = z.begin() + range.end();
+            std::vector<int> num_lines_delta(range.size() + 1, 0);
+            auto visit_facet = [&](const FacetZSpan &span, bool count) {
+                if (count) {
+                    // Same layer range as in _slice_do().
+                    auto it_min_layer = std::lower_bound(it_z_begin, it_z_end, span.min_z);
+                    auto it_max_layer = std::upper_bound(it_min_layer, it_z_end, span.max_z);
+                    ++ num_lines_delta[it_min_layer - it_z_begin];
+                    -- num_lines_delta[it_max_layer - it_z_begin];
+                } else
+                    this->_slice_do(span.facet_idx, &lines, z, range.begin(), range.end());
+            };
+            for (bool count : { true, false }) {
+                size_t cnt = 0;
+                for (auto it = it_begin; it != m_facets_short.end() && it->min_z <= z_max; ++ it) {
+                    if (it->max_z >= z_min)
+                        visit_facet(*it, count);
+                    if ((++ cnt & 0x0ffff) == 0)
+                        throw_on_cancel();
+                }
+                for (const FacetZSpan &span : m_facets_tall) {
+                    if (span.min_z > z_max)
+                        break;
+                    if (span.max_z >= z_min)
+                        visit_facet(span, count);
+                }
+                if (count) {
+                    int num_lines = 0;
+                    for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                        num_lines += num_lines_delta[layer_idx - range.begin()];
+                        lines[layer_idx].reserve(num_lines);
+                    }
+                }
+            }
+        }
+    );
+}
+
+void TriangleMeshSlicer::slice_by_facet_slabs(const std::vector<float> &z, std::vector<IntersectionLines> &lines, throw_on_cancel_callback_type throw_on_cancel) const
+{
+    // The facets are split into a fixed number of continuous slabs. Each slab collects its intersection lines
+    // into its own set of per layer buckets, therefore no locking is needed while slicing the facets.
+    // The buckets are then concatenated per layer in the slab order, making the result independent
+    // of the thread scheduling.
+    const size_t num_facets = this->mesh->stl.stats.number_of_facets;
+    const size_t num_slabs  = std::max<size_t>(1, std::min<size_t>(
+        (num_facets + facets_per_slab_min - 1) / facets_per_slab_min, 
+        8 * std::max<size_t>(1, boost::thread::hardware_concurrency())));
+    const size_t slab_size  = (num_facets + num_slabs - 1) / num_slabs;
+    std::vector<std::vector<IntersectionLines>> slab_lines(num_slabs);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_slabs),
+        [&slab_lines, slab_size, num_facets, &z, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+            for (size_t slab_idx = range.begin(); slab_idx < range.end(); ++ slab_idx) {
+                std::vector<IntersectionLines> &lines_slab = slab_lines[slab_idx];
+                lines_slab.assign(z.size(), IntersectionLines());
+                size_t facet_end = std::min(num_facets, (slab_idx + 1) * slab_size);
+                for (size_t facet_idx = slab_idx * slab_size; facet_idx < facet_end; ++ facet_idx) {
+                    if ((facet_idx & 0x0ffff) == 0)
+                        throw_on_cancel();
+                    this->_slice_do(facet_idx, &lines_slab, z, 0, z.size());
+                }
+            }
+        }
+    );
+    throw_on_cancel();
+    // Merge the slab buckets, one layer per task.
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, z.size()),
+        [&lines, &slab_lines](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                size_t num_lines = 0;
+                for (const std::vector<IntersectionLines> &lines_slab : slab_lines)
+                    num_lines += lines_slab[layer_idx].size();
+                IntersectionLines &dst = lines[layer_idx];
+                dst.reserve(num_lines);
+                for (std::vector<IntersectionLines> &lines_slab : slab_lines) {
+                    IntersectionLines &src = lines_slab[layer_idx];
+                    dst.insert(dst.end(), src.begin(), src.end());
+                    // Release the memory early.
+                    IntersectionLines().swap(src);
+                }
+            }
+        }
+    );
+}
+
+void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z, size_t layer_begin, size_t layer_end) const
 {
     const stl_facet &facet = m_use_quaternion ? (this->mesh->stl.facet_start.data() + facet_idx)->rotated(m_quaternion) : *(this->mesh->stl.facet_start.data() + facet_idx);
     
@@ -856,8 +1093,8 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
     
     // find layer extents
     std::vector<float>::const_iterator min_layer, max_layer;
-    min_layer = std::lower_bound(z.begin(), z.end(), min_z); // first layer whose slice_z is >= min_z
-    max_layer = std::upper_bound(min_layer, z.end(), max_z); // first layer whose slice_z is > max_z
+    min_layer = std::lower_bound(z.begin() + layer_begin, z.begin() + layer_end, min_z); // first layer whose slice_z is >= min_z
+    max_layer = std::upper_bound(min_layer, z.begin() + layer_end, max_z); // first layer whose slice_z is > max_z
     #ifdef SLIC3R_TRIANGLEMESH_DEBUG
     printf("layers: min = %d, max = %d\n", (int)(min_layer - z.begin()), (int)(max_layer - z.begin()));
     #endif /* SLIC3R_TRIANGLEMESH_DEBUG */
@@ -866,7 +1103,6 @@ void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLin
         std::vector<float>::size_type layer_idx = it - z.begin();
         IntersectionLine il;
         if (this->slice_facet(*it / SCALING_FACTOR, facet, facet_idx, min_z, max_z, &il) == TriangleMeshSlicer::Slicing) {
-            boost::lock_guard<boost::mutex> l(*lines_mutex);
             if (il.edge_type == feHorizontal) {
                 // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
             } else
@@ -882,17 +1118,30 @@ void TriangleMeshSlicer::slice(const std::vector<float> &z, std::vector<ExPolygo
 
 	BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::make_expolygons in parallel - start";
 	layers->resize(z.size());
+    // Time spent by make_expolygons() on each layer, in seconds.
+    std::vector<double> layer_times(z.size(), 0.);
 	tbb::parallel_for(
-		tbb::blocked_range<size_t>(0, z.size()),
-		[&layers_p, layers, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
+		tbb::blocked_range<size_t>(0, z.size(), 1),
+		[&layers_p, layers, &layer_times, throw_on_cancel, this](const tbb::blocked_range<size_t>& range) {
     		for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
 #ifdef SLIC3R_TRIANGLEMESH_DEBUG
                 printf("Layer " PRINTF_ZU " (slice_z = %.2f):\n", layer_id, z[layer_id]);
 #endif
                 throw_on_cancel();
+                auto time_start = std::chrono::steady_clock::now();
     			this->make_expolygons(layers_p[layer_id], &(*layers)[layer_id]);
+                Polygons().swap(layers_p[layer_id]);
+                layer_times[layer_id] = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
     		}
     	});
+    if (! layer_times.empty()) {
+        size_t idx_max = std::max_element(layer_times.begin(), layer_times.end()) - layer_times.begin();
+        BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::make_expolygons - " << z.size() << " layers, total " << 
+            std::accumulate(layer_times.begin(), layer_times.end(), 0.) << "s, slowest layer " << idx_max << 
+            " at z=" << z[idx_max] << " took " << layer_times[idx_max] << "s";
+        for (size_t i = 0; i < z.size(); ++ i)
+            BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::make_expolygons - layer " << i << " at z=" << z[i] << " took " << layer_times[i] << "s";
+    }
 	BOOST_LOG_TRIVIAL(debug) << "TriangleMeshSlicer::make_expolygons in parallel - end";
 }
 
@@ -1149,25 +1398,12 @@ struct OpenPolyline {
 
 // called by TriangleMeshSlicer::make_loops() to connect sliced triangles into closed loops and open polylines by the triangle connectivity.
 // Only connects segments crossing triangles of the same orientation.
-static void chain_lines_by_triangle_connectivity(std::vector<IntersectionLine> &lines, Polygons &loops, std::vector<OpenPolyline> &open_polylines)
+static void chain_lines_by_triangle_connectivity(std::vector<IntersectionLine> &lines, Polygons &loops, std::vector<OpenPolyline> &open_polylines,
+    IntersectionLinesIndex &by_edge_a_id, IntersectionLinesIndex &by_a_id)
 {
     // Build a map of lines by edge_a_id and a_id.
-    std::vector<IntersectionLine*> by_edge_a_id;
-    std::vector<IntersectionLine*> by_a_id;
-    by_edge_a_id.reserve(lines.size());
-    by_a_id.reserve(lines.size());
-    for (IntersectionLine &line : lines) {
-        if (! line.skip()) {
-            if (line.edge_a_id != -1)
-                by_edge_a_id.emplace_back(&line);
-            if (line.a_id != -1)
-                by_a_id.emplace_back(&line);
-        }
-    }
-    auto by_edge_lower = [](const IntersectionLine* il1, const IntersectionLine *il2) { return il1->edge_a_id < il2->edge_a_id; };
-    auto by_vertex_lower = [](const IntersectionLine* il1, const IntersectionLine *il2) { return il1->a_id < il2->a_id; };
-    std::sort(by_edge_a_id.begin(), by_edge_a_id.end(), by_edge_lower);
-    std::sort(by_a_id.begin(), by_a_id.end(), by_vertex_lower);
+    by_edge_a_id.build(lines, &IntersectionLine::edge_a_id);
+    by_a_id.build(lines, &IntersectionLine::a_id);
     // Chain the segments with a greedy algorithm, collect the loops and unclosed polylines.
     IntersectionLines::iterator it_line_seed = lines.begin();
     for (;;) {
@@ -1192,34 +1428,13 @@ static void chain_lines_by_triangle_connectivity(std::vector<IntersectionLine> &
             first_line->a.x, first_line->a.y, first_line->b.x, first_line->b.y);
         */
         
-        IntersectionLine key;
         for (;;) {
             // find a line starting where last one finishes
             IntersectionLine* next_line = nullptr;
-            if (last_line->edge_b_id != -1) {
-                key.edge_a_id = last_line->edge_b_id;
-                auto it_begin = std::lower_bound(by_edge_a_id.begin(), by_edge_a_id.end(), &key, by_edge_lower);
-                if (it_begin != by_edge_a_id.end()) {
-                    auto it_end = std::upper_bound(it_begin, by_edge_a_id.end(), &key, by_edge_lower);
-                    for (auto it_line = it_begin; it_line != it_end; ++ it_line)
-                        if (! (*it_line)->skip()) {
-                            next_line = *it_line;
-                            break;
-                        }
-                }
-            }
-            if (next_line == nullptr && last_line->b_id != -1) {
-                key.a_id = last_line->b_id;
-                auto it_begin = std::lower_bound(by_a_id.begin(), by_a_id.end(), &key, by_vertex_lower);
-                if (it_begin != by_a_id.end()) {
-                    auto it_end = std::upper_bound(it_begin, by_a_id.end(), &key, by_vertex_lower);
-                    for (auto it_line = it_begin; it_line != it_end; ++ it_line)
-                        if (! (*it_line)->skip()) {
-                            next_line = *it_line;
-                            break;
-                        }
-                }
-            }
+            if (last_line->edge_b_id != -1)
+                next_line = by_edge_a_id.find_unskipped(lines, last_line->edge_b_id);
+            if (next_line == nullptr && last_line->b_id != -1)
+                next_line = by_a_id.find_unskipped(lines, last_line->b_id);
             if (next_line == nullptr) {
                 // Check whether we closed this loop.
                 if ((first_line->edge_a_id != -1 && first_line->edge_a_id == last_line->edge_b_id) || 
@@ -1470,8 +1685,12 @@ static void chain_open_polylines_close_gaps(std::vector<OpenPolyline> &open_poly
     }
 }
 
-void TriangleMeshSlicer::make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const
+void TriangleMeshSlicer::make_loops(std::vector<IntersectionLine> &lines, Polygons* loops, MakeLoopsWorkspace *workspace) const
 {
+    MakeLoopsWorkspace workspace_local;
+    if (workspace == nullptr)
+        workspace = &workspace_local;
+
 #if 0
 //FIXME slice_facet() may create zero length edges due to rounding of doubles into coord_t.
 //#ifdef _DEBUG
@@ -1499,7 +1718,7 @@ void TriangleMeshSlicer::make_loops(std::vector<IntersectionLine> &lines, Polygo
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
 
     std::vector<OpenPolyline> open_polylines;
-    chain_lines_by_triangle_connectivity(lines, *loops, open_polylines);
+    chain_lines_by_triangle_connectivity(lines, *loops, open_polylines, workspace->by_edge_a_id, workspace->by_a_id);
 
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
         {
@@ -191,8 +191,36 @@ private:
     // Whether or not the above quaterion should be used
     bool                     m_use_quaternion = false;
 
-    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, const std::vector<float> &z) const;
-    void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops) const;
+    // Z span of a facet, used by the Z index below.
+    struct FacetZSpan {
+        float       min_z;
+        float       max_z;
+        uint32_t    facet_idx;
+    };
+    // Z index of the facets, built by init() and reused by all the following calls to slice().
+    // Facets not taller than m_facets_short_height, sorted by min_z.
+    std::vector<FacetZSpan>  m_facets_short;
+    // The remaining few tall facets, sorted by min_z.
+    std::vector<FacetZSpan>  m_facets_tall;
+    // Maximum height of a facet stored in m_facets_short.
+    double                   m_facets_short_height = 0.;
+    // The Z index is only valid for the unrotated mesh, it is dropped by set_up_direction().
+    bool                     m_z_index_valid = false;
+
+    // Minimum number of facets sliced by a single task of TriangleMeshSlicer::slice() if the Z index is not available.
+    static const size_t      facets_per_slab_min = 4096;
+
+    void build_z_index(throw_on_cancel_callback_type throw_on_cancel);
+    // Slice the facets by the Z index, a single task produces all the intersection lines of a continuous range of layers.
+    void slice_by_z_index(const std::vector<float> &z, std::vector<IntersectionLines> &lines, throw_on_cancel_callback_type throw_on_cancel) const;
+    // Slice all the facets in parallel, a single task processes a continuous range of facets.
+    void slice_by_facet_slabs(const std::vector<float> &z, std::vector<IntersectionLines> &lines, throw_on_cancel_callback_type throw_on_cancel) const;
+    // Slice a single facet at the layers <layer_begin, layer_end), store the intersection lines into the per layer buckets.
+    // Not thread safe for a shared lines vector.
+    void _slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, const std::vector<float> &z, size_t layer_begin, size_t layer_end) const;
+    // Lookup tables of make_loops(), allocated once per slicing task and reused for the following layers.
+    struct MakeLoopsWorkspace;
+    void make_loops(std::vector<IntersectionLine> &lines, Polygons* loops, MakeLoopsWorkspace *workspace = nullptr) const;
     void make_expolygons(const Polygons &loops, ExPolygons* slices) const;
     void make_expolygons_simple(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
     void make_expolygons(std::vector<IntersectionLine> &lines, ExPolygons* slices) const;
@@ -16,6 +16,9 @@
 	#ifdef BSD
 		#include <sys/sysctl.h>
 	#endif
+	#ifdef __linux__
+		#include <sys/resource.h>
+	#endif
 #endif
 
 #include <boost/log/core.hpp>
@@ -465,6 +468,27 @@ std::string log_memory_info()
     return out;
 }
 
+#elif defined(__linux__)
+
+std::string log_memory_info()
+{
+    std::string out;
+    if (logSeverity <= boost::log::trivial::info) {
+        // The second field of statm is the resident set size in pages.
+        unsigned long resident_pages = 0;
+        if (FILE *file = fopen("/proc/self/statm", "r")) {
+            if (fscanf(file, "%*lu %lu", &resident_pages) != 1)
+                resident_pages = 0;
+            fclose(file);
+        }
+        struct rusage usage;
+        if (resident_pages > 0 && getrusage(RUSAGE_SELF, &usage) == 0)
+            // ru_maxrss is in kilobytes on Linux.
+            out = " RSS: " + format_memsize_MB(size_t(resident_pages) * size_t(sysconf(_SC_PAGESIZE))) + " RSS(peak): " + format_memsize_MB(size_t(usage.ru_maxrss) << 10);
+    }
+    return out;
+}
+
 #else
 std::string log_memory_info()
 {
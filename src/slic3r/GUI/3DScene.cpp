@@ -1373,7 +1373,8 @@ void _3DScene::extrusionentity_to_verts(const ExtrusionPath &extrusion_path, flo
 // Fill in the qverts and tverts with quads and triangles for the extrusion_path.
 void _3DScene::extrusionentity_to_verts(const ExtrusionPath &extrusion_path, float print_z, const Point &copy, GLVolume &volume)
 {
-    Polyline            polyline = extrusion_path.polyline;
+    // Decodes the points of a compacted path, see Print::set_compact_toolpaths().
+    Polyline            polyline = extrusion_path.as_polyline();
     polyline.remove_duplicate_points();
     polyline.translate(copy);
     Lines               lines = polyline.lines();
@@ -1389,7 +1390,7 @@ void _3DScene::extrusionentity_to_verts(const ExtrusionLoop &extrusion_loop, flo
     std::vector<double> widths;
     std::vector<double> heights;
     for (const ExtrusionPath &extrusion_path : extrusion_loop.paths) {
-        Polyline            polyline = extrusion_path.polyline;
+        Polyline            polyline = extrusion_path.as_polyline();
         polyline.remove_duplicate_points();
         polyline.translate(copy);
         Lines lines_this = polyline.lines();
@@ -1406,7 +1407,7 @@ void _3DScene::extrusionentity_to_verts(const ExtrusionMultiPath &extrusion_mult
     std::vector<double> widths;
     std::vector<double> heights;
     for (const ExtrusionPath &extrusion_path : extrusion_multi_path.paths) {
-        Polyline            polyline = extrusion_path.polyline;
+        Polyline            polyline = extrusion_path.as_polyline();
         polyline.remove_duplicate_points();
         polyline.translate(copy);
         Lines lines_this = polyline.lines();
@@ -1423,7 +1424,7 @@ void _3DScene::extrusionentity_to_verts(const ExtrusionMultiPath3D &extrusion_mu
     std::vector<double> widths;
     std::vector<double> heights;
     for (const ExtrusionPath3D &extrusion_path : extrusion_multi_path.paths) {
-        Polyline            polyline = extrusion_path.polyline;
+        Polyline            polyline = extrusion_path.as_polyline();
         polyline.remove_duplicate_points();
         polyline.translate(copy);
         Lines lines_this = polyline.lines();
@@ -1932,6 +1932,8 @@ Plater::priv::priv(Plater *q, MainFrame *main_frame)
 {
 	this->q->SetFont(Slic3r::GUI::wxGetApp().normal_font());
 
+    // The background processing slices the same objects over and over, let it reuse the perimeters of the unchanged layers.
+    fff_print.set_reuse_perimeters(true);
     background_process.set_fff_print(&fff_print);
 	background_process.set_sla_print(&sla_print);
     background_process.set_gcode_preview_data(&gcode_preview_data);